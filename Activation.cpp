@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Activation.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+
+#include "Activation.h"
+#include "Kernels.h"
+
+template <typename T>
+void activate(const e_Activation &actType, const e_ActPrecision &precision, const T *sums, T *outputs, const size_t &n)
+{
+	const T one = static_cast<T>(1.0);
+	const T two = static_cast<T>(2.0);
+	// Perform activation function based on activation type
+	switch (actType) {
+	case ACT_TANH:
+		// Activate using the tanh function [-1:0:1]
+		if (precision == ACTP_APPROX) {
+			// tanh(x / 2) == 2 * sigmoid(x) - 1
+			kernelSigmoidApprox(sums, outputs, n);
+			for (size_t i = 0; i < n; ++i) {
+				outputs[i] = (two * outputs[i]) - one;
+			}
+		} else {
+			for (size_t i = 0; i < n; ++i) {
+				outputs[i] = std::tanh(sums[i] / two);
+			}
+		}
+		break;
+	case ACT_SIGMOID:
+		// Activate using the sigmoid function [0:0.5:1]
+		if (precision == ACTP_APPROX) {
+			kernelSigmoidApprox(sums, outputs, n);
+		} else {
+			for (size_t i = 0; i < n; ++i) {
+				outputs[i] = one / (one + std::exp(-sums[i]));
+			}
+		}
+		break;
+	default:
+		for (size_t i = 0; i < n; ++i) {
+			outputs[i] = sums[i];
+		}
+		break;
+	}
+}
+
+template <typename T>
+void activateDeriv(const e_Activation &actType, const e_ActPrecision &precision, const T *sums, const T *outputs, T *derivs, const size_t &n)
+{
+	const T one = static_cast<T>(1.0);
+	// Calculate activation derivative function based on activation type
+	switch (actType) {
+	case ACT_TANH:
+		// Calculate from derivative of the tanh function (sech^2(x))
+		if (precision == ACTP_EXACT) {
+			// Written as 1 / cosh^2(x) so it cannot overflow to inf / inf
+			for (size_t i = 0; i < n; ++i) {
+				const T c = std::cosh(sums[i]);
+				derivs[i] = one / (c * c);
+			}
+		} else {
+			// With y = tanh(x / 2), tanh(x) = 2y / (1 + y^2), so sech^2(x) = ((1 - y^2) / (1 + y^2))^2
+			for (size_t i = 0; i < n; ++i) {
+				const T ySquared = outputs[i] * outputs[i];
+				const T ratio = (one - ySquared) / (one + ySquared);
+				derivs[i] = ratio * ratio;
+			}
+		}
+		break;
+	case ACT_SIGMOID:
+		// Calculate from derivative of the sigmoid function (e^x / (1 + e^x)^2)
+		if (precision == ACTP_EXACT) {
+			// Evaluated as e^-|x| / (1 + e^-|x|)^2 so it cannot overflow
+			for (size_t i = 0; i < n; ++i) {
+				const T e = std::exp(-std::fabs(sums[i]));
+				derivs[i] = e / ((e + one) * (e + one));
+			}
+		} else {
+			// With y = sigmoid(x), the derivative is y * (1 - y)
+			for (size_t i = 0; i < n; ++i) {
+				derivs[i] = outputs[i] * (one - outputs[i]);
+			}
+		}
+		break;
+	default:
+		for (size_t i = 0; i < n; ++i) {
+			derivs[i] = sums[i];
+		}
+		break;
+	}
+}
+
+// Explicit instantiations
+template void activate<float>(const e_Activation &actType, const e_ActPrecision &precision, const float *sums, float *outputs, const size_t &n);
+template void activate<double>(const e_Activation &actType, const e_ActPrecision &precision, const double *sums, double *outputs, const size_t &n);
+template void activateDeriv<float>(const e_Activation &actType, const e_ActPrecision &precision, const float *sums, const float *outputs, float *derivs, const size_t &n);
+template void activateDeriv<double>(const e_Activation &actType, const e_ActPrecision &precision, const double *sums, const double *outputs, double *derivs, const size_t &n);
@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Activation.h
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ACTIVATION_H_
+#define ACTIVATION_H_
+
+#include <cstddef>
+
+enum e_Activation {
+	ACT_TANH,
+	ACT_SIGMOID
+};
+
+enum e_ActPrecision {
+	// libm activation; derivative evaluated from the sum of products
+	ACTP_EXACT,
+	// libm activation; derivative evaluated from the (already computed) output
+	ACTP_OUTPUT,
+	// Vectorised approximation of the activation (see kernelSigmoidApprox for the error bound);
+	// derivative evaluated from the output
+	ACTP_APPROX
+};
+
+// Activation of a whole array of sums of products at once
+template <typename T>
+void activate(const e_Activation &actType, const e_ActPrecision &precision, const T *sums, T *outputs, const size_t &n);
+// Activation derivative of a whole array, from either the sums of products or the outputs (depending on precision)
+template <typename T>
+void activateDeriv(const e_Activation &actType, const e_ActPrecision &precision, const T *sums, const T *outputs, T *derivs, const size_t &n);
+
+#endif ACTIVATION_H_
@@ -0,0 +1,206 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// AlignedBuffer.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#include "AlignedBuffer.h"
+#include "Profiler.h"
+
+template <typename T>
+c_AlignedBuffer<T>::c_AlignedBuffer() :
+	m_Data(NULL),
+	m_Size(0),
+	m_Owner(true)
+{
+}
+
+template <typename T>
+c_AlignedBuffer<T>::c_AlignedBuffer(const c_AlignedBuffer &src) :
+	m_Data(NULL),
+	m_Size(0),
+	m_Owner(true)
+{
+	_copy(src);
+}
+
+template <typename T>
+c_AlignedBuffer<T>::c_AlignedBuffer(c_AlignedBuffer &&src) noexcept :
+	m_Data(NULL),
+	m_Size(0),
+	m_Owner(true)
+{
+	_move(src);
+}
+
+template <typename T>
+c_AlignedBuffer<T>::~c_AlignedBuffer()
+{
+	_free();
+}
+
+template <typename T>
+c_AlignedBuffer<T>& c_AlignedBuffer<T>::operator=(const c_AlignedBuffer &src)
+{
+	if (this != &src) {
+		_copy(src);
+	}
+	return *this;
+}
+
+template <typename T>
+c_AlignedBuffer<T>& c_AlignedBuffer<T>::operator=(c_AlignedBuffer &&src) noexcept
+{
+	if (this != &src) {
+		_move(src);
+	}
+	return *this;
+}
+
+template <typename T>
+void c_AlignedBuffer<T>::resize(const size_t &size)
+{
+	// Reallocate the buffer (if required) and zero the contents, as per std::valarray::resize
+	// (an attached buffer is always replaced with an owned one, so external memory is never cleared)
+	if ((size != m_Size) || !m_Owner) {
+		_free();
+		_allocate(size);
+	}
+	if (m_Size > 0) {
+		memset(m_Data, 0, m_Size * sizeof(T));
+	}
+}
+
+template <typename T>
+void c_AlignedBuffer<T>::attach(T *data, const size_t &size)
+{
+	// View externally owned memory (e.g. a memory-mapped file) instead of allocating; the memory must outlive
+	// this buffer, and should be aligned to ALIGN_BYTES for the SIMD kernels to run at full speed
+	_free();
+	m_Data = data;
+	m_Size = size;
+	m_Owner = false;
+}
+
+template <typename T>
+T& c_AlignedBuffer<T>::operator[](const size_t &idx)
+{
+	return m_Data[idx];
+}
+
+template <typename T>
+const T& c_AlignedBuffer<T>::operator[](const size_t &idx) const
+{
+	return m_Data[idx];
+}
+
+template <typename T>
+T* c_AlignedBuffer<T>::data()
+{
+	return m_Data;
+}
+
+template <typename T>
+const T* c_AlignedBuffer<T>::data() const
+{
+	return m_Data;
+}
+
+template <typename T>
+const size_t c_AlignedBuffer<T>::size() const
+{
+	return m_Size;
+}
+
+template <typename T>
+const bool c_AlignedBuffer<T>::isOwner() const
+{
+	return m_Owner;
+}
+
+template <typename T>
+const size_t c_AlignedBuffer<T>::padSize(const size_t &size)
+{
+	// Round the number of elements up to a whole number of aligned blocks
+	const size_t blockSize = ALIGN_BYTES / sizeof(T);
+	return ((size + blockSize - 1) / blockSize) * blockSize;
+}
+
+template <typename T>
+void c_AlignedBuffer<T>::_copy(const c_AlignedBuffer &src)
+{
+	// Copy the contents of the source buffer (always into owned memory, even when the source is attached)
+	if ((src.m_Size != m_Size) || !m_Owner) {
+		_free();
+		_allocate(src.m_Size);
+	}
+	if (m_Size > 0) {
+		memcpy(m_Data, src.m_Data, m_Size * sizeof(T));
+	}
+}
+
+template <typename T>
+void c_AlignedBuffer<T>::_move(c_AlignedBuffer &src)
+{
+	// Take over the source's memory (owned or attached), so the data never moves and pointers into it stay valid
+	_free();
+	m_Data = src.m_Data;
+	m_Size = src.m_Size;
+	m_Owner = src.m_Owner;
+	src.m_Data = NULL;
+	src.m_Size = 0;
+	src.m_Owner = true;
+}
+
+template <typename T>
+void c_AlignedBuffer<T>::_allocate(const size_t &size)
+{
+	m_Size = size;
+	m_Owner = true;
+	if (m_Size > 0) {
+		m_Data = static_cast<T*>(::operator new(m_Size * sizeof(T), std::align_val_t(ALIGN_BYTES)));
+		BASICNN_PROFILE_ALLOCATION();
+	}
+}
+
+template <typename T>
+void c_AlignedBuffer<T>::_free()
+{
+	if ((m_Data != NULL) && m_Owner) {
+		::operator delete(m_Data, std::align_val_t(ALIGN_BYTES));
+	}
+	m_Data = NULL;
+	m_Size = 0;
+	m_Owner = true;
+}
+
+// Explicit instantiations
+template class c_AlignedBuffer<float>;
+template class c_AlignedBuffer<double>;
+template class c_AlignedBuffer<int8_t>;
+template class c_AlignedBuffer<int32_t>;
+template class c_AlignedBuffer<uint32_t>;
@@ -0,0 +1,71 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// AlignedBuffer.h
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ALIGNEDBUFFER_H_
+#define ALIGNEDBUFFER_H_
+
+#include <cstddef>
+
+// Alignment (in bytes) of all buffers, chosen to match a cache line
+const size_t ALIGN_BYTES = 64;
+
+template <typename T>
+class c_AlignedBuffer {
+public:
+	// Constructors
+									c_AlignedBuffer();
+									c_AlignedBuffer(const c_AlignedBuffer &src);
+									c_AlignedBuffer(c_AlignedBuffer &&src) noexcept;
+	// Destructor
+	virtual							~c_AlignedBuffer();
+	// Operators
+	c_AlignedBuffer&				operator=(const c_AlignedBuffer &src);
+	c_AlignedBuffer&				operator=(c_AlignedBuffer &&src) noexcept;
+	// Set
+	void							resize(const size_t &size);
+	void							attach(T *data, const size_t &size);
+	// Get
+	T&								operator[](const size_t &idx);
+	const T&						operator[](const size_t &idx) const;
+	T*								data();
+	const T*						data() const;
+	const size_t					size() const;
+	const bool						isOwner() const;
+	// Functions
+	static const size_t				padSize(const size_t &size);
+private:
+	// Functions
+	void							_copy(const c_AlignedBuffer &src);
+	void							_move(c_AlignedBuffer &src);
+	void							_allocate(const size_t &size);
+	void							_free();
+	// Variables
+	T								*m_Data;
+	size_t							m_Size;
+	bool							m_Owner;
+};
+
+#endif ALIGNEDBUFFER_H_
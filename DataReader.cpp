@@ -0,0 +1,237 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// DataReader
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "DataReader.h"
+
+// Binary dataset header, written in the native byte order (as the model files are)
+const char DATA_MAGIC[8] = {'B', 'N', 'N', 'D', 'A', 'T', 'A', '\0'};
+const uint32_t DATA_VERSION = 1;
+const uint32_t DATA_BYTE_ORDER = 0x01020304;
+
+struct s_DataHeader {
+	char							magic[8];
+	uint32_t						version;
+	uint32_t						byteOrder;
+	uint32_t						scalarSize;
+	uint32_t						reserved;
+	uint64_t						numInputs;
+	uint64_t						numTargets;
+};
+
+template <typename T>
+c_BasicDataReader<T>::c_BasicDataReader() :
+	m_DataStart(0),
+	m_Format(DATA_CSV),
+	m_NumInputs(0),
+	m_NumTargets(0)
+{
+}
+
+template <typename T>
+c_BasicDataReader<T>::~c_BasicDataReader()
+{
+}
+
+template <typename T>
+const size_t c_BasicDataReader<T>::getNumInputs()
+{
+	return m_NumInputs;
+}
+
+template <typename T>
+const size_t c_BasicDataReader<T>::getNumTargets()
+{
+	return m_NumTargets;
+}
+
+template <typename T>
+bool c_BasicDataReader<T>::open(const std::string &filename, const e_DataFormat &format, const size_t &numInputs, const size_t &numTargets)
+{
+	close();
+	if ((numInputs == 0) || (numTargets == 0)) {
+		return false;
+	}
+	m_File.open(filename.c_str(), std::ios::binary);
+	if (!m_File) {
+		return false;
+	}
+	m_Format = format;
+	m_NumInputs = numInputs;
+	m_NumTargets = numTargets;
+	if (m_Format == DATA_BINARY) {
+		// Check the header matches the expected sample layout
+		s_DataHeader header;
+		if (!m_File.read(reinterpret_cast<char*>(&header), sizeof(header)) || (memcmp(header.magic, DATA_MAGIC, sizeof(header.magic)) != 0) ||
+			(header.version != DATA_VERSION) || (header.byteOrder != DATA_BYTE_ORDER) || (header.scalarSize != sizeof(T)) ||
+			(header.numInputs != numInputs) || (header.numTargets != numTargets)) {
+			close();
+			return false;
+		}
+	}
+	m_DataStart = m_File.tellg();
+	return true;
+}
+
+template <typename T>
+void c_BasicDataReader<T>::close()
+{
+	if (m_File.is_open()) {
+		m_File.close();
+	}
+	m_File.clear();
+	m_DataStart = 0;
+}
+
+template <typename T>
+bool c_BasicDataReader<T>::rewind()
+{
+	// Return to the first sample (for the next epoch)
+	if (!m_File.is_open()) {
+		return false;
+	}
+	m_File.clear();
+	m_File.seekg(m_DataStart);
+	return static_cast<bool>(m_File);
+}
+
+template <typename T>
+bool c_BasicDataReader<T>::read(T *inputs, T *targets, const size_t &maxRows, size_t &rows)
+{
+	// Read up to maxRows samples into row-major inputs and targets arrays; rows is 0 at the end of the file.
+	// Returns false on a read error or malformed sample
+	rows = 0;
+	if (!m_File.is_open()) {
+		return false;
+	}
+	if (m_Format == DATA_BINARY) {
+		return _readBinary(inputs, targets, maxRows, rows);
+	}
+	return _readCsv(inputs, targets, maxRows, rows);
+}
+
+template <typename T>
+bool c_BasicDataReader<T>::writeBinary(const std::string &filename, const T *inputs, const T *targets, const size_t &rows, const size_t &numInputs, const size_t &numTargets)
+{
+	// Write row-major inputs and targets arrays as a binary dataset
+	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+	if (!file) {
+		return false;
+	}
+	s_DataHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, DATA_MAGIC, sizeof(header.magic));
+	header.version = DATA_VERSION;
+	header.byteOrder = DATA_BYTE_ORDER;
+	header.scalarSize = sizeof(T);
+	header.numInputs = numInputs;
+	header.numTargets = numTargets;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	for (size_t r = 0; r < rows; ++r) {
+		file.write(reinterpret_cast<const char*>(inputs + (r * numInputs)), numInputs * sizeof(T));
+		file.write(reinterpret_cast<const char*>(targets + (r * numTargets)), numTargets * sizeof(T));
+	}
+	return static_cast<bool>(file);
+}
+
+template <typename T>
+bool c_BasicDataReader<T>::_readCsv(T *inputs, T *targets, const size_t &maxRows, size_t &rows)
+{
+	const size_t numValues = m_NumInputs + m_NumTargets;
+	while ((rows < maxRows) && std::getline(m_File, m_Line)) {
+		// Skip blank and comment lines
+		const size_t first = m_Line.find_first_not_of(" \t\r");
+		if ((first == std::string::npos) || (m_Line[first] == '#')) {
+			continue;
+		}
+		const char *pos = m_Line.c_str();
+		for (size_t i = 0; i < numValues; ++i) {
+			char *end = NULL;
+			const T value = static_cast<T>(strtod(pos, &end));
+			if (end == pos) {
+				// Not a number (or too few values)
+				return false;
+			}
+			if (i < m_NumInputs) {
+				inputs[(rows * m_NumInputs) + i] = value;
+			} else {
+				targets[(rows * m_NumTargets) + (i - m_NumInputs)] = value;
+			}
+			// Step over the separator: a comma (with any whitespace around it) between values, nothing after the last
+			pos = end;
+			while ((*pos == ' ') || (*pos == '\t')) {
+				++pos;
+			}
+			if ((i + 1) < numValues) {
+				if (*pos != ',') {
+					// Values separated by whitespace alone
+					return false;
+				}
+				++pos;
+			}
+		}
+		// Anything more than trailing whitespace, a trailing comma included, is an extra value (e.g. the file has
+		// more columns than expected)
+		while ((*pos == ' ') || (*pos == '\t') || (*pos == '\r')) {
+			++pos;
+		}
+		if (*pos != '\0') {
+			return false;
+		}
+		++rows;
+	}
+	return !m_File.bad();
+}
+
+template <typename T>
+bool c_BasicDataReader<T>::_readBinary(T *inputs, T *targets, const size_t &maxRows, size_t &rows)
+{
+	// Read the whole chunk with one call, then split each sample into its inputs and targets
+	const size_t numValues = m_NumInputs + m_NumTargets;
+	if (m_Rows.size() < (maxRows * numValues)) {
+		m_Rows.resize(maxRows * numValues);
+	}
+	m_File.read(reinterpret_cast<char*>(m_Rows.data()), static_cast<std::streamsize>(maxRows * numValues * sizeof(T)));
+	const size_t bytes = static_cast<size_t>(m_File.gcount());
+	if ((bytes % (numValues * sizeof(T))) != 0) {
+		// Truncated sample
+		return false;
+	}
+	rows = bytes / (numValues * sizeof(T));
+	for (size_t r = 0; r < rows; ++r) {
+		const T *row = &m_Rows[r * numValues];
+		memcpy(inputs + (r * m_NumInputs), row, m_NumInputs * sizeof(T));
+		memcpy(targets + (r * m_NumTargets), row + m_NumInputs, m_NumTargets * sizeof(T));
+	}
+	return !m_File.bad();
+}
+
+// Explicit instantiations
+template class c_BasicDataReader<float>;
+template class c_BasicDataReader<double>;
@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// DataReader
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef DATAREADER_H_
+#define DATAREADER_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+enum e_DataFormat {
+	// Text, one sample per line: exactly the inputs then the targets, separated by commas (lines starting # are skipped)
+	DATA_CSV,
+	// Binary, a header then each sample's inputs then targets as native scalars (see writeBinary)
+	DATA_BINARY
+};
+
+// Reads samples from a dataset file a chunk at a time, so the whole dataset never needs to be held in memory
+template <typename T>
+class c_BasicDataReader {
+public:
+	// Constructors
+									c_BasicDataReader();
+	// Destructor
+	virtual							~c_BasicDataReader();
+	// Get
+	const size_t					getNumInputs();
+	const size_t					getNumTargets();
+	// Functions
+	bool							open(const std::string &filename, const e_DataFormat &format, const size_t &numInputs, const size_t &numTargets);
+	void							close();
+	bool							rewind();
+	bool							read(T *inputs, T *targets, const size_t &maxRows, size_t &rows);
+	static bool						writeBinary(const std::string &filename, const T *inputs, const T *targets, const size_t &rows, const size_t &numInputs, const size_t &numTargets);
+private:
+	// Not copyable
+									c_BasicDataReader(const c_BasicDataReader &src);
+	c_BasicDataReader&				operator=(const c_BasicDataReader &src);
+	// Functions
+	bool							_readCsv(T *inputs, T *targets, const size_t &maxRows, size_t &rows);
+	bool							_readBinary(T *inputs, T *targets, const size_t &maxRows, size_t &rows);
+	// Variables
+	std::ifstream					m_File;
+	std::streampos					m_DataStart;
+	std::string						m_Line;
+	std::vector<T>					m_Rows;
+	e_DataFormat					m_Format;
+	size_t							m_NumInputs;
+	size_t							m_NumTargets;
+};
+
+typedef c_BasicDataReader<double>	c_DataReader;
+typedef c_BasicDataReader<float>	c_DataReaderF;
+
+#endif DATAREADER_H_
@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// ExecContext
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ExecContext.h"
+#include "NeuralNetwork.h"
+
+template <typename T>
+c_BasicExecContext<T>::c_BasicExecContext(const c_BasicNeuralNetwork<T> &network) :
+	m_Samples(0)
+{
+	_build(network);
+}
+
+template <typename T>
+c_BasicExecContext<T>::~c_BasicExecContext()
+{
+}
+
+template <typename T>
+const T* c_BasicExecContext<T>::getOutputs()
+{
+	// Outputs of the last sample evaluated with this context
+	return m_Outputs.back().data();
+}
+
+template <typename T>
+const size_t c_BasicExecContext<T>::getSamples()
+{
+	// Number of samples accumulated since the gradients were last applied
+	return m_Samples;
+}
+
+template <typename T>
+void c_BasicExecContext<T>::clearGradients()
+{
+	for (size_t i = 0; i < m_Gradients.size(); ++i) {
+		m_Gradients[i].resize(m_Gradients[i].size());
+	}
+	m_Samples = 0;
+}
+
+template <typename T>
+void c_BasicExecContext<T>::_build(const c_BasicNeuralNetwork<T> &network)
+{
+	// Size every buffer to match the network's layers (the bias nodes, if any, are set to 1); a network without
+	// layers (moved from) gets an empty context
+	const size_t numLayers = network.getSize();
+	m_Samples = 0;
+	if (numLayers == 0) {
+		return;
+	}
+	m_Inputs.resize(network[0].getInputSize());
+	if (m_Inputs.size() > network.getNumInputs()) {
+		m_Inputs[m_Inputs.size() - 1] = 1.0;
+	}
+	m_Outputs.resize(numLayers);
+	m_Sums.resize(numLayers);
+	m_Deltas.resize(numLayers);
+	m_WeightedDeltaSums.resize(numLayers);
+	m_Gradients.resize(numLayers);
+	m_Errors.resize(network[numLayers - 1].getSize());
+	for (size_t i = 0; i < numLayers; ++i) {
+		const c_BasicPerceptronLayer<T> &layer = network[i];
+		m_Outputs[i].resize(layer.getOutputs().size());
+		if (m_Outputs[i].size() > layer.getSize()) {
+			m_Outputs[i][layer.getSize()] = 1.0;
+		}
+		m_Sums[i].resize(layer.getSize());
+		m_Deltas[i].resize(layer.getSize());
+		m_WeightedDeltaSums[i].resize((i > 0) ? network[i - 1].getSize() : 0);
+		m_Gradients[i].resize(0);
+	}
+}
+
+template <typename T>
+bool c_BasicExecContext<T>::_matches(const c_BasicNeuralNetwork<T> &network)
+{
+	// Check the network has not been reconfigured since this context was built
+	if ((m_Outputs.size() != network.getSize()) || (network.getSize() == 0) || (m_Inputs.size() != network[0].getInputSize())) {
+		return false;
+	}
+	for (size_t i = 0; i < m_Outputs.size(); ++i) {
+		const c_BasicPerceptronLayer<T> &layer = network[i];
+		if ((m_Outputs[i].size() != layer.getOutputs().size()) || ((i > 0) && (m_WeightedDeltaSums[i].size() != network[i - 1].getSize()))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename T>
+void c_BasicExecContext<T>::_resizeGradients(const c_BasicNeuralNetwork<T> &network)
+{
+	// Allocate (zeroed) gradients laid out as each layer's weights matrix, if not already
+	for (size_t i = 0; i < m_Gradients.size(); ++i) {
+		const size_t size = network[i].getSize() * network[i].getStride();
+		if (m_Gradients[i].size() != size) {
+			m_Gradients[i].resize(size);
+		}
+	}
+}
+
+// Explicit instantiations
+template class c_BasicExecContext<float>;
+template class c_BasicExecContext<double>;
@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// ExecContext
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef EXECCONTEXT_H_
+#define EXECCONTEXT_H_
+
+#include <vector>
+
+#include "AlignedBuffer.h"
+
+template <typename T>
+class c_BasicNeuralNetwork;
+template <typename T>
+class c_BasicPipelineTrainer;
+
+// Per-thread execution state for a network: the activations and deltas of one sample, and the gradients
+// accumulated over the samples since they were last applied. The network's weights stay shared, so any number
+// of threads can evaluate and accumulate at once, each with its own context. The gradients are only allocated
+// once a context first accumulates, so a context used just for inference (the workspace for infer) stays small
+template <typename T>
+class c_BasicExecContext {
+public:
+	// Constructors
+									c_BasicExecContext(const c_BasicNeuralNetwork<T> &network);
+	// Destructor
+	virtual							~c_BasicExecContext();
+	// Get
+	const T*						getOutputs();
+	const size_t					getSamples();
+	// Functions
+	void							clearGradients();
+private:
+	friend class c_BasicNeuralNetwork<T>;
+	friend class c_BasicPipelineTrainer<T>;
+	// Functions
+	void							_build(const c_BasicNeuralNetwork<T> &network);
+	bool							_matches(const c_BasicNeuralNetwork<T> &network);
+	void							_resizeGradients(const c_BasicNeuralNetwork<T> &network);
+	// Variables
+	c_AlignedBuffer<T>				m_Inputs;
+	std::vector<c_AlignedBuffer<T>>	m_Outputs;
+	std::vector<c_AlignedBuffer<T>>	m_Sums;
+	std::vector<c_AlignedBuffer<T>>	m_Deltas;
+	std::vector<c_AlignedBuffer<T>>	m_WeightedDeltaSums;
+	std::vector<c_AlignedBuffer<T>>	m_Gradients;
+	c_AlignedBuffer<T>				m_Errors;
+	size_t							m_Samples;
+};
+
+typedef c_BasicExecContext<double>	c_ExecContext;
+typedef c_BasicExecContext<float>	c_ExecContextF;
+
+#endif EXECCONTEXT_H_
@@ -0,0 +1,245 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// FixedNetwork
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef FIXEDNETWORK_H_
+#define FIXEDNETWORK_H_
+
+#include <array>
+
+#include "Activation.h"
+#include "NeuralNetwork.h"
+
+// Offset of a layer's weights in a fixed network with the given sizes (inputs, then each layer's perceptrons),
+// where each layer has (inputs + 1) weights per perceptron
+constexpr size_t fixedLayerOffset(const size_t *sizes, const size_t &layer)
+{
+	size_t offset = 0;
+	for (size_t l = 0; l < layer; ++l) {
+		offset += sizes[l + 1] * (sizes[l] + 1);
+	}
+	return offset;
+}
+
+// Largest layer in a fixed network with the given sizes
+constexpr size_t fixedMaxSize(const size_t *sizes, const size_t &numSizes)
+{
+	size_t size = 0;
+	for (size_t l = 1; l < numSizes; ++l) {
+		size = (sizes[l] > size) ? sizes[l] : size;
+	}
+	return size;
+}
+
+// Network with a compile-time topology (c_FixedNetwork<double, 8, 16, 4> has 8 inputs, a layer of 16 perceptrons
+// and 4 outputs) for tiny models. All weights are held in one std::array, every loop has a constexpr trip count
+// (so the compiler can fully unroll it), and nothing is allocated, so inference costs little more than the
+// arithmetic itself. Each layer's weights are stored input-major (transposed from c_PerceptronLayer), so the sums
+// of all perceptrons accumulate side by side in independent (vectorisable) lanes rather than as one serial dot
+// product each. The final input row holds the bias weights, which are zero without bias.
+// Being a variadic template, this is defined entirely in the header
+template <typename T, size_t... Sizes>
+class c_FixedNetwork {
+public:
+	static_assert(sizeof...(Sizes) >= 2, "c_FixedNetwork needs an input size and at least one layer size");
+	static constexpr size_t			SIZES[] = { Sizes... };
+	static constexpr size_t			NUM_LAYERS = sizeof...(Sizes) - 1;
+	static constexpr size_t			NUM_INPUTS = SIZES[0];
+	static constexpr size_t			NUM_OUTPUTS = SIZES[NUM_LAYERS];
+	static constexpr size_t			NUM_WEIGHTS = fixedLayerOffset(SIZES, NUM_LAYERS);
+	static constexpr size_t			MAX_SIZE = fixedMaxSize(SIZES, NUM_LAYERS + 1);
+	// Constructors
+									c_FixedNetwork();
+	// Set
+	void							setActivation(const e_Activation &actType);
+	void							setActPrecision(const e_ActPrecision &actPrecision);
+	void							setBias(const bool &bias);
+	// Get
+	T*								getWeights(const size_t &layer);
+	// Functions
+	bool							fromNetwork(c_BasicNeuralNetwork<T> &network);
+	bool							toNetwork(c_BasicNeuralNetwork<T> &network) const;
+	void							infer(const T *inputs, T *outputs) const;
+private:
+	// Functions
+	bool							_matches(c_BasicNeuralNetwork<T> &network) const;
+	template <size_t L>
+	void							_inferLayer(const T *inputs, T *buffer, T *spare, T *outputs) const;
+	// Variables
+	std::array<T, NUM_WEIGHTS>		m_Weights;
+	e_Activation					m_ActType;
+	e_ActPrecision					m_ActPrecision;
+	bool							m_Bias;
+};
+
+template <typename T, size_t... Sizes>
+c_FixedNetwork<T, Sizes...>::c_FixedNetwork() :
+	m_ActType(ACT_TANH),
+	m_ActPrecision(ACTP_EXACT),
+	m_Bias(true)
+{
+	m_Weights.fill(0.0);
+}
+
+template <typename T, size_t... Sizes>
+void c_FixedNetwork<T, Sizes...>::setActivation(const e_Activation &actType)
+{
+	m_ActType = actType;
+}
+
+template <typename T, size_t... Sizes>
+void c_FixedNetwork<T, Sizes...>::setActPrecision(const e_ActPrecision &actPrecision)
+{
+	m_ActPrecision = actPrecision;
+}
+
+template <typename T, size_t... Sizes>
+void c_FixedNetwork<T, Sizes...>::setBias(const bool &bias)
+{
+	m_Bias = bias;
+	if (!m_Bias) {
+		// Clear the bias weights, so they take no part in the sums
+		for (size_t l = 0; l < NUM_LAYERS; ++l) {
+			T *biasWeights = getWeights(l) + (SIZES[l] * SIZES[l + 1]);
+			for (size_t i = 0; i < SIZES[l + 1]; ++i) {
+				biasWeights[i] = 0.0;
+			}
+		}
+	}
+}
+
+template <typename T, size_t... Sizes>
+T* c_FixedNetwork<T, Sizes...>::getWeights(const size_t &layer)
+{
+	// Input-major weights of a layer: one row per input (then one for the bias), holding the weight to each perceptron
+	return &m_Weights[fixedLayerOffset(SIZES, layer)];
+}
+
+template <typename T, size_t... Sizes>
+bool c_FixedNetwork<T, Sizes...>::fromNetwork(c_BasicNeuralNetwork<T> &network)
+{
+	// Copy the weights and configuration of a network with the same topology
+	if (!_matches(network)) {
+		return false;
+	}
+	m_ActType = network.getActivation();
+	m_ActPrecision = network.getActPrecision();
+	m_Bias = (network[0].getInputSize() > NUM_INPUTS);
+	for (size_t l = 0; l < NUM_LAYERS; ++l) {
+		c_BasicPerceptronLayer<T> &layer = network[l];
+		const T *src = layer.getWeights();
+		T *weights = getWeights(l);
+		for (size_t i = 0; i < SIZES[l + 1]; ++i) {
+			for (size_t j = 0; j < layer.getInputSize(); ++j) {
+				weights[(j * SIZES[l + 1]) + i] = src[(i * layer.getStride()) + j];
+			}
+			if (!m_Bias) {
+				weights[(SIZES[l] * SIZES[l + 1]) + i] = 0.0;
+			}
+		}
+	}
+	return true;
+}
+
+template <typename T, size_t... Sizes>
+bool c_FixedNetwork<T, Sizes...>::toNetwork(c_BasicNeuralNetwork<T> &network) const
+{
+	// Copy the weights and configuration into a network with the same layer sizes (its bias is set to match)
+	if (network.getSize() != NUM_LAYERS) {
+		return false;
+	}
+	network.setBias(m_Bias);
+	if (!_matches(network)) {
+		return false;
+	}
+	network.setActivation(m_ActType);
+	network.setActPrecision(m_ActPrecision);
+	for (size_t l = 0; l < NUM_LAYERS; ++l) {
+		c_BasicPerceptronLayer<T> &layer = network[l];
+		T *dst = layer.getWeights();
+		const T *weights = &m_Weights[fixedLayerOffset(SIZES, l)];
+		for (size_t i = 0; i < SIZES[l + 1]; ++i) {
+			for (size_t j = 0; j < layer.getInputSize(); ++j) {
+				dst[(i * layer.getStride()) + j] = weights[(j * SIZES[l + 1]) + i];
+			}
+		}
+	}
+	return true;
+}
+
+template <typename T, size_t... Sizes>
+void c_FixedNetwork<T, Sizes...>::infer(const T *inputs, T *outputs) const
+{
+	// Thread-safe inference, with the activations held on the stack
+	std::array<T, MAX_SIZE> buffer;
+	std::array<T, MAX_SIZE> spare;
+	_inferLayer<0>(inputs, buffer.data(), spare.data(), outputs);
+}
+
+template <typename T, size_t... Sizes>
+bool c_FixedNetwork<T, Sizes...>::_matches(c_BasicNeuralNetwork<T> &network) const
+{
+	if ((network.getSize() != NUM_LAYERS) || (network.getNumInputs() != NUM_INPUTS)) {
+		return false;
+	}
+	for (size_t l = 0; l < NUM_LAYERS; ++l) {
+		if (network[l].getSize() != SIZES[l + 1]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename T, size_t... Sizes>
+template <size_t L>
+void c_FixedNetwork<T, Sizes...>::_inferLayer(const T *inputs, T *buffer, T *spare, T *outputs) const
+{
+	// Evaluate layer L from inputs into buffer (or outputs for the last layer), then recurse into the next layer,
+	// which reads buffer and writes spare
+	constexpr size_t numInputs = SIZES[L];
+	constexpr size_t numOutputs = SIZES[L + 1];
+	const T *weights = &m_Weights[fixedLayerOffset(SIZES, L)];
+	T sums[numOutputs];
+	// Start from the bias weights (zero without bias), then add each input's row of weighted contributions
+	const T *biasWeights = weights + (numInputs * numOutputs);
+	for (size_t i = 0; i < numOutputs; ++i) {
+		sums[i] = biasWeights[i];
+	}
+	for (size_t j = 0; j < numInputs; ++j) {
+		const T input = inputs[j];
+		const T *row = weights + (j * numOutputs);
+		for (size_t i = 0; i < numOutputs; ++i) {
+			sums[i] += row[i] * input;
+		}
+	}
+	if constexpr ((L + 1) == NUM_LAYERS) {
+		activate(m_ActType, m_ActPrecision, sums, outputs, numOutputs);
+	} else {
+		activate(m_ActType, m_ActPrecision, sums, buffer, numOutputs);
+		_inferLayer<L + 1>(buffer, spare, buffer, outputs);
+	}
+}
+
+#endif FIXEDNETWORK_H_
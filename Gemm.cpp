@@ -0,0 +1,517 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Gemm.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Gemm.h"
+#include "AlignedBuffer.h"
+#include "Kernels.h"
+
+#ifdef BASICNN_BLAS
+// The CBLAS header of the BLAS found by CMake (cblas.h, or mkl_cblas.h for MKL)
+#ifndef BASICNN_CBLAS_HEADER
+#define BASICNN_CBLAS_HEADER <cblas.h>
+#endif
+#include BASICNN_CBLAS_HEADER
+#endif
+
+// Blocking of the packed engine, in bytes so it suits either type: each micro-panel of B (kc rows of one tile's
+// columns) stays in half the L1 cache while every tile of the A block streams past it, and each block of A (mc rows
+// by kc) stays in half the L2 cache while it is used against every micro-panel of B
+const size_t GEMM_PANEL_BYTES = 24576;
+const size_t GEMM_BLOCK_BYTES = 1048576;
+// Columns of op(B) packed at a time, bounding the packed B buffer
+const size_t GEMM_PANEL_COLUMNS = 4096;
+// Below this many multiply-adds (or with a single row or column of C), packing costs more than it saves, so gemm
+// runs plain loops over the vector kernels instead
+const size_t GEMM_PACK_MIN = 65536;
+// Largest micro-kernel tile (elements), for the edge tiles computed aside
+const size_t GEMM_MAX_TILE = 512;
+// Size (in bytes) of the block of B rows reused across every row of A by gemmInt8, sized to sit in the L1 cache
+const size_t GEMM_INT8_BLOCK_BYTES = 16384;
+
+template <typename T>
+static void _addImplicit(const bool &transA, const size_t &m, const size_t &n, const size_t &k, const T &alpha,
+						 const T *a, const size_t &lda, const T *bias, const size_t &biasStride, const bool &onesColumn,
+						 T *c, const size_t &ldc)
+{
+	// Accumulate the implicit bias row of op(B) (against the ones column of op(A)), or the ones column of op(B), into
+	// C (already scaled by beta)
+	for (size_t i = 0; i < m; ++i) {
+		T *cRow = c + (i * ldc);
+		if (bias != NULL) {
+			for (size_t j = 0; j < n; ++j) {
+				cRow[j] += alpha * bias[j * biasStride];
+			}
+		}
+		if (onesColumn) {
+			T sum = 0.0;
+			for (size_t p = 0; p < k; ++p) {
+				sum += transA ? a[(p * lda) + i] : a[(i * lda) + p];
+			}
+			cRow[n] += alpha * sum;
+		}
+	}
+}
+
+template <typename T>
+static void _gemmLoops(const bool &transA, const bool &transB, const size_t &m, const size_t &n, const size_t &k,
+					   const T &alpha, const T *a, const size_t &lda, const T *b, const size_t &ldb,
+					   const T *bias, const size_t &biasStride, const bool &onesColumn,
+					   const T &beta, T *c, const size_t &ldc)
+{
+	// Scale C by beta first, so every case below only needs to accumulate into C
+	const size_t cols = onesColumn ? (n + 1) : n;
+	for (size_t i = 0; i < m; ++i) {
+		T *cRow = c + (i * ldc);
+		for (size_t j = 0; j < cols; ++j) {
+			cRow[j] = (beta == 0.0) ? static_cast<T>(0.0) : (beta * cRow[j]);
+		}
+	}
+	// Accumulate alpha * op(A) * op(B), ordering the loops so the innermost loop runs along contiguous rows
+	if (!transA && !transB) {
+		for (size_t i = 0; i < m; ++i) {
+			T *cRow = c + (i * ldc);
+			for (size_t p = 0; p < k; ++p) {
+				kernelAxpy(alpha * a[(i * lda) + p], b + (p * ldb), cRow, n);
+			}
+		}
+	} else if (!transA && transB) {
+		for (size_t i = 0; i < m; ++i) {
+			const T *aRow = a + (i * lda);
+			T *cRow = c + (i * ldc);
+			for (size_t j = 0; j < n; ++j) {
+				cRow[j] += alpha * kernelDot(aRow, b + (j * ldb), k);
+			}
+		}
+	} else if (transA && !transB) {
+		for (size_t p = 0; p < k; ++p) {
+			const T *aRow = a + (p * lda);
+			const T *bRow = b + (p * ldb);
+			for (size_t i = 0; i < m; ++i) {
+				kernelAxpy(alpha * aRow[i], bRow, c + (i * ldc), n);
+			}
+		}
+	} else {
+		for (size_t i = 0; i < m; ++i) {
+			T *cRow = c + (i * ldc);
+			for (size_t j = 0; j < n; ++j) {
+				const T *bRow = b + (j * ldb);
+				T sum = 0.0;
+				for (size_t p = 0; p < k; ++p) {
+					sum += a[(p * lda) + i] * bRow[p];
+				}
+				cRow[j] += alpha * sum;
+			}
+		}
+	}
+	_addImplicit(transA, m, n, k, alpha, a, lda, bias, biasStride, onesColumn, c, ldc);
+}
+
+template <typename T>
+static void _packA(const bool &transA, const T *a, const size_t &lda, const size_t &k, const size_t &rowBegin, const size_t &rows,
+				   const size_t &colBegin, const size_t &cols, const size_t &mr, T *packed)
+{
+	// Pack rows [rowBegin, rowBegin + rows) by columns [colBegin, colBegin + cols) of op(A) into panels of mr rows,
+	// each panel column by column (mr contiguous values per column). Rows past the end are zero, and column k (the
+	// implicit bias column, if it is in range) is ones
+	for (size_t ir = 0; ir < rows; ir += mr) {
+		T *panel = packed + (ir * cols);
+		const size_t panelRows = ((ir + mr) < rows) ? mr : (rows - ir);
+		const size_t row = rowBegin + ir;
+		for (size_t p = 0; p < cols; ++p) {
+			const size_t col = colBegin + p;
+			T *dst = panel + (p * mr);
+			size_t i = 0;
+			if (col >= k) {
+				for (; i < panelRows; ++i) {
+					dst[i] = 1.0;
+				}
+			} else if (transA) {
+				const T *src = a + (col * lda) + row;
+				for (; i < panelRows; ++i) {
+					dst[i] = src[i];
+				}
+			} else {
+				const T *src = a + (row * lda) + col;
+				for (; i < panelRows; ++i) {
+					dst[i] = src[i * lda];
+				}
+			}
+			for (; i < mr; ++i) {
+				dst[i] = 0.0;
+			}
+		}
+	}
+}
+
+template <typename T>
+static void _packB(const bool &transB, const T *b, const size_t &ldb, const size_t &k, const size_t &n, const T *bias,
+				   const size_t &biasStride, const bool &onesColumn, const size_t &rowBegin, const size_t &rows,
+				   const size_t &colBegin, const size_t &cols, const size_t &nr, T *packed)
+{
+	// Pack rows [rowBegin, rowBegin + rows) by columns [colBegin, colBegin + cols) of op(B) into panels of nr
+	// columns, each panel row by row (nr contiguous values per row). Row k is the implicit bias row (if it is in
+	// range), column n the implicit ones column (if enabled), and columns past the end are zero
+	for (size_t jr = 0; jr < cols; jr += nr) {
+		T *panel = packed + (jr * rows);
+		const size_t col = colBegin + jr;
+		const size_t panelCols = ((jr + nr) < cols) ? nr : (cols - jr);
+		const size_t bCols = (col >= n) ? 0 : (((col + panelCols) < n) ? panelCols : (n - col));
+		for (size_t p = 0; p < rows; ++p) {
+			const size_t row = rowBegin + p;
+			T *dst = panel + (p * nr);
+			size_t j = 0;
+			if (row >= k) {
+				for (; j < bCols; ++j) {
+					dst[j] = bias[(col + j) * biasStride];
+				}
+			} else if (transB) {
+				const T *src = b + (col * ldb) + row;
+				for (; j < bCols; ++j) {
+					dst[j] = src[j * ldb];
+				}
+			} else {
+				const T *src = b + (row * ldb) + col;
+				for (; j < bCols; ++j) {
+					dst[j] = src[j];
+				}
+			}
+			for (; j < nr; ++j) {
+				dst[j] = (onesColumn && (row < k) && ((col + j) == n)) ? static_cast<T>(1.0) : static_cast<T>(0.0);
+			}
+		}
+	}
+}
+
+template <typename T>
+static void _gemmPacked(const bool &transA, const bool &transB, const size_t &m, const size_t &n, const size_t &k,
+						const T &alpha, const T *a, const size_t &lda, const T *b, const size_t &ldb,
+						const T *bias, const size_t &biasStride, const bool &onesColumn,
+						const T &beta, T *c, const size_t &ldc, const size_t &mr, const size_t &nr)
+{
+	// Cache-blocked product on packed panels (as in Goto and van de Geijn, "Anatomy of high-performance matrix
+	// multiplication"): for each panel of columns and block of k, B is packed once into micro-panels of nr columns,
+	// then each block of rows of A into micro-panels of mr rows, and the micro-kernel runs over every pair. Each
+	// element of C is reduced over k in the same order whichever rows or columns a caller splits C into
+	const size_t kTotal = (bias != NULL) ? (k + 1) : k;
+	const size_t nTotal = onesColumn ? (n + 1) : n;
+	const size_t kc = GEMM_PANEL_BYTES / (nr * sizeof(T));
+	const size_t mc = ((GEMM_BLOCK_BYTES / (kc * sizeof(T))) / mr) * mr;
+	const size_t nc = GEMM_PANEL_COLUMNS;
+	// The packing buffers are per thread, and only ever grow, so repeated products of the same shape do not allocate
+	thread_local c_AlignedBuffer<T> packedA;
+	thread_local c_AlignedBuffer<T> packedB;
+	const size_t blockRows = (m < mc) ? (((m + mr - 1) / mr) * mr) : mc;
+	const size_t panelCols = (nTotal < nc) ? (((nTotal + nr - 1) / nr) * nr) : nc;
+	const size_t blockDepth = (kTotal < kc) ? kTotal : kc;
+	if (packedA.size() < (blockRows * blockDepth)) {
+		packedA.resize(blockRows * blockDepth);
+	}
+	if (packedB.size() < (panelCols * blockDepth)) {
+		packedB.resize(panelCols * blockDepth);
+	}
+	T tile[GEMM_MAX_TILE];
+	for (size_t jc = 0; jc < nTotal; jc += nc) {
+		const size_t nb = ((jc + nc) < nTotal) ? nc : (nTotal - jc);
+		for (size_t pc = 0; pc < kTotal; pc += kc) {
+			const size_t kb = ((pc + kc) < kTotal) ? kc : (kTotal - pc);
+			// Apply beta with the first block of k only, then accumulate
+			const T blockBeta = (pc == 0) ? beta : static_cast<T>(1.0);
+			_packB(transB, b, ldb, k, n, bias, biasStride, onesColumn, pc, kb, jc, nb, nr, packedB.data());
+			for (size_t ic = 0; ic < m; ic += mc) {
+				const size_t mb = ((ic + mc) < m) ? mc : (m - ic);
+				_packA(transA, a, lda, k, ic, mb, pc, kb, mr, packedA.data());
+				for (size_t jr = 0; jr < nb; jr += nr) {
+					const size_t tileCols = ((jr + nr) < nb) ? nr : (nb - jr);
+					const T *panelB = packedB.data() + (jr * kb);
+					for (size_t ir = 0; ir < mb; ir += mr) {
+						const size_t tileRows = ((ir + mr) < mb) ? mr : (mb - ir);
+						const T *panelA = packedA.data() + (ir * kb);
+						T *cTile = c + ((ic + ir) * ldc) + jc + jr;
+						if ((tileRows == mr) && (tileCols == nr)) {
+							kernelGemm(kb, alpha, panelA, panelB, blockBeta, cTile, ldc);
+						} else {
+							// Edge tile: compute the whole tile aside, then merge the part inside C
+							kernelGemm(kb, alpha, panelA, panelB, static_cast<T>(0.0), tile, nr);
+							for (size_t i = 0; i < tileRows; ++i) {
+								T *cRow = cTile + (i * ldc);
+								for (size_t j = 0; j < tileCols; ++j) {
+									cRow[j] = (blockBeta == 0.0) ? tile[(i * nr) + j] : (tile[(i * nr) + j] + (blockBeta * cRow[j]));
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+static e_GemmBackend& _gemmBackend()
+{
+	// The selected backend, defaulting to the BLAS when the library was built with one
+#ifdef BASICNN_BLAS
+	static e_GemmBackend backend = GEMM_BLAS;
+#else
+	static e_GemmBackend backend = GEMM_BUILTIN;
+#endif
+	return backend;
+}
+
+#ifdef BASICNN_BLAS
+static CBLAS_TRANSPOSE _blasTrans(const bool &trans)
+{
+	return trans ? CblasTrans : CblasNoTrans;
+}
+
+static void _blasGemm(const bool &transA, const bool &transB, const size_t &m, const size_t &n, const size_t &k,
+					  const double &alpha, const double *a, const size_t &lda, const double *b, const size_t &ldb,
+					  const double &beta, double *c, const size_t &ldc)
+{
+	cblas_dgemm(CblasRowMajor, _blasTrans(transA), _blasTrans(transB), static_cast<int>(m), static_cast<int>(n), static_cast<int>(k),
+				alpha, a, static_cast<int>(lda), b, static_cast<int>(ldb), beta, c, static_cast<int>(ldc));
+}
+
+static void _blasGemm(const bool &transA, const bool &transB, const size_t &m, const size_t &n, const size_t &k,
+					  const float &alpha, const float *a, const size_t &lda, const float *b, const size_t &ldb,
+					  const float &beta, float *c, const size_t &ldc)
+{
+	cblas_sgemm(CblasRowMajor, _blasTrans(transA), _blasTrans(transB), static_cast<int>(m), static_cast<int>(n), static_cast<int>(k),
+				alpha, a, static_cast<int>(lda), b, static_cast<int>(ldb), beta, c, static_cast<int>(ldc));
+}
+
+static void _blasGemv(const bool &trans, const size_t &m, const size_t &n, const double &alpha, const double *a, const size_t &lda,
+					  const double *x, const double &beta, double *y)
+{
+	cblas_dgemv(CblasRowMajor, _blasTrans(trans), static_cast<int>(m), static_cast<int>(n), alpha, a, static_cast<int>(lda), x, 1, beta, y, 1);
+}
+
+static void _blasGemv(const bool &trans, const size_t &m, const size_t &n, const float &alpha, const float *a, const size_t &lda,
+					  const float *x, const float &beta, float *y)
+{
+	cblas_sgemv(CblasRowMajor, _blasTrans(trans), static_cast<int>(m), static_cast<int>(n), alpha, a, static_cast<int>(lda), x, 1, beta, y, 1);
+}
+
+static void _blasGer(const size_t &m, const size_t &n, const double &alpha, const double *x, const double *y, double *a, const size_t &lda)
+{
+	cblas_dger(CblasRowMajor, static_cast<int>(m), static_cast<int>(n), alpha, x, 1, y, 1, a, static_cast<int>(lda));
+}
+
+static void _blasGer(const size_t &m, const size_t &n, const float &alpha, const float *x, const float *y, float *a, const size_t &lda)
+{
+	cblas_sger(CblasRowMajor, static_cast<int>(m), static_cast<int>(n), alpha, x, 1, y, 1, a, static_cast<int>(lda));
+}
+#endif
+
+template <typename T>
+static void _gemm(const bool &transA, const bool &transB, const size_t &m, const size_t &n, const size_t &k,
+				  const T &alpha, const T *a, const size_t &lda, const T *b, const size_t &ldb,
+				  const T *bias, const size_t &biasStride, const bool &onesColumn,
+				  const T &beta, T *c, const size_t &ldc)
+{
+#ifdef BASICNN_BLAS
+	if ((_gemmBackend() == GEMM_BLAS) && (m > 0) && (n > 0) && (k > 0)) {
+		// The BLAS computes the product itself; the implicit bias row or ones column is then added on
+		if (onesColumn) {
+			for (size_t i = 0; i < m; ++i) {
+				c[(i * ldc) + n] = (beta == 0.0) ? static_cast<T>(0.0) : (beta * c[(i * ldc) + n]);
+			}
+		}
+		_blasGemm(transA, transB, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+		_addImplicit(transA, m, n, k, alpha, a, lda, bias, biasStride, onesColumn, c, ldc);
+		return;
+	}
+#endif
+	size_t mr;
+	size_t nrDouble;
+	size_t nrFloat;
+	kernelGemmShape(mr, nrDouble, nrFloat);
+	const size_t nr = (sizeof(T) == sizeof(double)) ? nrDouble : nrFloat;
+	if ((_gemmBackend() == GEMM_REFERENCE) || (m < 2) || (n < 2) || (k == 0) || ((m * n * k) < GEMM_PACK_MIN) ||
+		((mr * nr) > GEMM_MAX_TILE)) {
+		_gemmLoops(transA, transB, m, n, k, alpha, a, lda, b, ldb, bias, biasStride, onesColumn, beta, c, ldc);
+	} else {
+		_gemmPacked(transA, transB, m, n, k, alpha, a, lda, b, ldb, bias, biasStride, onesColumn, beta, c, ldc, mr, nr);
+	}
+}
+
+template <typename T>
+void gemm(const bool &transA, const bool &transB, const size_t &m, const size_t &n, const size_t &k,
+		  const T &alpha, const T *a, const size_t &lda, const T *b, const size_t &ldb,
+		  const T &beta, T *c, const size_t &ldc)
+{
+	_gemm<T>(transA, transB, m, n, k, alpha, a, lda, b, ldb, NULL, 0, false, beta, c, ldc);
+}
+
+template <typename T>
+void gemmBias(const bool &transA, const bool &transB, const size_t &m, const size_t &n, const size_t &k,
+			  const T &alpha, const T *a, const size_t &lda, const T *b, const size_t &ldb,
+			  const T *bias, const size_t &biasStride, const T &beta, T *c, const size_t &ldc)
+{
+	_gemm<T>(transA, transB, m, n, k, alpha, a, lda, b, ldb, bias, biasStride, false, beta, c, ldc);
+}
+
+template <typename T>
+void gemmBiasGrad(const bool &transA, const bool &transB, const size_t &m, const size_t &n, const size_t &k,
+				  const T &alpha, const T *a, const size_t &lda, const T *b, const size_t &ldb,
+				  const T &beta, T *c, const size_t &ldc)
+{
+	_gemm<T>(transA, transB, m, n, k, alpha, a, lda, b, ldb, NULL, 0, true, beta, c, ldc);
+}
+
+template <typename T>
+void gemv(const bool &trans, const size_t &m, const size_t &n, const T &alpha, const T *a, const size_t &lda,
+		  const T *x, const T &beta, T *y)
+{
+#ifdef BASICNN_BLAS
+	if ((_gemmBackend() == GEMM_BLAS) && (m > 0) && (n > 0)) {
+		_blasGemv(trans, m, n, alpha, a, lda, x, beta, y);
+		return;
+	}
+#endif
+	if (!trans) {
+		// A dot product per row of A
+		for (size_t i = 0; i < m; ++i) {
+			const T sum = alpha * kernelDot(a + (i * lda), x, n);
+			y[i] = (beta == 0.0) ? sum : (sum + (beta * y[i]));
+		}
+	} else {
+		// Scale y, then accumulate the rows of A weighted by x
+		for (size_t j = 0; j < n; ++j) {
+			y[j] = (beta == 0.0) ? static_cast<T>(0.0) : (beta * y[j]);
+		}
+		for (size_t i = 0; i < m; ++i) {
+			kernelAxpy(alpha * x[i], a + (i * lda), y, n);
+		}
+	}
+}
+
+template <typename T>
+void ger(const size_t &m, const size_t &n, const T &alpha, const T *x, const T *y, T *a, const size_t &lda)
+{
+#ifdef BASICNN_BLAS
+	if ((_gemmBackend() == GEMM_BLAS) && (m > 0) && (n > 0)) {
+		_blasGer(m, n, alpha, x, y, a, lda);
+		return;
+	}
+#endif
+	for (size_t i = 0; i < m; ++i) {
+		kernelAxpy(alpha * x[i], y, a + (i * lda), n);
+	}
+}
+
+e_GemmBackend getGemmBackend()
+{
+	return _gemmBackend();
+}
+
+bool hasGemmBackend(const e_GemmBackend &backend)
+{
+	// The reference and built-in backends are always there, the BLAS one only when the library was built with it
+#ifndef BASICNN_BLAS
+	if (backend == GEMM_BLAS) {
+		return false;
+	}
+#endif
+	return (backend >= GEMM_REFERENCE) && (backend <= GEMM_BLAS);
+}
+
+bool setGemmBackend(const e_GemmBackend &backend)
+{
+	// Select a backend (e.g. to compare them); fails if the library was not built with it
+	if (!hasGemmBackend(backend)) {
+		return false;
+	}
+	_gemmBackend() = backend;
+	return true;
+}
+
+const char* getGemmBackendName(const e_GemmBackend &backend)
+{
+	switch (backend) {
+	case GEMM_BUILTIN:
+		return "builtin";
+	case GEMM_BLAS:
+		return "blas";
+	default:
+		return "reference";
+	}
+}
+
+void gemmInt8(const size_t &m, const size_t &n, const size_t &k, const int8_t *a, const size_t &lda,
+			  const int8_t *b, const size_t &ldb, int32_t *c, const size_t &ldc)
+{
+	// Take B a block of rows at a time (a whole number of micro-kernel tiles), so each block stays in cache while
+	// every tile of rows of A is multiplied with it. The columns of C left over from the last tile take plain dot
+	// products
+	size_t tileRows = 0;
+	size_t tileCols = 0;
+	kernelGemmInt8Shape(tileRows, tileCols);
+	const size_t fitRows = (ldb > 0) ? (GEMM_INT8_BLOCK_BYTES / ldb) : 0;
+	const size_t blockRows = (fitRows > tileCols) ? (fitRows - (fitRows % tileCols)) : tileCols;
+	for (size_t begin = 0; begin < n; begin += blockRows) {
+		const size_t end = ((begin + blockRows) < n) ? (begin + blockRows) : n;
+		const size_t tileEnd = end - ((end - begin) % tileCols);
+		for (size_t i = 0; i < m; i += tileRows) {
+			const size_t rows = ((i + tileRows) < m) ? tileRows : (m - i);
+			const int8_t *aRows = a + (i * lda);
+			int32_t *cRows = c + (i * ldc);
+			for (size_t j = begin; j < tileEnd; j += tileCols) {
+				kernelGemmInt8(rows, k, aRows, lda, b + (j * ldb), ldb, cRows + j, ldc);
+			}
+			for (size_t r = 0; r < rows; ++r) {
+				for (size_t j = tileEnd; j < end; ++j) {
+					cRows[(r * ldc) + j] = kernelDotInt8(aRows + (r * lda), b + (j * ldb), k);
+				}
+			}
+		}
+	}
+}
+
+// Explicit instantiations
+template void gemm<float>(const bool &transA, const bool &transB, const size_t &m, const size_t &n, const size_t &k,
+						  const float &alpha, const float *a, const size_t &lda, const float *b, const size_t &ldb,
+						  const float &beta, float *c, const size_t &ldc);
+template void gemm<double>(const bool &transA, const bool &transB, const size_t &m, const size_t &n, const size_t &k,
+						   const double &alpha, const double *a, const size_t &lda, const double *b, const size_t &ldb,
+						   const double &beta, double *c, const size_t &ldc);
+template void gemmBias<float>(const bool &transA, const bool &transB, const size_t &m, const size_t &n, const size_t &k,
+							  const float &alpha, const float *a, const size_t &lda, const float *b, const size_t &ldb,
+							  const float *bias, const size_t &biasStride, const float &beta, float *c, const size_t &ldc);
+template void gemmBias<double>(const bool &transA, const bool &transB, const size_t &m, const size_t &n, const size_t &k,
+							   const double &alpha, const double *a, const size_t &lda, const double *b, const size_t &ldb,
+							   const double *bias, const size_t &biasStride, const double &beta, double *c, const size_t &ldc);
+template void gemmBiasGrad<float>(const bool &transA, const bool &transB, const size_t &m, const size_t &n, const size_t &k,
+								  const float &alpha, const float *a, const size_t &lda, const float *b, const size_t &ldb,
+								  const float &beta, float *c, const size_t &ldc);
+template void gemmBiasGrad<double>(const bool &transA, const bool &transB, const size_t &m, const size_t &n, const size_t &k,
+								   const double &alpha, const double *a, const size_t &lda, const double *b, const size_t &ldb,
+								   const double &beta, double *c, const size_t &ldc);
+template void gemv<float>(const bool &trans, const size_t &m, const size_t &n, const float &alpha, const float *a, const size_t &lda,
+						  const float *x, const float &beta, float *y);
+template void gemv<double>(const bool &trans, const size_t &m, const size_t &n, const double &alpha, const double *a, const size_t &lda,
+						   const double *x, const double &beta, double *y);
+template void ger<float>(const size_t &m, const size_t &n, const float &alpha, const float *x, const float *y, float *a, const size_t &lda);
+template void ger<double>(const size_t &m, const size_t &n, const double &alpha, const double *x, const double *y, double *a, const size_t &lda);
@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Gemm.h
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef GEMM_H_
+#define GEMM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Backends for the floating point products below (gemm, gemmBias, gemmBiasGrad, gemv and ger):
+// GEMM_REFERENCE: plain loops over the vector kernels, kept as the reference for comparing the others against
+// GEMM_BUILTIN: the built-in cache-blocked engine for gemm (the vector kernels for gemv and ger)
+// GEMM_BLAS: the external CBLAS (OpenBLAS, BLIS or MKL) found by CMake, if the library was built with one
+enum e_GemmBackend {
+	GEMM_REFERENCE,
+	GEMM_BUILTIN,
+	GEMM_BLAS
+};
+
+// General matrix-matrix product on row-major matrices, following the BLAS convention:
+// C (m x n) = alpha * op(A) (m x k) * op(B) (k x n) + beta * C
+// where op(X) is X, or its transpose when the corresponding trans flag is set. With the built-in backend, larger
+// products run cache-blocked on packed panels through the register-tiled kernelGemm micro-kernel, and small ones
+// through the vector kernels directly.
+template <typename T>
+void gemm(const bool &transA, const bool &transB, const size_t &m, const size_t &n, const size_t &k,
+		  const T &alpha, const T *a, const size_t &lda, const T *b, const size_t &ldb,
+		  const T &beta, T *c, const size_t &ldc);
+
+// As gemm, with op(A) extended by an implicit trailing column of ones and op(B) by an implicit trailing row holding
+// bias (n values, biasStride apart): C (m x n) = alpha * (op(A) * op(B) + 1 * bias^T) + beta * C. This applies a
+// layer's bias weights without a ones column being stored in the inputs
+template <typename T>
+void gemmBias(const bool &transA, const bool &transB, const size_t &m, const size_t &n, const size_t &k,
+			  const T &alpha, const T *a, const size_t &lda, const T *b, const size_t &ldb,
+			  const T *bias, const size_t &biasStride, const T &beta, T *c, const size_t &ldc);
+
+// As gemm, with op(B) extended by an implicit trailing column of ones: C (m x (n + 1)) = alpha * op(A) * [op(B) 1] + beta * C,
+// so column n of C takes alpha times the row sums of op(A) (the gradient of the bias weights applied by gemmBias)
+template <typename T>
+void gemmBiasGrad(const bool &transA, const bool &transB, const size_t &m, const size_t &n, const size_t &k,
+				  const T &alpha, const T *a, const size_t &lda, const T *b, const size_t &ldb,
+				  const T &beta, T *c, const size_t &ldc);
+
+// General matrix-vector product on a row-major matrix: y = alpha * op(A) * x + beta * y, with A (m x n) and op(A)
+// A, or its transpose when trans is set (y is not read when beta is 0)
+template <typename T>
+void gemv(const bool &trans, const size_t &m, const size_t &n, const T &alpha, const T *a, const size_t &lda,
+		  const T *x, const T &beta, T *y);
+
+// Rank-1 update of a row-major matrix: A (m x n) += alpha * x * y^T
+template <typename T>
+void ger(const size_t &m, const size_t &n, const T &alpha, const T *x, const T *y, T *a, const size_t &lda);
+
+// Backend selection: the BLAS backend by default when the library was built with one, otherwise the built-in one
+e_GemmBackend				getGemmBackend();
+bool						hasGemmBackend(const e_GemmBackend &backend);
+bool						setGemmBackend(const e_GemmBackend &backend);
+const char*					getGemmBackendName(const e_GemmBackend &backend);
+
+// Integer matrix product for quantized inference, on row-major matrices: C (m x n) = A (m x k) * B^T (k x n),
+// with B held as n rows of k (so each element of C is the dot product of a row of A and a row of B)
+void gemmInt8(const size_t &m, const size_t &n, const size_t &k, const int8_t *a, const size_t &lda,
+			  const int8_t *b, const size_t &ldb, int32_t *c, const size_t &ldc);
+
+#endif GEMM_H_
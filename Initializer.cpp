@@ -0,0 +1,160 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Initializer.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+
+#include "Initializer.h"
+#include "Kernels.h"
+
+// Blocks of four random words generated per call to generate(), and so weights filled per tile
+const size_t INIT_TILE_BLOCKS = 16;
+const size_t INIT_TILE = INIT_TILE_BLOCKS * 4;
+// 2^-32, mapping a 32 bit random word onto (0, 1)
+const double INIT_WORD_SCALE = 2.3283064365386963e-10;
+const double INIT_TWO_PI = 6.283185307179586;
+
+template <typename T>
+c_BasicInitializer<T>::c_BasicInitializer(const e_InitScheme &scheme, const uint64_t &seed, const T &scale) :
+	m_Scheme(scheme),
+	m_Seed(seed),
+	m_Scale(scale)
+{
+}
+
+template <typename T>
+c_BasicInitializer<T>::~c_BasicInitializer()
+{
+}
+
+template <typename T>
+void c_BasicInitializer<T>::setScheme(const e_InitScheme &scheme)
+{
+	m_Scheme = scheme;
+}
+
+template <typename T>
+void c_BasicInitializer<T>::setSeed(const uint64_t &seed)
+{
+	m_Seed = seed;
+}
+
+template <typename T>
+void c_BasicInitializer<T>::setScale(const T &scale)
+{
+	m_Scale = scale;
+}
+
+template <typename T>
+const e_InitScheme c_BasicInitializer<T>::getScheme() const
+{
+	return m_Scheme;
+}
+
+template <typename T>
+const uint64_t c_BasicInitializer<T>::getSeed() const
+{
+	return m_Seed;
+}
+
+template <typename T>
+const T c_BasicInitializer<T>::getScale() const
+{
+	return m_Scale;
+}
+
+template <typename T>
+void c_BasicInitializer<T>::generate(const uint64_t &stream, const uint64_t &row, const uint64_t &block, const size_t &numBlocks, uint32_t *output) const
+{
+	// Four random words per block of a row: the counter holds the block, the row and the stream, and the key the
+	// seed (rows and blocks beyond 2^32 wrap, far past any layer this is used for)
+	const uint32_t counter[4] = { static_cast<uint32_t>(block), static_cast<uint32_t>(row), static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32) };
+	const uint32_t key[2] = { static_cast<uint32_t>(m_Seed), static_cast<uint32_t>(m_Seed >> 32) };
+	kernelPhilox(counter, key, numBlocks, output);
+}
+
+template <typename T>
+void c_BasicInitializer<T>::fillRow(const uint64_t &stream, const uint64_t &row, const size_t &fanIn, const size_t &fanOut, T *weights, const size_t &n) const
+{
+	// Fill one row of n weights, a tile of blocks of random words at a time (weight i always comes from word i % 4
+	// of block i / 4, however the row is split)
+	const double fanSum = static_cast<double>(fanIn + fanOut);
+	const double scale = static_cast<double>(m_Scale);
+	bool normal = false;
+	double range = scale;
+	switch (m_Scheme) {
+	case INIT_NORMAL:
+		normal = true;
+		break;
+	case INIT_XAVIER_UNIFORM:
+		range = scale * std::sqrt(6.0 / fanSum);
+		break;
+	case INIT_XAVIER_NORMAL:
+		normal = true;
+		range = scale * std::sqrt(2.0 / fanSum);
+		break;
+	case INIT_HE_UNIFORM:
+		range = scale * std::sqrt(6.0 / static_cast<double>(fanIn));
+		break;
+	case INIT_HE_NORMAL:
+		normal = true;
+		range = scale * std::sqrt(2.0 / static_cast<double>(fanIn));
+		break;
+	default:
+		break;
+	}
+	uint32_t words[INIT_TILE];
+	T values[INIT_TILE];
+	const T tileRange = static_cast<T>(range);
+	for (size_t begin = 0; begin < n; begin += INIT_TILE) {
+		const size_t count = ((n - begin) < INIT_TILE) ? (n - begin) : INIT_TILE;
+		const size_t numBlocks = (count + 3) / 4;
+		generate(stream, row, begin / 4, numBlocks, words);
+		for (size_t i = 0; i < numBlocks * 4; ++i) {
+			// Uniform on (0, 1], never 0 (so the logarithm below is finite)
+			values[i] = static_cast<T>((static_cast<double>(words[i]) + 0.5) * INIT_WORD_SCALE);
+		}
+		if (normal) {
+			// Box-Muller: each pair of uniforms gives a pair of standard normals
+			for (size_t i = 0; i < numBlocks * 4; i += 2) {
+				const T radius = tileRange * std::sqrt(static_cast<T>(-2.0) * std::log(values[i]));
+				const T angle = static_cast<T>(INIT_TWO_PI) * values[i + 1];
+				values[i] = radius * std::cos(angle);
+				values[i + 1] = radius * std::sin(angle);
+			}
+		} else {
+			for (size_t i = 0; i < numBlocks * 4; ++i) {
+				values[i] = tileRange * ((static_cast<T>(2.0) * values[i]) - static_cast<T>(1.0));
+			}
+		}
+		for (size_t i = 0; i < count; ++i) {
+			weights[begin + i] = values[i];
+		}
+	}
+}
+
+// Explicit instantiations
+template class c_BasicInitializer<float>;
+template class c_BasicInitializer<double>;
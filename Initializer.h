@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Initializer.h
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef INITIALIZER_H_
+#define INITIALIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+enum e_InitScheme {
+	INIT_UNIFORM,
+	INIT_NORMAL,
+	INIT_XAVIER_UNIFORM,
+	INIT_XAVIER_NORMAL,
+	INIT_HE_UNIFORM,
+	INIT_HE_NORMAL
+};
+
+// Weight initializer. Every row of weights is generated from its own counter-based (Philox, see kernelPhilox)
+// stream, identified by a stream (normally the layer index) and the row, so the weights depend only on the seed and
+// never on the number of threads filling them. The scale is a gain applied to the scheme's range:
+//   INIT_UNIFORM         U(-scale, scale)
+//   INIT_NORMAL          N(0, scale^2)
+//   INIT_XAVIER_UNIFORM  U(-a, a), a = scale * sqrt(6 / (fanIn + fanOut))
+//   INIT_XAVIER_NORMAL   N(0, s^2), s = scale * sqrt(2 / (fanIn + fanOut))
+//   INIT_HE_UNIFORM      U(-a, a), a = scale * sqrt(6 / fanIn)
+//   INIT_HE_NORMAL       N(0, s^2), s = scale * sqrt(2 / fanIn)
+// The random bits come from generate() (numBlocks blocks of four words from the given block of a row), which may be
+// overridden to plug in another counter-based generator
+template <typename T>
+class c_BasicInitializer {
+public:
+	// Constructors
+									c_BasicInitializer(const e_InitScheme &scheme = INIT_XAVIER_UNIFORM, const uint64_t &seed = 0, const T &scale = 1.0);
+	// Destructor
+	virtual							~c_BasicInitializer();
+	// Set
+	void							setScheme(const e_InitScheme &scheme);
+	void							setSeed(const uint64_t &seed);
+	void							setScale(const T &scale);
+	// Get
+	const e_InitScheme				getScheme() const;
+	const uint64_t					getSeed() const;
+	const T							getScale() const;
+	// Functions
+	virtual void					generate(const uint64_t &stream, const uint64_t &row, const uint64_t &block, const size_t &numBlocks, uint32_t *output) const;
+	void							fillRow(const uint64_t &stream, const uint64_t &row, const size_t &fanIn, const size_t &fanOut, T *weights, const size_t &n) const;
+private:
+	// Variables
+	e_InitScheme					m_Scheme;
+	uint64_t						m_Seed;
+	T								m_Scale;
+};
+
+typedef c_BasicInitializer<double>	c_Initializer;
+typedef c_BasicInitializer<float>	c_InitializerF;
+
+#endif INITIALIZER_H_
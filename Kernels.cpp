@@ -0,0 +1,1716 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Kernels.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "Kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KERNELS_X86_
+#include <immintrin.h>
+#endif
+
+struct s_KernelTable {
+	e_SimdLevel		level;
+	double			(*dotD)(const double *x, const double *y, const size_t &n);
+	void			(*axpyD)(const double &alpha, const double *x, double *y, const size_t &n);
+	void			(*scaleD)(const double &alpha, const double *x, double *y, const size_t &n);
+	float			(*dotF)(const float *x, const float *y, const size_t &n);
+	void			(*axpyF)(const float &alpha, const float *x, float *y, const size_t &n);
+	void			(*scaleF)(const float &alpha, const float *x, float *y, const size_t &n);
+	void			(*sigmoidD)(const double *x, double *y, const size_t &n);
+	void			(*sigmoidF)(const float *x, float *y, const size_t &n);
+	int32_t			(*dotI8)(const int8_t *x, const int8_t *y, const size_t &n);
+	void			(*gemmI8)(const size_t &rows, const size_t &k, const int8_t *a, const size_t &lda, const int8_t *b, const size_t &ldb, int32_t *c, const size_t &ldc);
+	size_t			gemmI8Rows;
+	void			(*quantizeD)(const double *x, const double &scale, int8_t *y, const size_t &n);
+	void			(*quantizeF)(const float *x, const float &scale, int8_t *y, const size_t &n);
+	void			(*dequantizeD)(const int32_t *x, const double &scale, const double *scales, const double *bias, double *y, const size_t &n);
+	void			(*dequantizeF)(const int32_t *x, const float &scale, const float *scales, const float *bias, float *y, const size_t &n);
+	double			(*dotSparseD)(const double *x, const uint32_t *indices, const double *values, const size_t &n);
+	float			(*dotSparseF)(const float *x, const uint32_t *indices, const float *values, const size_t &n);
+	void			(*philox)(const uint32_t counter[4], const uint32_t key[2], const size_t &numBlocks, uint32_t *output);
+	void			(*gemmD)(const size_t &k, const double &alpha, const double *a, const double *b, const double &beta, double *c, const size_t &ldc);
+	void			(*gemmF)(const size_t &k, const float &alpha, const float *a, const float *b, const float &beta, float *c, const size_t &ldc);
+	size_t			gemmRows;
+	size_t			gemmColsD;
+	size_t			gemmColsF;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Approximate sigmoid constants
+//
+// e^t is evaluated as 2^k * e^f, with k = round(t / ln2) and |f| <= ln2 / 2. 2^k is built directly in the
+// exponent bits and e^f comes from a truncated Taylor series (Horner form), whose relative error is bounded
+// by |f|^(N+1) / (N+1)! * e^|f|: degree 9 gives 1e-11 for double and degree 6 gives 2e-7 for float.
+// Since d(sigmoid)/d(e) <= 1/4, the absolute error of the sigmoid is at most a quarter of that (plus rounding).
+// Inputs are clamped to the range where 2^k stays a normal number, which saturates the sigmoid to 0 or 1.
+///////////////////////////////////////////////////////////////////////////////
+
+const double EXP_LOG2E = 1.4426950408889634;
+const double EXP_LN2_HI = 0.693145751953125;
+const double EXP_LN2_LO = 1.428606820309417e-06;
+const double EXP_CLAMP_D = 708.0;
+const float EXP_CLAMP_F = 87.0f;
+const double EXP_COEFFS_D[] = { 1.0 / 362880.0, 1.0 / 40320.0, 1.0 / 5040.0, 1.0 / 720.0, 1.0 / 120.0, 1.0 / 24.0, 1.0 / 6.0, 0.5, 1.0, 1.0 };
+const float EXP_COEFFS_F[] = { 1.0f / 720.0f, 1.0f / 120.0f, 1.0f / 24.0f, 1.0f / 6.0f, 0.5f, 1.0f, 1.0f };
+const size_t EXP_DEGREE_D = 9;
+const size_t EXP_DEGREE_F = 6;
+
+///////////////////////////////////////////////////////////////////////////////
+// Philox4x32-10 constants
+//
+// Each round multiplies counter words 0 and 2 by M0 and M1, mixes the high halves of the products into the other
+// two words with the key, and bumps the key by the Weyl increments W0 and W1 (the golden ratio and sqrt(3) - 1)
+///////////////////////////////////////////////////////////////////////////////
+
+const uint32_t PHILOX_M0 = 0xD2511F53;
+const uint32_t PHILOX_M1 = 0xCD9E8D57;
+const uint32_t PHILOX_W0 = 0x9E3779B9;
+const uint32_t PHILOX_W1 = 0xBB67AE85;
+const size_t PHILOX_ROUNDS = 10;
+
+///////////////////////////////////////////////////////////////////////////////
+// GEMM micro-kernel tile shapes
+//
+// Each micro-kernel keeps an MR x NR tile of C in registers for the whole of its k loop, so every value of A it
+// broadcasts is used NR times and every vector of B it loads MR times. NR is two vectors wide, and MR takes as many
+// rows as the registers left after the two B vectors and the broadcast allow (12 of 16 ymm, or 24 of 32 zmm)
+///////////////////////////////////////////////////////////////////////////////
+
+const size_t GEMM_MR_SCALAR = 4;
+const size_t GEMM_NR_SCALAR = 4;
+const size_t GEMM_MR_AVX2 = 6;
+const size_t GEMM_MR_AVX512 = 12;
+
+///////////////////////////////////////////////////////////////////////////////
+// Int8 GEMM micro-kernel tile shapes
+//
+// Each micro-kernel takes up to MR rows of A against NR rows of B (C = A * B^T, so both run along k), keeping a
+// vector of 32 bit sums for every pair in registers for the whole of its k loop: each vector of A is loaded once for
+// NR rows of B and each vector of B once for MR rows of A. MR is 2 while the sums take ymm (or xmm) registers, and 4
+// with 32 zmm registers
+///////////////////////////////////////////////////////////////////////////////
+
+const size_t GEMM_INT8_MR = 2;
+const size_t GEMM_INT8_MR_AVX512 = 4;
+const size_t GEMM_INT8_NR = 4;
+// Symmetric range of the int8 quantize kernels
+const float QUANT_INT8_MAX = 127.0f;
+
+///////////////////////////////////////////////////////////////////////////////
+// Scalar kernels
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+static T _dotScalar(const T *x, const T *y, const size_t &n)
+{
+	T sum = 0;
+	for (size_t i = 0; i < n; ++i) {
+		sum += x[i] * y[i];
+	}
+	return sum;
+}
+
+template <typename T>
+static void _axpyScalar(const T &alpha, const T *x, T *y, const size_t &n)
+{
+	for (size_t i = 0; i < n; ++i) {
+		y[i] += alpha * x[i];
+	}
+}
+
+template <typename T>
+static void _scaleScalar(const T &alpha, const T *x, T *y, const size_t &n)
+{
+	for (size_t i = 0; i < n; ++i) {
+		y[i] = alpha * x[i];
+	}
+}
+
+static double _sigmoidApproxScalar(const double &x)
+{
+	double t = -x;
+	t = (t < -EXP_CLAMP_D) ? -EXP_CLAMP_D : ((t > EXP_CLAMP_D) ? EXP_CLAMP_D : t);
+	const double k = std::nearbyint(t * EXP_LOG2E);
+	const double f = (t - (k * EXP_LN2_HI)) - (k * EXP_LN2_LO);
+	double p = EXP_COEFFS_D[0];
+	for (size_t i = 1; i <= EXP_DEGREE_D; ++i) {
+		p = (p * f) + EXP_COEFFS_D[i];
+	}
+	const uint64_t bits = static_cast<uint64_t>(static_cast<int64_t>(k) + 1023) << 52;
+	double scale;
+	memcpy(&scale, &bits, sizeof(scale));
+	return 1.0 / (1.0 + (p * scale));
+}
+
+static float _sigmoidApproxScalar(const float &x)
+{
+	float t = -x;
+	t = (t < -EXP_CLAMP_F) ? -EXP_CLAMP_F : ((t > EXP_CLAMP_F) ? EXP_CLAMP_F : t);
+	const float k = std::nearbyint(t * static_cast<float>(EXP_LOG2E));
+	const float f = (t - (k * static_cast<float>(EXP_LN2_HI))) - (k * static_cast<float>(EXP_LN2_LO));
+	float p = EXP_COEFFS_F[0];
+	for (size_t i = 1; i <= EXP_DEGREE_F; ++i) {
+		p = (p * f) + EXP_COEFFS_F[i];
+	}
+	const uint32_t bits = static_cast<uint32_t>(static_cast<int32_t>(k) + 127) << 23;
+	float scale;
+	memcpy(&scale, &bits, sizeof(scale));
+	return 1.0f / (1.0f + (p * scale));
+}
+
+template <typename T>
+static void _sigmoidScalar(const T *x, T *y, const size_t &n)
+{
+	for (size_t i = 0; i < n; ++i) {
+		y[i] = _sigmoidApproxScalar(x[i]);
+	}
+}
+
+static int32_t _dotInt8Scalar(const int8_t *x, const int8_t *y, const size_t &n)
+{
+	int32_t sum = 0;
+	for (size_t i = 0; i < n; ++i) {
+		sum += static_cast<int32_t>(x[i]) * static_cast<int32_t>(y[i]);
+	}
+	return sum;
+}
+
+template <size_t MR>
+static void _gemmInt8TailScalar(const size_t &begin, const size_t &k, const int8_t *a, const size_t &lda, const int8_t *b, const size_t &ldb, int32_t *c, const size_t &ldc)
+{
+	// Add the products from begin to k of an MR x NR tile (the part of k left over by the vector kernels)
+	for (size_t i = 0; i < MR; ++i) {
+		const int8_t *aRow = a + (i * lda);
+		for (size_t j = 0; j < GEMM_INT8_NR; ++j) {
+			const int8_t *bRow = b + (j * ldb);
+			int32_t sum = 0;
+			for (size_t p = begin; p < k; ++p) {
+				sum += static_cast<int32_t>(aRow[p]) * static_cast<int32_t>(bRow[p]);
+			}
+			c[(i * ldc) + j] += sum;
+		}
+	}
+}
+
+template <size_t MR>
+static void _gemmInt8TileScalar(const size_t &k, const int8_t *a, const size_t &lda, const int8_t *b, const size_t &ldb, int32_t *c, const size_t &ldc)
+{
+	int32_t acc[MR][GEMM_INT8_NR] = {};
+	for (size_t p = 0; p < k; ++p) {
+		for (size_t i = 0; i < MR; ++i) {
+			const int32_t ai = a[(i * lda) + p];
+			for (size_t j = 0; j < GEMM_INT8_NR; ++j) {
+				acc[i][j] += ai * static_cast<int32_t>(b[(j * ldb) + p]);
+			}
+		}
+	}
+	for (size_t i = 0; i < MR; ++i) {
+		for (size_t j = 0; j < GEMM_INT8_NR; ++j) {
+			c[(i * ldc) + j] = acc[i][j];
+		}
+	}
+}
+
+static void _gemmInt8Scalar(const size_t &rows, const size_t &k, const int8_t *a, const size_t &lda, const int8_t *b, const size_t &ldb, int32_t *c, const size_t &ldc)
+{
+	if (rows >= 2) {
+		_gemmInt8TileScalar<2>(k, a, lda, b, ldb, c, ldc);
+	} else {
+		_gemmInt8TileScalar<1>(k, a, lda, b, ldb, c, ldc);
+	}
+}
+
+template <typename T>
+static void _quantizeInt8Scalar(const T *x, const T &scale, int8_t *y, const size_t &n)
+{
+	// Saturate to the symmetric int8 range, then round half away from zero
+	const T limit = static_cast<T>(QUANT_INT8_MAX);
+	for (size_t i = 0; i < n; ++i) {
+		const T value = x[i] * scale;
+		const T clamped = (value > limit) ? limit : ((value < -limit) ? -limit : value);
+		y[i] = static_cast<int8_t>(clamped + ((clamped < 0.0) ? static_cast<T>(-0.5) : static_cast<T>(0.5)));
+	}
+}
+
+template <typename T>
+static void _dequantizeInt32Scalar(const int32_t *x, const T &scale, const T *scales, const T *bias, T *y, const size_t &n)
+{
+	for (size_t i = 0; i < n; ++i) {
+		y[i] = (static_cast<T>(x[i]) * (scale * scales[i])) + bias[i];
+	}
+}
+
+template <typename T>
+static T _dotSparseScalar(const T *x, const uint32_t *indices, const T *values, const size_t &n)
+{
+	T sum = 0;
+	for (size_t i = 0; i < n; ++i) {
+		sum += x[indices[i]] * values[i];
+	}
+	return sum;
+}
+
+template <typename T>
+static void _axpySparseScalar(const T &alpha, const uint32_t *indices, const T *values, T *y, const size_t &n)
+{
+	for (size_t i = 0; i < n; ++i) {
+		y[indices[i]] += alpha * values[i];
+	}
+}
+
+static void _philoxScalar(const uint32_t counter[4], const uint32_t key[2], const size_t &numBlocks, uint32_t *output)
+{
+	for (size_t b = 0; b < numBlocks; ++b) {
+		uint32_t c0 = counter[0] + static_cast<uint32_t>(b);
+		uint32_t c1 = counter[1];
+		uint32_t c2 = counter[2];
+		uint32_t c3 = counter[3];
+		uint32_t k0 = key[0];
+		uint32_t k1 = key[1];
+		for (size_t round = 0; round < PHILOX_ROUNDS; ++round) {
+			const uint64_t product0 = static_cast<uint64_t>(PHILOX_M0) * c0;
+			const uint64_t product1 = static_cast<uint64_t>(PHILOX_M1) * c2;
+			c0 = static_cast<uint32_t>(product1 >> 32) ^ c1 ^ k0;
+			c1 = static_cast<uint32_t>(product1);
+			c2 = static_cast<uint32_t>(product0 >> 32) ^ c3 ^ k1;
+			c3 = static_cast<uint32_t>(product0);
+			k0 += PHILOX_W0;
+			k1 += PHILOX_W1;
+		}
+		output[(b * 4) + 0] = c0;
+		output[(b * 4) + 1] = c1;
+		output[(b * 4) + 2] = c2;
+		output[(b * 4) + 3] = c3;
+	}
+}
+
+#ifdef KERNELS_X86_
+
+template <typename T>
+static void _gemmScalar(const size_t &k, const T &alpha, const T *a, const T *b, const T &beta, T *c, const size_t &ldc)
+{
+	T acc[GEMM_MR_SCALAR][GEMM_NR_SCALAR] = {};
+	for (size_t p = 0; p < k; ++p) {
+		for (size_t i = 0; i < GEMM_MR_SCALAR; ++i) {
+			const T ai = a[(p * GEMM_MR_SCALAR) + i];
+			for (size_t j = 0; j < GEMM_NR_SCALAR; ++j) {
+				acc[i][j] += ai * b[(p * GEMM_NR_SCALAR) + j];
+			}
+		}
+	}
+	for (size_t i = 0; i < GEMM_MR_SCALAR; ++i) {
+		T *cRow = c + (i * ldc);
+		for (size_t j = 0; j < GEMM_NR_SCALAR; ++j) {
+			cRow[j] = (beta == 0.0) ? (alpha * acc[i][j]) : ((alpha * acc[i][j]) + (beta * cRow[j]));
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// SSE2 kernels (no FMA available, so multiply then add)
+///////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("sse2")))
+static double _dotSse2(const double *x, const double *y, const size_t &n)
+{
+	// Two independent accumulators to hide the add latency
+	__m128d acc0 = _mm_setzero_pd();
+	__m128d acc1 = _mm_setzero_pd();
+	size_t i = 0;
+	for (; (i + 4) <= n; i += 4) {
+		acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+		acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(y + i + 2)));
+	}
+	acc0 = _mm_add_pd(acc0, acc1);
+	double sum = _mm_cvtsd_f64(_mm_add_sd(acc0, _mm_unpackhi_pd(acc0, acc0)));
+	for (; i < n; ++i) {
+		sum += x[i] * y[i];
+	}
+	return sum;
+}
+
+__attribute__((target("sse2")))
+static void _axpySse2(const double &alpha, const double *x, double *y, const size_t &n)
+{
+	const __m128d a = _mm_set1_pd(alpha);
+	size_t i = 0;
+	for (; (i + 2) <= n; i += 2) {
+		_mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(a, _mm_loadu_pd(x + i))));
+	}
+	for (; i < n; ++i) {
+		y[i] += alpha * x[i];
+	}
+}
+
+__attribute__((target("sse2")))
+static void _scaleSse2(const double &alpha, const double *x, double *y, const size_t &n)
+{
+	const __m128d a = _mm_set1_pd(alpha);
+	size_t i = 0;
+	for (; (i + 2) <= n; i += 2) {
+		_mm_storeu_pd(y + i, _mm_mul_pd(a, _mm_loadu_pd(x + i)));
+	}
+	for (; i < n; ++i) {
+		y[i] = alpha * x[i];
+	}
+}
+
+__attribute__((target("sse2")))
+static float _dotSse2(const float *x, const float *y, const size_t &n)
+{
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	size_t i = 0;
+	for (; (i + 8) <= n; i += 8) {
+		acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+		acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(y + i + 4)));
+	}
+	acc0 = _mm_add_ps(acc0, acc1);
+	acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+	float sum = _mm_cvtss_f32(_mm_add_ss(acc0, _mm_shuffle_ps(acc0, acc0, 1)));
+	for (; i < n; ++i) {
+		sum += x[i] * y[i];
+	}
+	return sum;
+}
+
+__attribute__((target("sse2")))
+static void _axpySse2(const float &alpha, const float *x, float *y, const size_t &n)
+{
+	const __m128 a = _mm_set1_ps(alpha);
+	size_t i = 0;
+	for (; (i + 4) <= n; i += 4) {
+		_mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(a, _mm_loadu_ps(x + i))));
+	}
+	for (; i < n; ++i) {
+		y[i] += alpha * x[i];
+	}
+}
+
+__attribute__((target("sse2")))
+static void _scaleSse2(const float &alpha, const float *x, float *y, const size_t &n)
+{
+	const __m128 a = _mm_set1_ps(alpha);
+	size_t i = 0;
+	for (; (i + 4) <= n; i += 4) {
+		_mm_storeu_ps(y + i, _mm_mul_ps(a, _mm_loadu_ps(x + i)));
+	}
+	for (; i < n; ++i) {
+		y[i] = alpha * x[i];
+	}
+}
+
+__attribute__((target("sse2")))
+static int32_t _dotInt8Sse2(const int8_t *x, const int8_t *y, const size_t &n)
+{
+	// Sign extend 16 bytes to two vectors of 16 bit values (by unpacking each byte into the high half and
+	// shifting it back down), then multiply and add adjacent pairs into 32 bit sums
+	__m128i acc = _mm_setzero_si128();
+	size_t i = 0;
+	for (; (i + 16) <= n; i += 16) {
+		const __m128i vx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+		const __m128i vy = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i));
+		const __m128i xLo = _mm_srai_epi16(_mm_unpacklo_epi8(vx, vx), 8);
+		const __m128i xHi = _mm_srai_epi16(_mm_unpackhi_epi8(vx, vx), 8);
+		const __m128i yLo = _mm_srai_epi16(_mm_unpacklo_epi8(vy, vy), 8);
+		const __m128i yHi = _mm_srai_epi16(_mm_unpackhi_epi8(vy, vy), 8);
+		acc = _mm_add_epi32(acc, _mm_add_epi32(_mm_madd_epi16(xLo, yLo), _mm_madd_epi16(xHi, yHi)));
+	}
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+	int32_t sum = _mm_cvtsi128_si32(acc);
+	for (; i < n; ++i) {
+		sum += static_cast<int32_t>(x[i]) * static_cast<int32_t>(y[i]);
+	}
+	return sum;
+}
+
+__attribute__((target("sse2")))
+static inline __m128i _reduce4Sse2(const __m128i x0, const __m128i x1, const __m128i x2, const __m128i x3)
+{
+	// Transpose the four vectors of partial sums and add the columns, giving the four totals in one vector
+	const __m128i t0 = _mm_unpacklo_epi32(x0, x1);
+	const __m128i t1 = _mm_unpackhi_epi32(x0, x1);
+	const __m128i t2 = _mm_unpacklo_epi32(x2, x3);
+	const __m128i t3 = _mm_unpackhi_epi32(x2, x3);
+	return _mm_add_epi32(_mm_add_epi32(_mm_unpacklo_epi64(t0, t2), _mm_unpackhi_epi64(t0, t2)),
+						 _mm_add_epi32(_mm_unpacklo_epi64(t1, t3), _mm_unpackhi_epi64(t1, t3)));
+}
+
+template <size_t MR>
+__attribute__((target("sse2")))
+static void _gemmInt8TileSse2(const size_t &k, const int8_t *a, const size_t &lda, const int8_t *b, const size_t &ldb, int32_t *c, const size_t &ldc)
+{
+	// Sign extend 16 bytes of each row to 16 bit values (as in _dotInt8Sse2) once, then multiply and add adjacent
+	// pairs of every row of A with every row of B
+	__m128i acc[MR][GEMM_INT8_NR];
+#pragma GCC unroll 4
+	for (size_t i = 0; i < MR; ++i) {
+#pragma GCC unroll 4
+		for (size_t j = 0; j < GEMM_INT8_NR; ++j) {
+			acc[i][j] = _mm_setzero_si128();
+		}
+	}
+	size_t p = 0;
+	for (; (p + 16) <= k; p += 16) {
+		__m128i aLo[MR];
+		__m128i aHi[MR];
+#pragma GCC unroll 4
+		for (size_t i = 0; i < MR; ++i) {
+			const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + (i * lda) + p));
+			aLo[i] = _mm_srai_epi16(_mm_unpacklo_epi8(va, va), 8);
+			aHi[i] = _mm_srai_epi16(_mm_unpackhi_epi8(va, va), 8);
+		}
+#pragma GCC unroll 4
+		for (size_t j = 0; j < GEMM_INT8_NR; ++j) {
+			const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + (j * ldb) + p));
+			const __m128i bLo = _mm_srai_epi16(_mm_unpacklo_epi8(vb, vb), 8);
+			const __m128i bHi = _mm_srai_epi16(_mm_unpackhi_epi8(vb, vb), 8);
+#pragma GCC unroll 4
+			for (size_t i = 0; i < MR; ++i) {
+				acc[i][j] = _mm_add_epi32(acc[i][j], _mm_add_epi32(_mm_madd_epi16(aLo[i], bLo), _mm_madd_epi16(aHi[i], bHi)));
+			}
+		}
+	}
+#pragma GCC unroll 4
+	for (size_t i = 0; i < MR; ++i) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(c + (i * ldc)), _reduce4Sse2(acc[i][0], acc[i][1], acc[i][2], acc[i][3]));
+	}
+	_gemmInt8TailScalar<MR>(p, k, a, lda, b, ldb, c, ldc);
+}
+
+__attribute__((target("sse2")))
+static void _gemmInt8Sse2(const size_t &rows, const size_t &k, const int8_t *a, const size_t &lda, const int8_t *b, const size_t &ldb, int32_t *c, const size_t &ldc)
+{
+	if (rows >= 2) {
+		_gemmInt8TileSse2<2>(k, a, lda, b, ldb, c, ldc);
+	} else {
+		_gemmInt8TileSse2<1>(k, a, lda, b, ldb, c, ldc);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// AVX2 + FMA kernels
+///////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("avx2,fma")))
+static double _dotAvx2(const double *x, const double *y, const size_t &n)
+{
+	// Four independent accumulators to cover the FMA latency
+	__m256d acc0 = _mm256_setzero_pd();
+	__m256d acc1 = _mm256_setzero_pd();
+	__m256d acc2 = _mm256_setzero_pd();
+	__m256d acc3 = _mm256_setzero_pd();
+	size_t i = 0;
+	for (; (i + 16) <= n; i += 16) {
+		acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), acc0);
+		acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4), acc1);
+		acc2 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 8), _mm256_loadu_pd(y + i + 8), acc2);
+		acc3 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 12), _mm256_loadu_pd(y + i + 12), acc3);
+	}
+	for (; (i + 4) <= n; i += 4) {
+		acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), acc0);
+	}
+	acc0 = _mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3));
+	__m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+	double sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+	for (; i < n; ++i) {
+		sum += x[i] * y[i];
+	}
+	return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static void _axpyAvx2(const double &alpha, const double *x, double *y, const size_t &n)
+{
+	const __m256d a = _mm256_set1_pd(alpha);
+	size_t i = 0;
+	for (; (i + 4) <= n; i += 4) {
+		_mm256_storeu_pd(y + i, _mm256_fmadd_pd(a, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+	}
+	for (; i < n; ++i) {
+		y[i] += alpha * x[i];
+	}
+}
+
+__attribute__((target("avx2,fma")))
+static void _scaleAvx2(const double &alpha, const double *x, double *y, const size_t &n)
+{
+	const __m256d a = _mm256_set1_pd(alpha);
+	size_t i = 0;
+	for (; (i + 4) <= n; i += 4) {
+		_mm256_storeu_pd(y + i, _mm256_mul_pd(a, _mm256_loadu_pd(x + i)));
+	}
+	for (; i < n; ++i) {
+		y[i] = alpha * x[i];
+	}
+}
+
+__attribute__((target("avx2,fma")))
+static float _dotAvx2(const float *x, const float *y, const size_t &n)
+{
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	__m256 acc2 = _mm256_setzero_ps();
+	__m256 acc3 = _mm256_setzero_ps();
+	size_t i = 0;
+	for (; (i + 32) <= n; i += 32) {
+		acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), acc0);
+		acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(y + i + 8), acc1);
+		acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 16), _mm256_loadu_ps(y + i + 16), acc2);
+		acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 24), _mm256_loadu_ps(y + i + 24), acc3);
+	}
+	for (; (i + 8) <= n; i += 8) {
+		acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), acc0);
+	}
+	acc0 = _mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3));
+	__m128 half = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+	half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+	float sum = _mm_cvtss_f32(_mm_add_ss(half, _mm_shuffle_ps(half, half, 1)));
+	for (; i < n; ++i) {
+		sum += x[i] * y[i];
+	}
+	return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static void _axpyAvx2(const float &alpha, const float *x, float *y, const size_t &n)
+{
+	const __m256 a = _mm256_set1_ps(alpha);
+	size_t i = 0;
+	for (; (i + 8) <= n; i += 8) {
+		_mm256_storeu_ps(y + i, _mm256_fmadd_ps(a, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+	}
+	for (; i < n; ++i) {
+		y[i] += alpha * x[i];
+	}
+}
+
+__attribute__((target("avx2,fma")))
+static void _scaleAvx2(const float &alpha, const float *x, float *y, const size_t &n)
+{
+	const __m256 a = _mm256_set1_ps(alpha);
+	size_t i = 0;
+	for (; (i + 8) <= n; i += 8) {
+		_mm256_storeu_ps(y + i, _mm256_mul_ps(a, _mm256_loadu_ps(x + i)));
+	}
+	for (; i < n; ++i) {
+		y[i] = alpha * x[i];
+	}
+}
+
+__attribute__((target("avx2")))
+static int32_t _dotInt8Avx2(const int8_t *x, const int8_t *y, const size_t &n)
+{
+	// Sign extend 16 bytes at a time to 16 bit values, then multiply and add adjacent pairs into 32 bit sums
+	// (two independent accumulators, covering 32 bytes per iteration)
+	__m256i acc0 = _mm256_setzero_si256();
+	__m256i acc1 = _mm256_setzero_si256();
+	size_t i = 0;
+	for (; (i + 32) <= n; i += 32) {
+		const __m256i x0 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)));
+		const __m256i y0 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i)));
+		const __m256i x1 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i + 16)));
+		const __m256i y1 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i + 16)));
+		acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(x0, y0));
+		acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(x1, y1));
+	}
+	for (; (i + 16) <= n; i += 16) {
+		const __m256i x0 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)));
+		const __m256i y0 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i)));
+		acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(x0, y0));
+	}
+	acc0 = _mm256_add_epi32(acc0, acc1);
+	__m128i half = _mm_add_epi32(_mm256_castsi256_si128(acc0), _mm256_extracti128_si256(acc0, 1));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+	int32_t sum = _mm_cvtsi128_si32(half);
+	for (; i < n; ++i) {
+		sum += static_cast<int32_t>(x[i]) * static_cast<int32_t>(y[i]);
+	}
+	return sum;
+}
+
+template <size_t MR>
+__attribute__((target("avx2")))
+static void _gemmInt8TileAvx2(const size_t &k, const int8_t *a, const size_t &lda, const int8_t *b, const size_t &ldb, int32_t *c, const size_t &ldc)
+{
+	// Sign extend 16 bytes of each row to a vector of 16 bit values once, then multiply and add adjacent pairs of
+	// every row of A with every row of B
+	__m256i acc[MR][GEMM_INT8_NR];
+#pragma GCC unroll 4
+	for (size_t i = 0; i < MR; ++i) {
+#pragma GCC unroll 4
+		for (size_t j = 0; j < GEMM_INT8_NR; ++j) {
+			acc[i][j] = _mm256_setzero_si256();
+		}
+	}
+	size_t p = 0;
+	for (; (p + 16) <= k; p += 16) {
+		__m256i va[MR];
+#pragma GCC unroll 4
+		for (size_t i = 0; i < MR; ++i) {
+			va[i] = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + (i * lda) + p)));
+		}
+#pragma GCC unroll 4
+		for (size_t j = 0; j < GEMM_INT8_NR; ++j) {
+			const __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + (j * ldb) + p)));
+#pragma GCC unroll 4
+			for (size_t i = 0; i < MR; ++i) {
+				acc[i][j] = _mm256_add_epi32(acc[i][j], _mm256_madd_epi16(va[i], vb));
+			}
+		}
+	}
+#pragma GCC unroll 4
+	for (size_t i = 0; i < MR; ++i) {
+		// As _reduce4Sse2 within each 128 bit lane, then add the two lanes
+		const __m256i t0 = _mm256_unpacklo_epi32(acc[i][0], acc[i][1]);
+		const __m256i t1 = _mm256_unpackhi_epi32(acc[i][0], acc[i][1]);
+		const __m256i t2 = _mm256_unpacklo_epi32(acc[i][2], acc[i][3]);
+		const __m256i t3 = _mm256_unpackhi_epi32(acc[i][2], acc[i][3]);
+		const __m256i sums = _mm256_add_epi32(_mm256_add_epi32(_mm256_unpacklo_epi64(t0, t2), _mm256_unpackhi_epi64(t0, t2)),
+											  _mm256_add_epi32(_mm256_unpacklo_epi64(t1, t3), _mm256_unpackhi_epi64(t1, t3)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(c + (i * ldc)), _mm_add_epi32(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1)));
+	}
+	_gemmInt8TailScalar<MR>(p, k, a, lda, b, ldb, c, ldc);
+}
+
+__attribute__((target("avx2")))
+static void _gemmInt8Avx2(const size_t &rows, const size_t &k, const int8_t *a, const size_t &lda, const int8_t *b, const size_t &ldb, int32_t *c, const size_t &ldc)
+{
+	if (rows >= 2) {
+		_gemmInt8TileAvx2<2>(k, a, lda, b, ldb, c, ldc);
+	} else {
+		_gemmInt8TileAvx2<1>(k, a, lda, b, ldb, c, ldc);
+	}
+}
+
+__attribute__((target("avx2")))
+static void _quantizeInt8Avx2(const double *x, const double &scale, int8_t *y, const size_t &n)
+{
+	// Clamp, add 0.5 with the sign of the value and truncate (as _quantizeInt8Scalar), then pack 16 values at a time
+	// down to bytes (the values are already in range, so the saturating packs only narrow them)
+	const __m256d vs = _mm256_set1_pd(scale);
+	const __m256d lo = _mm256_set1_pd(-QUANT_INT8_MAX);
+	const __m256d hi = _mm256_set1_pd(QUANT_INT8_MAX);
+	const __m256d half = _mm256_set1_pd(0.5);
+	const __m256d sign = _mm256_set1_pd(-0.0);
+	size_t i = 0;
+	for (; (i + 16) <= n; i += 16) {
+		__m128i q[4];
+		for (size_t h = 0; h < 4; ++h) {
+			const __m256d v = _mm256_min_pd(_mm256_max_pd(_mm256_mul_pd(_mm256_loadu_pd(x + i + (h * 4)), vs), lo), hi);
+			q[h] = _mm256_cvttpd_epi32(_mm256_add_pd(v, _mm256_or_pd(_mm256_and_pd(v, sign), half)));
+		}
+		const __m128i packed = _mm_packs_epi16(_mm_packs_epi32(q[0], q[1]), _mm_packs_epi32(q[2], q[3]));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(y + i), packed);
+	}
+	_quantizeInt8Scalar(x + i, scale, y + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void _quantizeInt8Avx2(const float *x, const float &scale, int8_t *y, const size_t &n)
+{
+	// As for double, 32 values at a time: the packs interleave the 128 bit lanes, which the permute puts back in order
+	const __m256 vs = _mm256_set1_ps(scale);
+	const __m256 lo = _mm256_set1_ps(-QUANT_INT8_MAX);
+	const __m256 hi = _mm256_set1_ps(QUANT_INT8_MAX);
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256 sign = _mm256_set1_ps(-0.0f);
+	const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	size_t i = 0;
+	for (; (i + 32) <= n; i += 32) {
+		__m256i q[4];
+		for (size_t h = 0; h < 4; ++h) {
+			const __m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(x + i + (h * 8)), vs), lo), hi);
+			q[h] = _mm256_cvttps_epi32(_mm256_add_ps(v, _mm256_or_ps(_mm256_and_ps(v, sign), half)));
+		}
+		const __m256i packed = _mm256_packs_epi16(_mm256_packs_epi32(q[0], q[1]), _mm256_packs_epi32(q[2], q[3]));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(y + i), _mm256_permutevar8x32_epi32(packed, order));
+	}
+	_quantizeInt8Scalar(x + i, scale, y + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void _dequantizeInt32Avx2(const int32_t *x, const double &scale, const double *scales, const double *bias, double *y, const size_t &n)
+{
+	// Multiply then add (no FMA), so the results match _dequantizeInt32Scalar exactly
+	const __m256d vs = _mm256_set1_pd(scale);
+	size_t i = 0;
+	for (; (i + 4) <= n; i += 4) {
+		const __m256d v = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)));
+		const __m256d s = _mm256_mul_pd(vs, _mm256_loadu_pd(scales + i));
+		_mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_mul_pd(v, s), _mm256_loadu_pd(bias + i)));
+	}
+	_dequantizeInt32Scalar(x + i, scale, scales + i, bias + i, y + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void _dequantizeInt32Avx2(const int32_t *x, const float &scale, const float *scales, const float *bias, float *y, const size_t &n)
+{
+	const __m256 vs = _mm256_set1_ps(scale);
+	size_t i = 0;
+	for (; (i + 8) <= n; i += 8) {
+		const __m256 v = _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)));
+		const __m256 s = _mm256_mul_ps(vs, _mm256_loadu_ps(scales + i));
+		_mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_mul_ps(v, s), _mm256_loadu_ps(bias + i)));
+	}
+	_dequantizeInt32Scalar(x + i, scale, scales + i, bias + i, y + i, n - i);
+}
+
+__attribute__((target("avx2,fma")))
+static double _dotSparseAvx2(const double *x, const uint32_t *indices, const double *values, const size_t &n)
+{
+	// Gather four elements of x at a time (two independent accumulators)
+	__m256d acc0 = _mm256_setzero_pd();
+	__m256d acc1 = _mm256_setzero_pd();
+	size_t i = 0;
+	for (; (i + 8) <= n; i += 8) {
+		const __m128i idx0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i));
+		const __m128i idx1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i + 4));
+		acc0 = _mm256_fmadd_pd(_mm256_i32gather_pd(x, idx0, 8), _mm256_loadu_pd(values + i), acc0);
+		acc1 = _mm256_fmadd_pd(_mm256_i32gather_pd(x, idx1, 8), _mm256_loadu_pd(values + i + 4), acc1);
+	}
+	acc0 = _mm256_add_pd(acc0, acc1);
+	__m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+	double sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+	for (; i < n; ++i) {
+		sum += x[indices[i]] * values[i];
+	}
+	return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static float _dotSparseAvx2(const float *x, const uint32_t *indices, const float *values, const size_t &n)
+{
+	// Gather eight elements of x at a time (two independent accumulators)
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	size_t i = 0;
+	for (; (i + 16) <= n; i += 16) {
+		const __m256i idx0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+		const __m256i idx1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i + 8));
+		acc0 = _mm256_fmadd_ps(_mm256_i32gather_ps(x, idx0, 4), _mm256_loadu_ps(values + i), acc0);
+		acc1 = _mm256_fmadd_ps(_mm256_i32gather_ps(x, idx1, 4), _mm256_loadu_ps(values + i + 8), acc1);
+	}
+	acc0 = _mm256_add_ps(acc0, acc1);
+	__m128 half = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+	half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+	float sum = _mm_cvtss_f32(_mm_add_ss(half, _mm_shuffle_ps(half, half, 1)));
+	for (; i < n; ++i) {
+		sum += x[indices[i]] * values[i];
+	}
+	return sum;
+}
+
+__attribute__((target("avx2")))
+static void _philoxAvx2(const uint32_t counter[4], const uint32_t key[2], const size_t &numBlocks, uint32_t *output)
+{
+	// Eight blocks at a time, one per 32 bit lane. The multiplies (32 x 32 -> 64 bit) take the even lanes, so the
+	// odd lanes are shifted down and multiplied separately, then the high and low halves blended back into lanes
+	const __m256i m0 = _mm256_set1_epi64x(PHILOX_M0);
+	const __m256i m1 = _mm256_set1_epi64x(PHILOX_M1);
+	const __m256i step = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	alignas(32) uint32_t words[4][8];
+	size_t b = 0;
+	for (; (b + 8) <= numBlocks; b += 8) {
+		__m256i c0 = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(counter[0] + static_cast<uint32_t>(b))), step);
+		__m256i c1 = _mm256_set1_epi32(static_cast<int>(counter[1]));
+		__m256i c2 = _mm256_set1_epi32(static_cast<int>(counter[2]));
+		__m256i c3 = _mm256_set1_epi32(static_cast<int>(counter[3]));
+		uint32_t k0 = key[0];
+		uint32_t k1 = key[1];
+		for (size_t round = 0; round < PHILOX_ROUNDS; ++round) {
+			const __m256i even0 = _mm256_mul_epu32(c0, m0);
+			const __m256i odd0 = _mm256_mul_epu32(_mm256_srli_epi64(c0, 32), m0);
+			const __m256i even1 = _mm256_mul_epu32(c2, m1);
+			const __m256i odd1 = _mm256_mul_epu32(_mm256_srli_epi64(c2, 32), m1);
+			const __m256i hi0 = _mm256_blend_epi32(_mm256_srli_epi64(even0, 32), odd0, 0xAA);
+			const __m256i lo0 = _mm256_blend_epi32(even0, _mm256_slli_epi64(odd0, 32), 0xAA);
+			const __m256i hi1 = _mm256_blend_epi32(_mm256_srli_epi64(even1, 32), odd1, 0xAA);
+			const __m256i lo1 = _mm256_blend_epi32(even1, _mm256_slli_epi64(odd1, 32), 0xAA);
+			c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32(static_cast<int>(k0)));
+			c1 = lo1;
+			c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32(static_cast<int>(k1)));
+			c3 = lo0;
+			k0 += PHILOX_W0;
+			k1 += PHILOX_W1;
+		}
+		_mm256_store_si256(reinterpret_cast<__m256i*>(words[0]), c0);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(words[1]), c1);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(words[2]), c2);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(words[3]), c3);
+		for (size_t lane = 0; lane < 8; ++lane) {
+			for (size_t w = 0; w < 4; ++w) {
+				output[((b + lane) * 4) + w] = words[w][lane];
+			}
+		}
+	}
+	if (b < numBlocks) {
+		const uint32_t tail[4] = { counter[0] + static_cast<uint32_t>(b), counter[1], counter[2], counter[3] };
+		_philoxScalar(tail, key, numBlocks - b, output + (b * 4));
+	}
+}
+
+__attribute__((target("avx2,fma")))
+static void _gemmAvx2(const size_t &k, const double &alpha, const double *a, const double *b, const double &beta, double *c, const size_t &ldc)
+{
+	// 6 x 8 tile: each step loads two vectors of B and broadcasts 6 values of A (the row loop is unrolled, so the
+	// accumulators stay in registers whatever the optimisation level)
+	__m256d acc[GEMM_MR_AVX2][2];
+	for (size_t i = 0; i < GEMM_MR_AVX2; ++i) {
+		acc[i][0] = _mm256_setzero_pd();
+		acc[i][1] = _mm256_setzero_pd();
+	}
+	for (size_t p = 0; p < k; ++p) {
+		const __m256d b0 = _mm256_loadu_pd(b + (p * 8));
+		const __m256d b1 = _mm256_loadu_pd(b + (p * 8) + 4);
+#pragma GCC unroll 12
+		for (size_t i = 0; i < GEMM_MR_AVX2; ++i) {
+			const __m256d ai = _mm256_set1_pd(a[(p * GEMM_MR_AVX2) + i]);
+			acc[i][0] = _mm256_fmadd_pd(ai, b0, acc[i][0]);
+			acc[i][1] = _mm256_fmadd_pd(ai, b1, acc[i][1]);
+		}
+	}
+	const __m256d va = _mm256_set1_pd(alpha);
+	const __m256d vb = _mm256_set1_pd(beta);
+	for (size_t i = 0; i < GEMM_MR_AVX2; ++i) {
+		double *cRow = c + (i * ldc);
+		for (size_t h = 0; h < 2; ++h) {
+			const __m256d result = _mm256_mul_pd(va, acc[i][h]);
+			_mm256_storeu_pd(cRow + (h * 4), (beta == 0.0) ? result : _mm256_fmadd_pd(vb, _mm256_loadu_pd(cRow + (h * 4)), result));
+		}
+	}
+}
+
+__attribute__((target("avx2,fma")))
+static void _gemmAvx2(const size_t &k, const float &alpha, const float *a, const float *b, const float &beta, float *c, const size_t &ldc)
+{
+	// 6 x 16 tile: each step loads two vectors of B and broadcasts 6 values of A (the row loop is unrolled, so the
+	// accumulators stay in registers whatever the optimisation level)
+	__m256 acc[GEMM_MR_AVX2][2];
+	for (size_t i = 0; i < GEMM_MR_AVX2; ++i) {
+		acc[i][0] = _mm256_setzero_ps();
+		acc[i][1] = _mm256_setzero_ps();
+	}
+	for (size_t p = 0; p < k; ++p) {
+		const __m256 b0 = _mm256_loadu_ps(b + (p * 16));
+		const __m256 b1 = _mm256_loadu_ps(b + (p * 16) + 8);
+#pragma GCC unroll 12
+		for (size_t i = 0; i < GEMM_MR_AVX2; ++i) {
+			const __m256 ai = _mm256_set1_ps(a[(p * GEMM_MR_AVX2) + i]);
+			acc[i][0] = _mm256_fmadd_ps(ai, b0, acc[i][0]);
+			acc[i][1] = _mm256_fmadd_ps(ai, b1, acc[i][1]);
+		}
+	}
+	const __m256 va = _mm256_set1_ps(alpha);
+	const __m256 vb = _mm256_set1_ps(beta);
+	for (size_t i = 0; i < GEMM_MR_AVX2; ++i) {
+		float *cRow = c + (i * ldc);
+		for (size_t h = 0; h < 2; ++h) {
+			const __m256 result = _mm256_mul_ps(va, acc[i][h]);
+			_mm256_storeu_ps(cRow + (h * 8), (beta == 0.0) ? result : _mm256_fmadd_ps(vb, _mm256_loadu_ps(cRow + (h * 8)), result));
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// AVX-512 kernels (tails handled with masked loads/stores)
+///////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("avx512f")))
+static double _dotAvx512(const double *x, const double *y, const size_t &n)
+{
+	__m512d acc0 = _mm512_setzero_pd();
+	__m512d acc1 = _mm512_setzero_pd();
+	size_t i = 0;
+	for (; (i + 16) <= n; i += 16) {
+		acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), acc0);
+		acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8), acc1);
+	}
+	for (; (i + 8) <= n; i += 8) {
+		acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), acc0);
+	}
+	if (i < n) {
+		const __mmask8 mask = static_cast<__mmask8>((1u << (n - i)) - 1u);
+		acc1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i), acc1);
+	}
+	return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+}
+
+__attribute__((target("avx512f")))
+static void _axpyAvx512(const double &alpha, const double *x, double *y, const size_t &n)
+{
+	const __m512d a = _mm512_set1_pd(alpha);
+	size_t i = 0;
+	for (; (i + 8) <= n; i += 8) {
+		_mm512_storeu_pd(y + i, _mm512_fmadd_pd(a, _mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+	}
+	if (i < n) {
+		const __mmask8 mask = static_cast<__mmask8>((1u << (n - i)) - 1u);
+		_mm512_mask_storeu_pd(y + i, mask, _mm512_fmadd_pd(a, _mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i)));
+	}
+}
+
+__attribute__((target("avx512f")))
+static void _scaleAvx512(const double &alpha, const double *x, double *y, const size_t &n)
+{
+	const __m512d a = _mm512_set1_pd(alpha);
+	size_t i = 0;
+	for (; (i + 8) <= n; i += 8) {
+		_mm512_storeu_pd(y + i, _mm512_mul_pd(a, _mm512_loadu_pd(x + i)));
+	}
+	if (i < n) {
+		const __mmask8 mask = static_cast<__mmask8>((1u << (n - i)) - 1u);
+		_mm512_mask_storeu_pd(y + i, mask, _mm512_mul_pd(a, _mm512_maskz_loadu_pd(mask, x + i)));
+	}
+}
+
+__attribute__((target("avx512f")))
+static float _dotAvx512(const float *x, const float *y, const size_t &n)
+{
+	__m512 acc0 = _mm512_setzero_ps();
+	__m512 acc1 = _mm512_setzero_ps();
+	size_t i = 0;
+	for (; (i + 32) <= n; i += 32) {
+		acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), acc0);
+		acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 16), _mm512_loadu_ps(y + i + 16), acc1);
+	}
+	for (; (i + 16) <= n; i += 16) {
+		acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), acc0);
+	}
+	if (i < n) {
+		const __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1u);
+		acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, x + i), _mm512_maskz_loadu_ps(mask, y + i), acc1);
+	}
+	return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+__attribute__((target("avx512f")))
+static void _axpyAvx512(const float &alpha, const float *x, float *y, const size_t &n)
+{
+	const __m512 a = _mm512_set1_ps(alpha);
+	size_t i = 0;
+	for (; (i + 16) <= n; i += 16) {
+		_mm512_storeu_ps(y + i, _mm512_fmadd_ps(a, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+	}
+	if (i < n) {
+		const __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1u);
+		_mm512_mask_storeu_ps(y + i, mask, _mm512_fmadd_ps(a, _mm512_maskz_loadu_ps(mask, x + i), _mm512_maskz_loadu_ps(mask, y + i)));
+	}
+}
+
+__attribute__((target("avx512f")))
+static void _scaleAvx512(const float &alpha, const float *x, float *y, const size_t &n)
+{
+	const __m512 a = _mm512_set1_ps(alpha);
+	size_t i = 0;
+	for (; (i + 16) <= n; i += 16) {
+		_mm512_storeu_ps(y + i, _mm512_mul_ps(a, _mm512_loadu_ps(x + i)));
+	}
+	if (i < n) {
+		const __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1u);
+		_mm512_mask_storeu_ps(y + i, mask, _mm512_mul_ps(a, _mm512_maskz_loadu_ps(mask, x + i)));
+	}
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static int32_t _dotInt8Avx512(const int8_t *x, const int8_t *y, const size_t &n)
+{
+	// Multiply |x| (unsigned) by y with the sign of x (signed) and add adjacent pairs into 16 bits, which cannot
+	// saturate for values in [-127, 127], then add adjacent pairs again into 32 bit sums. The tail is zero-masked
+	const __m512i ones = _mm512_set1_epi16(1);
+	const __m512i zero = _mm512_setzero_si512();
+	__m512i acc0 = _mm512_setzero_si512();
+	__m512i acc1 = _mm512_setzero_si512();
+	size_t i = 0;
+	for (; (i + 128) <= n; i += 128) {
+		const __m512i x0 = _mm512_loadu_si512(x + i);
+		const __m512i x1 = _mm512_loadu_si512(x + i + 64);
+		const __m512i y0 = _mm512_mask_sub_epi8(_mm512_loadu_si512(y + i), _mm512_movepi8_mask(x0), zero, _mm512_loadu_si512(y + i));
+		const __m512i y1 = _mm512_mask_sub_epi8(_mm512_loadu_si512(y + i + 64), _mm512_movepi8_mask(x1), zero, _mm512_loadu_si512(y + i + 64));
+		acc0 = _mm512_add_epi32(acc0, _mm512_madd_epi16(_mm512_maddubs_epi16(_mm512_abs_epi8(x0), y0), ones));
+		acc1 = _mm512_add_epi32(acc1, _mm512_madd_epi16(_mm512_maddubs_epi16(_mm512_abs_epi8(x1), y1), ones));
+	}
+	for (; i < n; i += 64) {
+		const __mmask64 mask = ((n - i) >= 64) ? ~static_cast<__mmask64>(0) : ((static_cast<__mmask64>(1) << (n - i)) - 1);
+		const __m512i x0 = _mm512_maskz_loadu_epi8(mask, x + i);
+		const __m512i y0 = _mm512_maskz_loadu_epi8(mask, y + i);
+		const __m512i s0 = _mm512_mask_sub_epi8(y0, _mm512_movepi8_mask(x0), zero, y0);
+		acc0 = _mm512_add_epi32(acc0, _mm512_madd_epi16(_mm512_maddubs_epi16(_mm512_abs_epi8(x0), s0), ones));
+	}
+	return _mm512_reduce_add_epi32(_mm512_add_epi32(acc0, acc1));
+}
+
+__attribute__((target("avx512f")))
+static inline __m128i _reduce4Avx512(const __m512i x0, const __m512i x1, const __m512i x2, const __m512i x3)
+{
+	// As _reduce4Sse2 within each 128 bit lane, then add the four lanes
+	const __m512i t0 = _mm512_unpacklo_epi32(x0, x1);
+	const __m512i t1 = _mm512_unpackhi_epi32(x0, x1);
+	const __m512i t2 = _mm512_unpacklo_epi32(x2, x3);
+	const __m512i t3 = _mm512_unpackhi_epi32(x2, x3);
+	const __m512i sums = _mm512_add_epi32(_mm512_add_epi32(_mm512_unpacklo_epi64(t0, t2), _mm512_unpackhi_epi64(t0, t2)),
+										  _mm512_add_epi32(_mm512_unpacklo_epi64(t1, t3), _mm512_unpackhi_epi64(t1, t3)));
+	const __m256i half = _mm256_add_epi32(_mm512_castsi512_si256(sums), _mm512_extracti64x4_epi64(sums, 1));
+	return _mm_add_epi32(_mm256_castsi256_si128(half), _mm256_extracti128_si256(half, 1));
+}
+
+template <size_t MR>
+__attribute__((target("avx512f,avx512bw")))
+static void _gemmInt8TileAvx512(const size_t &k, const int8_t *a, const size_t &lda, const int8_t *b, const size_t &ldb, int32_t *c, const size_t &ldc)
+{
+	// As _gemmInt8TileAvx2, 32 bytes at a time into zmm; the tail is zero-masked
+	__m512i acc[MR][GEMM_INT8_NR];
+#pragma GCC unroll 4
+	for (size_t i = 0; i < MR; ++i) {
+#pragma GCC unroll 4
+		for (size_t j = 0; j < GEMM_INT8_NR; ++j) {
+			acc[i][j] = _mm512_setzero_si512();
+		}
+	}
+	for (size_t p = 0; p < k; p += 32) {
+		const __mmask64 mask = ((k - p) >= 32) ? static_cast<__mmask64>(0xffffffffu) : ((static_cast<__mmask64>(1) << (k - p)) - 1);
+		__m512i va[MR];
+#pragma GCC unroll 4
+		for (size_t i = 0; i < MR; ++i) {
+			va[i] = _mm512_cvtepi8_epi16(_mm512_castsi512_si256(_mm512_maskz_loadu_epi8(mask, a + (i * lda) + p)));
+		}
+#pragma GCC unroll 4
+		for (size_t j = 0; j < GEMM_INT8_NR; ++j) {
+			const __m512i vb = _mm512_cvtepi8_epi16(_mm512_castsi512_si256(_mm512_maskz_loadu_epi8(mask, b + (j * ldb) + p)));
+#pragma GCC unroll 4
+			for (size_t i = 0; i < MR; ++i) {
+				acc[i][j] = _mm512_add_epi32(acc[i][j], _mm512_madd_epi16(va[i], vb));
+			}
+		}
+	}
+#pragma GCC unroll 4
+	for (size_t i = 0; i < MR; ++i) {
+		const __m128i sums = _reduce4Avx512(acc[i][0], acc[i][1], acc[i][2], acc[i][3]);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(c + (i * ldc)), sums);
+	}
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void _gemmInt8Avx512(const size_t &rows, const size_t &k, const int8_t *a, const size_t &lda, const int8_t *b, const size_t &ldb, int32_t *c, const size_t &ldc)
+{
+	switch (rows) {
+	case 1:
+		_gemmInt8TileAvx512<1>(k, a, lda, b, ldb, c, ldc);
+		break;
+	case 2:
+		_gemmInt8TileAvx512<2>(k, a, lda, b, ldb, c, ldc);
+		break;
+	case 3:
+		_gemmInt8TileAvx512<3>(k, a, lda, b, ldb, c, ldc);
+		break;
+	default:
+		_gemmInt8TileAvx512<4>(k, a, lda, b, ldb, c, ldc);
+		break;
+	}
+}
+
+template <size_t MR>
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+static void _gemmInt8TileVnni(const size_t &k, const int8_t *a, const size_t &lda, const int8_t *b, const size_t &ldb, int32_t *c, const size_t &ldc)
+{
+	// VPDPBUSD multiplies unsigned bytes by signed bytes and adds each group of four products into 32 bits, 64 bytes
+	// at a time. Flipping the sign bit of A gives a + 128 (unsigned), so the sums are A * B + 128 * sum(B), and the
+	// sums of B (taken the same way, against ones) are subtracted at the end. The arithmetic wraps, so the result
+	// is exact whenever the true sums fit in 32 bits. The tail is zero-masked (a masked byte of A becomes 128, but
+	// the matching byte of B is 0)
+	const __m512i flip = _mm512_set1_epi8(-128);
+	const __m512i ones = _mm512_set1_epi8(1);
+	__m512i acc[MR][GEMM_INT8_NR];
+	__m512i sumB[GEMM_INT8_NR];
+#pragma GCC unroll 4
+	for (size_t j = 0; j < GEMM_INT8_NR; ++j) {
+		sumB[j] = _mm512_setzero_si512();
+#pragma GCC unroll 4
+		for (size_t i = 0; i < MR; ++i) {
+			acc[i][j] = _mm512_setzero_si512();
+		}
+	}
+	for (size_t p = 0; p < k; p += 64) {
+		const __mmask64 mask = ((k - p) >= 64) ? ~static_cast<__mmask64>(0) : ((static_cast<__mmask64>(1) << (k - p)) - 1);
+		__m512i va[MR];
+#pragma GCC unroll 4
+		for (size_t i = 0; i < MR; ++i) {
+			va[i] = _mm512_xor_si512(_mm512_maskz_loadu_epi8(mask, a + (i * lda) + p), flip);
+		}
+#pragma GCC unroll 4
+		for (size_t j = 0; j < GEMM_INT8_NR; ++j) {
+			const __m512i vb = _mm512_maskz_loadu_epi8(mask, b + (j * ldb) + p);
+			sumB[j] = _mm512_dpbusd_epi32(sumB[j], ones, vb);
+#pragma GCC unroll 4
+			for (size_t i = 0; i < MR; ++i) {
+				acc[i][j] = _mm512_dpbusd_epi32(acc[i][j], va[i], vb);
+			}
+		}
+	}
+	const __m128i offset = _mm_slli_epi32(_reduce4Avx512(sumB[0], sumB[1], sumB[2], sumB[3]), 7);
+#pragma GCC unroll 4
+	for (size_t i = 0; i < MR; ++i) {
+		const __m128i sums = _reduce4Avx512(acc[i][0], acc[i][1], acc[i][2], acc[i][3]);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(c + (i * ldc)), _mm_sub_epi32(sums, offset));
+	}
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+static void _gemmInt8Vnni(const size_t &rows, const size_t &k, const int8_t *a, const size_t &lda, const int8_t *b, const size_t &ldb, int32_t *c, const size_t &ldc)
+{
+	switch (rows) {
+	case 1:
+		_gemmInt8TileVnni<1>(k, a, lda, b, ldb, c, ldc);
+		break;
+	case 2:
+		_gemmInt8TileVnni<2>(k, a, lda, b, ldb, c, ldc);
+		break;
+	case 3:
+		_gemmInt8TileVnni<3>(k, a, lda, b, ldb, c, ldc);
+		break;
+	default:
+		_gemmInt8TileVnni<4>(k, a, lda, b, ldb, c, ldc);
+		break;
+	}
+}
+
+__attribute__((target("avx512f")))
+static double _dotSparseAvx512(const double *x, const uint32_t *indices, const double *values, const size_t &n)
+{
+	// Gather eight elements of x at a time (two independent accumulators), with a masked gather for the tail
+	__m512d acc0 = _mm512_setzero_pd();
+	__m512d acc1 = _mm512_setzero_pd();
+	size_t i = 0;
+	for (; (i + 16) <= n; i += 16) {
+		const __m256i idx0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+		const __m256i idx1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i + 8));
+		acc0 = _mm512_fmadd_pd(_mm512_i32gather_pd(idx0, x, 8), _mm512_loadu_pd(values + i), acc0);
+		acc1 = _mm512_fmadd_pd(_mm512_i32gather_pd(idx1, x, 8), _mm512_loadu_pd(values + i + 8), acc1);
+	}
+	for (; (i + 8) <= n; i += 8) {
+		const __m256i idx0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+		acc0 = _mm512_fmadd_pd(_mm512_i32gather_pd(idx0, x, 8), _mm512_loadu_pd(values + i), acc0);
+	}
+	if (i < n) {
+		const __mmask8 mask = static_cast<__mmask8>((1u << (n - i)) - 1u);
+		const __m256i idx1 = _mm512_castsi512_si256(_mm512_maskz_loadu_epi32(mask, indices + i));
+		const __m512d x1 = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), mask, idx1, x, 8);
+		acc1 = _mm512_fmadd_pd(x1, _mm512_maskz_loadu_pd(mask, values + i), acc1);
+	}
+	return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+}
+
+__attribute__((target("avx512f")))
+static float _dotSparseAvx512(const float *x, const uint32_t *indices, const float *values, const size_t &n)
+{
+	// Gather sixteen elements of x at a time (two independent accumulators), with a masked gather for the tail
+	__m512 acc0 = _mm512_setzero_ps();
+	__m512 acc1 = _mm512_setzero_ps();
+	size_t i = 0;
+	for (; (i + 32) <= n; i += 32) {
+		const __m512i idx0 = _mm512_loadu_si512(indices + i);
+		const __m512i idx1 = _mm512_loadu_si512(indices + i + 16);
+		acc0 = _mm512_fmadd_ps(_mm512_i32gather_ps(idx0, x, 4), _mm512_loadu_ps(values + i), acc0);
+		acc1 = _mm512_fmadd_ps(_mm512_i32gather_ps(idx1, x, 4), _mm512_loadu_ps(values + i + 16), acc1);
+	}
+	for (; (i + 16) <= n; i += 16) {
+		const __m512i idx0 = _mm512_loadu_si512(indices + i);
+		acc0 = _mm512_fmadd_ps(_mm512_i32gather_ps(idx0, x, 4), _mm512_loadu_ps(values + i), acc0);
+	}
+	if (i < n) {
+		const __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1u);
+		const __m512i idx1 = _mm512_maskz_loadu_epi32(mask, indices + i);
+		const __m512 x1 = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), mask, idx1, x, 4);
+		acc1 = _mm512_fmadd_ps(x1, _mm512_maskz_loadu_ps(mask, values + i), acc1);
+	}
+	return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+__attribute__((target("avx512f")))
+static void _philoxAvx512(const uint32_t counter[4], const uint32_t key[2], const size_t &numBlocks, uint32_t *output)
+{
+	// Sixteen blocks at a time, as in the AVX2 kernel
+	const __m512i m0 = _mm512_set1_epi64(PHILOX_M0);
+	const __m512i m1 = _mm512_set1_epi64(PHILOX_M1);
+	const __m512i step = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+	const __mmask16 odd = 0xAAAA;
+	alignas(64) uint32_t words[4][16];
+	size_t b = 0;
+	for (; (b + 16) <= numBlocks; b += 16) {
+		__m512i c0 = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(counter[0] + static_cast<uint32_t>(b))), step);
+		__m512i c1 = _mm512_set1_epi32(static_cast<int>(counter[1]));
+		__m512i c2 = _mm512_set1_epi32(static_cast<int>(counter[2]));
+		__m512i c3 = _mm512_set1_epi32(static_cast<int>(counter[3]));
+		uint32_t k0 = key[0];
+		uint32_t k1 = key[1];
+		for (size_t round = 0; round < PHILOX_ROUNDS; ++round) {
+			const __m512i even0 = _mm512_mul_epu32(c0, m0);
+			const __m512i odd0 = _mm512_mul_epu32(_mm512_srli_epi64(c0, 32), m0);
+			const __m512i even1 = _mm512_mul_epu32(c2, m1);
+			const __m512i odd1 = _mm512_mul_epu32(_mm512_srli_epi64(c2, 32), m1);
+			const __m512i hi0 = _mm512_mask_blend_epi32(odd, _mm512_srli_epi64(even0, 32), odd0);
+			const __m512i lo0 = _mm512_mask_blend_epi32(odd, even0, _mm512_slli_epi64(odd0, 32));
+			const __m512i hi1 = _mm512_mask_blend_epi32(odd, _mm512_srli_epi64(even1, 32), odd1);
+			const __m512i lo1 = _mm512_mask_blend_epi32(odd, even1, _mm512_slli_epi64(odd1, 32));
+			c0 = _mm512_xor_si512(_mm512_xor_si512(hi1, c1), _mm512_set1_epi32(static_cast<int>(k0)));
+			c1 = lo1;
+			c2 = _mm512_xor_si512(_mm512_xor_si512(hi0, c3), _mm512_set1_epi32(static_cast<int>(k1)));
+			c3 = lo0;
+			k0 += PHILOX_W0;
+			k1 += PHILOX_W1;
+		}
+		_mm512_store_si512(words[0], c0);
+		_mm512_store_si512(words[1], c1);
+		_mm512_store_si512(words[2], c2);
+		_mm512_store_si512(words[3], c3);
+		for (size_t lane = 0; lane < 16; ++lane) {
+			for (size_t w = 0; w < 4; ++w) {
+				output[((b + lane) * 4) + w] = words[w][lane];
+			}
+		}
+	}
+	if (b < numBlocks) {
+		const uint32_t tail[4] = { counter[0] + static_cast<uint32_t>(b), counter[1], counter[2], counter[3] };
+		_philoxAvx2(tail, key, numBlocks - b, output + (b * 4));
+	}
+}
+
+__attribute__((target("avx512f")))
+static void _gemmAvx512(const size_t &k, const double &alpha, const double *a, const double *b, const double &beta, double *c, const size_t &ldc)
+{
+	// 12 x 16 tile: each step loads two vectors of B and broadcasts 12 values of A (the row loop is unrolled, so the
+	// accumulators stay in registers whatever the optimisation level)
+	__m512d acc[GEMM_MR_AVX512][2];
+	for (size_t i = 0; i < GEMM_MR_AVX512; ++i) {
+		acc[i][0] = _mm512_setzero_pd();
+		acc[i][1] = _mm512_setzero_pd();
+	}
+	for (size_t p = 0; p < k; ++p) {
+		const __m512d b0 = _mm512_loadu_pd(b + (p * 16));
+		const __m512d b1 = _mm512_loadu_pd(b + (p * 16) + 8);
+#pragma GCC unroll 12
+		for (size_t i = 0; i < GEMM_MR_AVX512; ++i) {
+			const __m512d ai = _mm512_set1_pd(a[(p * GEMM_MR_AVX512) + i]);
+			acc[i][0] = _mm512_fmadd_pd(ai, b0, acc[i][0]);
+			acc[i][1] = _mm512_fmadd_pd(ai, b1, acc[i][1]);
+		}
+	}
+	const __m512d va = _mm512_set1_pd(alpha);
+	const __m512d vb = _mm512_set1_pd(beta);
+	for (size_t i = 0; i < GEMM_MR_AVX512; ++i) {
+		double *cRow = c + (i * ldc);
+		for (size_t h = 0; h < 2; ++h) {
+			const __m512d result = _mm512_mul_pd(va, acc[i][h]);
+			_mm512_storeu_pd(cRow + (h * 8), (beta == 0.0) ? result : _mm512_fmadd_pd(vb, _mm512_loadu_pd(cRow + (h * 8)), result));
+		}
+	}
+}
+
+__attribute__((target("avx512f")))
+static void _gemmAvx512(const size_t &k, const float &alpha, const float *a, const float *b, const float &beta, float *c, const size_t &ldc)
+{
+	// 12 x 32 tile: each step loads two vectors of B and broadcasts 12 values of A (the row loop is unrolled, so the
+	// accumulators stay in registers whatever the optimisation level)
+	__m512 acc[GEMM_MR_AVX512][2];
+	for (size_t i = 0; i < GEMM_MR_AVX512; ++i) {
+		acc[i][0] = _mm512_setzero_ps();
+		acc[i][1] = _mm512_setzero_ps();
+	}
+	for (size_t p = 0; p < k; ++p) {
+		const __m512 b0 = _mm512_loadu_ps(b + (p * 32));
+		const __m512 b1 = _mm512_loadu_ps(b + (p * 32) + 16);
+#pragma GCC unroll 12
+		for (size_t i = 0; i < GEMM_MR_AVX512; ++i) {
+			const __m512 ai = _mm512_set1_ps(a[(p * GEMM_MR_AVX512) + i]);
+			acc[i][0] = _mm512_fmadd_ps(ai, b0, acc[i][0]);
+			acc[i][1] = _mm512_fmadd_ps(ai, b1, acc[i][1]);
+		}
+	}
+	const __m512 va = _mm512_set1_ps(alpha);
+	const __m512 vb = _mm512_set1_ps(beta);
+	for (size_t i = 0; i < GEMM_MR_AVX512; ++i) {
+		float *cRow = c + (i * ldc);
+		for (size_t h = 0; h < 2; ++h) {
+			const __m512 result = _mm512_mul_ps(va, acc[i][h]);
+			_mm512_storeu_ps(cRow + (h * 16), (beta == 0.0) ? result : _mm512_fmadd_ps(vb, _mm512_loadu_ps(cRow + (h * 16)), result));
+		}
+	}
+}
+
+__attribute__((target("avx2,fma")))
+static void _sigmoidAvx2(const double *x, double *y, const size_t &n)
+{
+	const __m256d one = _mm256_set1_pd(1.0);
+	const __m256d clampLo = _mm256_set1_pd(-EXP_CLAMP_D);
+	const __m256d clampHi = _mm256_set1_pd(EXP_CLAMP_D);
+	const __m256d log2e = _mm256_set1_pd(EXP_LOG2E);
+	const __m256d ln2Hi = _mm256_set1_pd(EXP_LN2_HI);
+	const __m256d ln2Lo = _mm256_set1_pd(EXP_LN2_LO);
+	// Adding 1.5 * 2^52 leaves the (rounded) integer value in the low mantissa bits
+	const __m256d magic = _mm256_set1_pd(6755399441055744.0);
+	const __m256i bias = _mm256_set1_epi64x(1023);
+	size_t i = 0;
+	for (; (i + 4) <= n; i += 4) {
+		__m256d t = _mm256_sub_pd(_mm256_setzero_pd(), _mm256_loadu_pd(x + i));
+		t = _mm256_min_pd(_mm256_max_pd(t, clampLo), clampHi);
+		const __m256d k = _mm256_round_pd(_mm256_mul_pd(t, log2e), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+		const __m256d f = _mm256_fnmadd_pd(k, ln2Lo, _mm256_fnmadd_pd(k, ln2Hi, t));
+		__m256d p = _mm256_set1_pd(EXP_COEFFS_D[0]);
+		for (size_t c = 1; c <= EXP_DEGREE_D; ++c) {
+			p = _mm256_fmadd_pd(p, f, _mm256_set1_pd(EXP_COEFFS_D[c]));
+		}
+		const __m256i ki = _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(k, magic)), _mm256_castpd_si256(magic));
+		const __m256d scale = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(ki, bias), 52));
+		_mm256_storeu_pd(y + i, _mm256_div_pd(one, _mm256_fmadd_pd(p, scale, one)));
+	}
+	for (; i < n; ++i) {
+		y[i] = _sigmoidApproxScalar(x[i]);
+	}
+}
+
+__attribute__((target("avx2,fma")))
+static void _sigmoidAvx2(const float *x, float *y, const size_t &n)
+{
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 clampLo = _mm256_set1_ps(-EXP_CLAMP_F);
+	const __m256 clampHi = _mm256_set1_ps(EXP_CLAMP_F);
+	const __m256 log2e = _mm256_set1_ps(static_cast<float>(EXP_LOG2E));
+	const __m256 ln2Hi = _mm256_set1_ps(static_cast<float>(EXP_LN2_HI));
+	const __m256 ln2Lo = _mm256_set1_ps(static_cast<float>(EXP_LN2_LO));
+	const __m256i bias = _mm256_set1_epi32(127);
+	size_t i = 0;
+	for (; (i + 8) <= n; i += 8) {
+		__m256 t = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(x + i));
+		t = _mm256_min_ps(_mm256_max_ps(t, clampLo), clampHi);
+		const __m256 k = _mm256_round_ps(_mm256_mul_ps(t, log2e), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+		const __m256 f = _mm256_fnmadd_ps(k, ln2Lo, _mm256_fnmadd_ps(k, ln2Hi, t));
+		__m256 p = _mm256_set1_ps(EXP_COEFFS_F[0]);
+		for (size_t c = 1; c <= EXP_DEGREE_F; ++c) {
+			p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(EXP_COEFFS_F[c]));
+		}
+		const __m256 scale = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(k), bias), 23));
+		_mm256_storeu_ps(y + i, _mm256_div_ps(one, _mm256_fmadd_ps(p, scale, one)));
+	}
+	for (; i < n; ++i) {
+		y[i] = _sigmoidApproxScalar(x[i]);
+	}
+}
+
+#endif // KERNELS_X86_
+
+///////////////////////////////////////////////////////////////////////////////
+// Dispatch
+///////////////////////////////////////////////////////////////////////////////
+
+static s_KernelTable _selectKernels(const e_SimdLevel &level)
+{
+	s_KernelTable table = {
+		SIMD_SCALAR,
+		_dotScalar<double>, _axpyScalar<double>, _scaleScalar<double>,
+		_dotScalar<float>, _axpyScalar<float>, _scaleScalar<float>,
+		_sigmoidScalar<double>, _sigmoidScalar<float>,
+		_dotInt8Scalar,
+		_gemmInt8Scalar, GEMM_INT8_MR,
+		_quantizeInt8Scalar<double>, _quantizeInt8Scalar<float>,
+		_dequantizeInt32Scalar<double>, _dequantizeInt32Scalar<float>,
+		_dotSparseScalar<double>, _dotSparseScalar<float>,
+		_philoxScalar,
+		_gemmScalar<double>, _gemmScalar<float>, GEMM_MR_SCALAR, GEMM_NR_SCALAR, GEMM_NR_SCALAR
+	};
+#ifdef KERNELS_X86_
+	switch (level) {
+	case SIMD_AVX512:
+		table.level = SIMD_AVX512;
+		table.dotD = _dotAvx512;
+		table.axpyD = _axpyAvx512;
+		table.scaleD = _scaleAvx512;
+		table.dotF = _dotAvx512;
+		table.axpyF = _axpyAvx512;
+		table.scaleF = _scaleAvx512;
+		table.sigmoidD = _sigmoidAvx2;
+		table.sigmoidF = _sigmoidAvx2;
+		table.dotI8 = __builtin_cpu_supports("avx512bw") ? _dotInt8Avx512 : _dotInt8Avx2;
+		// VNNI multiplies and adds bytes in one instruction; without it the AVX-512BW kernel widens them to 16 bits
+		if (__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512bw")) {
+			table.gemmI8 = _gemmInt8Vnni;
+			table.gemmI8Rows = GEMM_INT8_MR_AVX512;
+		} else if (__builtin_cpu_supports("avx512bw")) {
+			table.gemmI8 = _gemmInt8Avx512;
+			table.gemmI8Rows = GEMM_INT8_MR_AVX512;
+		} else {
+			table.gemmI8 = _gemmInt8Avx2;
+		}
+		table.quantizeD = _quantizeInt8Avx2;
+		table.quantizeF = _quantizeInt8Avx2;
+		table.dequantizeD = _dequantizeInt32Avx2;
+		table.dequantizeF = _dequantizeInt32Avx2;
+		table.dotSparseD = _dotSparseAvx512;
+		table.dotSparseF = _dotSparseAvx512;
+		table.philox = _philoxAvx512;
+		table.gemmD = _gemmAvx512;
+		table.gemmF = _gemmAvx512;
+		table.gemmRows = GEMM_MR_AVX512;
+		table.gemmColsD = 16;
+		table.gemmColsF = 32;
+		break;
+	case SIMD_AVX2:
+		table.level = SIMD_AVX2;
+		table.dotD = _dotAvx2;
+		table.axpyD = _axpyAvx2;
+		table.scaleD = _scaleAvx2;
+		table.dotF = _dotAvx2;
+		table.axpyF = _axpyAvx2;
+		table.scaleF = _scaleAvx2;
+		table.sigmoidD = _sigmoidAvx2;
+		table.sigmoidF = _sigmoidAvx2;
+		table.dotI8 = _dotInt8Avx2;
+		table.gemmI8 = _gemmInt8Avx2;
+		table.quantizeD = _quantizeInt8Avx2;
+		table.quantizeF = _quantizeInt8Avx2;
+		table.dequantizeD = _dequantizeInt32Avx2;
+		table.dequantizeF = _dequantizeInt32Avx2;
+		table.dotSparseD = _dotSparseAvx2;
+		table.dotSparseF = _dotSparseAvx2;
+		table.philox = _philoxAvx2;
+		table.gemmD = _gemmAvx2;
+		table.gemmF = _gemmAvx2;
+		table.gemmRows = GEMM_MR_AVX2;
+		table.gemmColsD = 8;
+		table.gemmColsF = 16;
+		break;
+	case SIMD_SSE2:
+		table.level = SIMD_SSE2;
+		table.dotD = _dotSse2;
+		table.axpyD = _axpySse2;
+		table.scaleD = _scaleSse2;
+		table.dotF = _dotSse2;
+		table.axpyF = _axpySse2;
+		table.scaleF = _scaleSse2;
+		table.dotI8 = _dotInt8Sse2;
+		table.gemmI8 = _gemmInt8Sse2;
+		break;
+	default:
+		break;
+	}
+#endif
+	return table;
+}
+
+static const s_KernelTable* _levelTable(const e_SimdLevel &level)
+{
+	// Every level's table, built together on first use (thread-safe static initialisation) and never changed after,
+	// so a kernel call that read a table pointer can finish with it whatever setSimdLevel() does meanwhile
+	static const s_KernelTable tables[] = {
+		_selectKernels(SIMD_SCALAR), _selectKernels(SIMD_SSE2), _selectKernels(SIMD_AVX2), _selectKernels(SIMD_AVX512)
+	};
+	return &tables[level];
+}
+
+static std::atomic<const s_KernelTable*>& _selectedTable()
+{
+	// The widest supported level on first use; setSimdLevel() swaps the pointer
+	static std::atomic<const s_KernelTable*> table(_levelTable(getMaxSimdLevel()));
+	return table;
+}
+
+static const s_KernelTable& _kernelTable()
+{
+	return *_selectedTable().load(std::memory_order_acquire);
+}
+
+double kernelDot(const double *x, const double *y, const size_t &n)
+{
+	return _kernelTable().dotD(x, y, n);
+}
+
+float kernelDot(const float *x, const float *y, const size_t &n)
+{
+	return _kernelTable().dotF(x, y, n);
+}
+
+void kernelAxpy(const double &alpha, const double *x, double *y, const size_t &n)
+{
+	_kernelTable().axpyD(alpha, x, y, n);
+}
+
+void kernelAxpy(const float &alpha, const float *x, float *y, const size_t &n)
+{
+	_kernelTable().axpyF(alpha, x, y, n);
+}
+
+void kernelScale(const double &alpha, const double *x, double *y, const size_t &n)
+{
+	_kernelTable().scaleD(alpha, x, y, n);
+}
+
+void kernelScale(const float &alpha, const float *x, float *y, const size_t &n)
+{
+	_kernelTable().scaleF(alpha, x, y, n);
+}
+
+void kernelSigmoidApprox(const double *x, double *y, const size_t &n)
+{
+	_kernelTable().sigmoidD(x, y, n);
+}
+
+void kernelSigmoidApprox(const float *x, float *y, const size_t &n)
+{
+	_kernelTable().sigmoidF(x, y, n);
+}
+
+int32_t kernelDotInt8(const int8_t *x, const int8_t *y, const size_t &n)
+{
+	return _kernelTable().dotI8(x, y, n);
+}
+
+void kernelGemmInt8(const size_t &rows, const size_t &k, const int8_t *a, const size_t &lda, const int8_t *b, const size_t &ldb, int32_t *c, const size_t &ldc)
+{
+	_kernelTable().gemmI8(rows, k, a, lda, b, ldb, c, ldc);
+}
+
+void kernelGemmInt8Shape(size_t &rows, size_t &cols)
+{
+	rows = _kernelTable().gemmI8Rows;
+	cols = GEMM_INT8_NR;
+}
+
+void kernelQuantizeInt8(const double *x, const double &scale, int8_t *y, const size_t &n)
+{
+	_kernelTable().quantizeD(x, scale, y, n);
+}
+
+void kernelQuantizeInt8(const float *x, const float &scale, int8_t *y, const size_t &n)
+{
+	_kernelTable().quantizeF(x, scale, y, n);
+}
+
+void kernelDequantizeInt32(const int32_t *x, const double &scale, const double *scales, const double *bias, double *y, const size_t &n)
+{
+	_kernelTable().dequantizeD(x, scale, scales, bias, y, n);
+}
+
+void kernelDequantizeInt32(const int32_t *x, const float &scale, const float *scales, const float *bias, float *y, const size_t &n)
+{
+	_kernelTable().dequantizeF(x, scale, scales, bias, y, n);
+}
+
+double kernelDotSparse(const double *x, const uint32_t *indices, const double *values, const size_t &n)
+{
+	return _kernelTable().dotSparseD(x, indices, values, n);
+}
+
+float kernelDotSparse(const float *x, const uint32_t *indices, const float *values, const size_t &n)
+{
+	return _kernelTable().dotSparseF(x, indices, values, n);
+}
+
+void kernelAxpySparse(const double &alpha, const uint32_t *indices, const double *values, double *y, const size_t &n)
+{
+	// A scatter, which is no faster vectorised (and needs the indices to be distinct), so the same at every level
+	_axpySparseScalar(alpha, indices, values, y, n);
+}
+
+void kernelAxpySparse(const float &alpha, const uint32_t *indices, const float *values, float *y, const size_t &n)
+{
+	_axpySparseScalar(alpha, indices, values, y, n);
+}
+
+void kernelPhilox(const uint32_t counter[4], const uint32_t key[2], const size_t &numBlocks, uint32_t *output)
+{
+	_kernelTable().philox(counter, key, numBlocks, output);
+}
+
+void kernelGemm(const size_t &k, const double &alpha, const double *a, const double *b, const double &beta, double *c, const size_t &ldc)
+{
+	_kernelTable().gemmD(k, alpha, a, b, beta, c, ldc);
+}
+
+void kernelGemm(const size_t &k, const float &alpha, const float *a, const float *b, const float &beta, float *c, const size_t &ldc)
+{
+	_kernelTable().gemmF(k, alpha, a, b, beta, c, ldc);
+}
+
+void kernelGemmShape(size_t &rows, size_t &colsDouble, size_t &colsFloat)
+{
+	const s_KernelTable &table = _kernelTable();
+	rows = table.gemmRows;
+	colsDouble = table.gemmColsD;
+	colsFloat = table.gemmColsF;
+}
+
+e_SimdLevel getSimdLevel()
+{
+	return _kernelTable().level;
+}
+
+e_SimdLevel getMaxSimdLevel()
+{
+	// Query the CPU (via CPUID) for the widest supported instruction set
+#ifdef KERNELS_X86_
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) {
+		return SIMD_AVX512;
+	}
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+		return SIMD_AVX2;
+	}
+	if (__builtin_cpu_supports("sse2")) {
+		return SIMD_SSE2;
+	}
+#endif
+	return SIMD_SCALAR;
+}
+
+bool setSimdLevel(const e_SimdLevel &level)
+{
+	// Force a particular kernel set (e.g. for benchmarking); fails if the CPU does not support it
+	if (level > getMaxSimdLevel()) {
+		return false;
+	}
+	_selectedTable().store(_levelTable(level), std::memory_order_release);
+	return true;
+}
+
+const char* getSimdLevelName(const e_SimdLevel &level)
+{
+	switch (level) {
+	case SIMD_SSE2:
+		return "sse2";
+	case SIMD_AVX2:
+		return "avx2";
+	case SIMD_AVX512:
+		return "avx512";
+	default:
+		return "scalar";
+	}
+}
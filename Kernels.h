@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Kernels.h
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef KERNELS_H_
+#define KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+enum e_SimdLevel {
+	SIMD_SCALAR,
+	SIMD_SSE2,
+	SIMD_AVX2,
+	SIMD_AVX512
+};
+
+// Vector kernels used by the perceptron and layer hot paths. Each kernel has a scalar, SSE2, AVX2 (with FMA)
+// and AVX-512 implementation for both float and double; the widest one supported by the CPU is selected on first use.
+// Dot product: returns sum(x[i] * y[i])
+double						kernelDot(const double *x, const double *y, const size_t &n);
+float						kernelDot(const float *x, const float *y, const size_t &n);
+// Axpy weight update: y[i] += alpha * x[i]
+void						kernelAxpy(const double &alpha, const double *x, double *y, const size_t &n);
+void						kernelAxpy(const float &alpha, const float *x, float *y, const size_t &n);
+// Scaling (weighted deltas): y[i] = alpha * x[i]
+void						kernelScale(const double &alpha, const double *x, double *y, const size_t &n);
+void						kernelScale(const float &alpha, const float *x, float *y, const size_t &n);
+// Approximate sigmoid: y[i] ~= 1 / (1 + e^-x[i]), to within 3e-12 (double) or 1e-7 (float) absolute error
+void						kernelSigmoidApprox(const double *x, double *y, const size_t &n);
+void						kernelSigmoidApprox(const float *x, float *y, const size_t &n);
+// Integer dot product for quantized inference: returns sum(x[i] * y[i]), exact in 32 bits for values in
+// [-127, 127] and n up to 2^17 (the AVX-512 level needs AVX-512BW for its kernel, otherwise it uses the AVX2 one)
+int32_t						kernelDotInt8(const int8_t *x, const int8_t *y, const size_t &n);
+// Int8 GEMM micro-kernel for quantized inference: C = A * B^T for up to a tile's rows of A (lda apart) against a
+// tile's columns' rows of B (ldb apart), each of k values, writing the 32 bit sums to C (rows ldc apart). Exact under
+// the same conditions as kernelDotInt8; the AVX-512 level uses VNNI when the CPU has it
+void						kernelGemmInt8(const size_t &rows, const size_t &k, const int8_t *a, const size_t &lda, const int8_t *b, const size_t &ldb, int32_t *c, const size_t &ldc);
+// Tile shape of kernelGemmInt8 at the selected level: the most rows of A, by the rows of B (columns of C)
+void						kernelGemmInt8Shape(size_t &rows, size_t &cols);
+// Input quantization: y[i] = x[i] * scale, saturated to [-127, 127] and rounded half away from zero. Scalar below
+// the AVX2 level
+void						kernelQuantizeInt8(const double *x, const double &scale, int8_t *y, const size_t &n);
+void						kernelQuantizeInt8(const float *x, const float &scale, int8_t *y, const size_t &n);
+// Rescaling of integer sums: y[i] = x[i] * (scale * scales[i]) + bias[i]. Scalar below the AVX2 level
+void						kernelDequantizeInt32(const int32_t *x, const double &scale, const double *scales, const double *bias, double *y, const size_t &n);
+void						kernelDequantizeInt32(const int32_t *x, const float &scale, const float *scales, const float *bias, float *y, const size_t &n);
+// Sparse dot product against a dense x (gathering x at the indices of the nonzero values, so the cost scales with
+// the number of nonzeros): returns sum(x[indices[i]] * values[i]). Scalar below the AVX2 level
+double						kernelDotSparse(const double *x, const uint32_t *indices, const double *values, const size_t &n);
+float						kernelDotSparse(const float *x, const uint32_t *indices, const float *values, const size_t &n);
+// Sparse axpy into a dense y (scattering to the indices of the nonzero values): y[indices[i]] += alpha * values[i].
+// Scalar at every level
+void						kernelAxpySparse(const double &alpha, const uint32_t *indices, const double *values, double *y, const size_t &n);
+void						kernelAxpySparse(const float &alpha, const uint32_t *indices, const float *values, float *y, const size_t &n);
+
+// Philox4x32-10 counter-based random numbers (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3"): a
+// keyed bijection of a 128 bit counter, so any block of any stream can be generated directly, in any order and on any
+// thread, with the same result at every level. Writes numBlocks blocks of four words, block b from the counter with
+// counter[0] + b as its first word. Scalar below the AVX2 level
+void						kernelPhilox(const uint32_t counter[4], const uint32_t key[2], const size_t &numBlocks, uint32_t *output);
+
+// GEMM micro-kernel on packed panels: C = alpha * A * B + beta * C for one tile of C (rows ldc apart), with A packed
+// as k columns of the tile's rows and B as k rows of the tile's columns (C is not read when beta is 0). The tile shape
+// depends on the level and type, see kernelGemmShape; the scalar and SSE2 levels use a 4 x 4 tile
+void						kernelGemm(const size_t &k, const double &alpha, const double *a, const double *b, const double &beta, double *c, const size_t &ldc);
+void						kernelGemm(const size_t &k, const float &alpha, const float *a, const float *b, const float &beta, float *c, const size_t &ldc);
+// Tile shape of kernelGemm at the selected level: rows, by columns of doubles or of floats
+void						kernelGemmShape(size_t &rows, size_t &colsDouble, size_t &colsFloat);
+
+// Kernel selection. setSimdLevel() may be called while other threads run kernels: each call then uses the old or
+// the new level's kernels throughout, but a network trained across the switch mixes their rounding
+e_SimdLevel					getSimdLevel();
+e_SimdLevel					getMaxSimdLevel();
+bool						setSimdLevel(const e_SimdLevel &level);
+const char*					getSimdLevelName(const e_SimdLevel &level);
+
+#endif KERNELS_H_
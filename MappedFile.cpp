@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// MappedFile
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedFile.h"
+
+c_MappedFile::c_MappedFile() :
+	m_Data(NULL),
+	m_Size(0)
+{
+}
+
+c_MappedFile::~c_MappedFile()
+{
+	close();
+}
+
+unsigned char* c_MappedFile::data()
+{
+	return m_Data;
+}
+
+const size_t c_MappedFile::size()
+{
+	return m_Size;
+}
+
+bool c_MappedFile::open(const std::string &filename)
+{
+	close();
+	const int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat info;
+	if ((fstat(fd, &info) != 0) || (info.st_size <= 0)) {
+		::close(fd);
+		return false;
+	}
+	// Map the file privately: pages are shared with every other process mapping the same file until written,
+	// and any writes (e.g. further training) are copied-on-write, so never reach the file
+	void *data = mmap(NULL, static_cast<size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	// The mapping remains valid once the descriptor is closed
+	::close(fd);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+	m_Data = static_cast<unsigned char*>(data);
+	m_Size = static_cast<size_t>(info.st_size);
+	return true;
+}
+
+void c_MappedFile::close()
+{
+	if (m_Data != NULL) {
+		munmap(m_Data, m_Size);
+		m_Data = NULL;
+	}
+	m_Size = 0;
+}
@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// MappedFile
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <cstddef>
+#include <string>
+
+class c_MappedFile {
+public:
+	// Constructors
+									c_MappedFile();
+	// Destructor
+	virtual							~c_MappedFile();
+	// Get
+	unsigned char*					data();
+	const size_t					size();
+	// Functions
+	bool							open(const std::string &filename);
+	void							close();
+private:
+	// Not copyable
+									c_MappedFile(const c_MappedFile &src);
+	c_MappedFile&					operator=(const c_MappedFile &src);
+	// Variables
+	unsigned char					*m_Data;
+	size_t							m_Size;
+};
+
+#endif MAPPEDFILE_H_
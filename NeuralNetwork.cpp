@@ -24,42 +24,161 @@
 //
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#include "Kernels.h"
 #include "NeuralNetwork.h"
 
-c_NeuralNetwork::c_NeuralNetwork(const std::valarray<double> &inputs, const std::valarray<double> &targets, const std::vector<size_t> &layers, const e_Activation &actType, const double &trainRate, const bool &bias) :
+// Model file format: a header, a table of layers, then each layer's weights matrix (including row padding)
+// at a 64 byte aligned offset, so a memory-mapped file can be used as the weights storage directly
+const char MODEL_MAGIC[8] = {'B', 'N', 'N', 'M', 'O', 'D', 'E', 'L'};
+const uint32_t MODEL_VERSION = 1;
+// Written in the native byte order, so a file saved on a machine of the other byte order is rejected
+const uint32_t MODEL_BYTE_ORDER = 0x01020304;
+
+struct s_ModelHeader {
+	char							magic[8];
+	uint32_t						version;
+	uint32_t						byteOrder;
+	uint32_t						scalarSize;
+	uint32_t						numLayers;
+	uint32_t						actType;
+	uint32_t						bias;
+	uint64_t						numInputs;
+	double							trainRate;
+	uint8_t							reserved[16];
+};
+
+struct s_ModelLayer {
+	uint64_t						size;
+	uint64_t						inputSize;
+	uint64_t						stride;
+	uint64_t						offset;
+};
+
+static uint64_t _alignOffset(const uint64_t &offset)
+{
+	return ((offset + ALIGN_BYTES - 1) / ALIGN_BYTES) * ALIGN_BYTES;
+}
+
+template <typename T>
+c_BasicNeuralNetwork<T>::c_BasicNeuralNetwork(const std::valarray<T> &inputs, const std::valarray<T> &targets, const std::vector<size_t> &layers, const e_Activation &actType, const T &trainRate, const bool &bias) :
 	m_Inputs(&inputs),
 	m_Targets(&targets),
-	m_Size(layers.size())
+	m_Bias(bias),
+	m_Size(layers.size()),
+	m_SparseCount(0),
+	m_SparseInputs(false),
+	m_ShardInputs(NULL),
+	m_ShardTargets(NULL),
+	m_ShardRows(0),
+	m_ActPrecision(ACTP_EXACT)
 {
 	_build(layers);
-	setBias(bias);
 	setTrainRate(trainRate);
 	setActivation(actType);
 }
 
-c_NeuralNetwork::c_NeuralNetwork(const c_NeuralNetwork &src)
+template <typename T>
+c_BasicNeuralNetwork<T>::c_BasicNeuralNetwork(const c_BasicNeuralNetwork &src)
 {
 	_copy(src);
 }
 
-c_NeuralNetwork::~c_NeuralNetwork()
+template <typename T>
+c_BasicNeuralNetwork<T>::c_BasicNeuralNetwork(c_BasicNeuralNetwork &&src) noexcept
+{
+	_move(src);
+}
+
+template <typename T>
+c_BasicNeuralNetwork<T>::~c_BasicNeuralNetwork()
+{
+}
+
+template <typename T>
+c_BasicNeuralNetwork<T>& c_BasicNeuralNetwork<T>::operator=(const c_BasicNeuralNetwork &src)
 {
+	if (this != &src) {
+		_copy(src);
+	}
+	return *this;
 }
 
-void c_NeuralNetwork::setInputs(const std::valarray<double> &inputs)
+template <typename T>
+c_BasicNeuralNetwork<T>& c_BasicNeuralNetwork<T>::operator=(c_BasicNeuralNetwork &&src) noexcept
+{
+	if (this != &src) {
+		_move(src);
+	}
+	return *this;
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::setInputs(const std::valarray<T> &inputs)
 {
 	m_Inputs = &inputs;
+	m_SparseInputs = false;
 	_resizeLocalInputs();
 	_connectInputs();
+	_updateArena();
 }
 
-void c_NeuralNetwork::setTargets(const std::valarray<double> &targets)
+template <typename T>
+bool c_BasicNeuralNetwork<T>::setSparseInputs(const uint32_t *indices, const T *values, const size_t &count)
+{
+	// Set the inputs as (index, value) pairs of the nonzero inputs only (the indices distinct and below the number
+	// of inputs), which evaluate(), train() and step() then use until the next setInputs() or setBias(): the first
+	// layer gathers and updates only the weights of these inputs, so the cost scales with the nonzeros rather than
+	// the input width. The pairs are copied, so need not outlive the call
+	if (m_Inputs == NULL) {
+		return false;
+	}
+	const size_t numInputs = m_Inputs->size();
+	if (count > numInputs) {
+		return false;
+	}
+	for (size_t i = 0; i < count; ++i) {
+		if (indices[i] >= numInputs) {
+			return false;
+		}
+	}
+	if (m_SparseIndices.size() != m_LocalInputs.size()) {
+		// Room for every input (and the bias), so later calls never reallocate
+		m_SparseIndices.resize(m_LocalInputs.size());
+		m_SparseValues.resize(m_LocalInputs.size());
+	}
+	for (size_t i = 0; i < count; ++i) {
+		m_SparseIndices[i] = indices[i];
+		m_SparseValues[i] = values[i];
+	}
+	m_SparseCount = count;
+	if (m_Bias) {
+		// The bias input is always nonzero
+		m_SparseIndices[m_SparseCount] = static_cast<uint32_t>(numInputs);
+		m_SparseValues[m_SparseCount] = 1.0;
+		++m_SparseCount;
+	}
+	m_SparseInputs = true;
+	_connectInputs();
+	return true;
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::setTargets(const std::valarray<T> &targets)
 {
 	m_Targets = &targets;
 	_connectTargets();
 }
 
-void c_NeuralNetwork::setTrainRate(const double &trainRate)
+template <typename T>
+void c_BasicNeuralNetwork<T>::setTrainRate(const T &trainRate)
 {
 	m_TrainRate = trainRate;
 	// Apply the new training rate to all layers in the network
@@ -68,7 +187,8 @@ void c_NeuralNetwork::setTrainRate(const double &trainRate)
 	}
 }
 
-void c_NeuralNetwork::setActivation(const e_Activation &actType)
+template <typename T>
+void c_BasicNeuralNetwork<T>::setActivation(const e_Activation &actType)
 {
 	m_ActType = actType;
 	// Apply the new activation type to all layers in the network
@@ -77,9 +197,26 @@ void c_NeuralNetwork::setActivation(const e_Activation &actType)
 	}
 }
 
-void c_NeuralNetwork::setBias(const bool &bias)
+template <typename T>
+void c_BasicNeuralNetwork<T>::setActPrecision(const e_ActPrecision &actPrecision)
+{
+	m_ActPrecision = actPrecision;
+	// Apply the new activation precision to all layers in the network
+	for (size_t i = 0; i < m_Size; ++i) {
+		m_Layers[i].setActPrecision(actPrecision);
+	}
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::setBias(const bool &bias)
 {
 	m_Bias = bias;
+	// Any sparse inputs were set for the previous bias state
+	m_SparseInputs = false;
+	if (m_Size == 0) {
+		// A moved-from network has no layers to apply it to
+		return;
+	}
 	// Apply the new bias state to all but the last layer in the network
 	for (size_t i = 0; i < (m_Size - 1); ++i) {
 		m_Layers[i].setBias(bias);
@@ -87,59 +224,567 @@ void c_NeuralNetwork::setBias(const bool &bias)
 	m_Layers[m_Size - 1].setBias(false);
 	_resizeLocalInputs();
 	_connectInputs();
+	_updateArena();
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::setThreads(const size_t &numThreads)
+{
+	// Create a persistent thread pool shared by all layers in the network (0 or 1 threads to run serially)
+	if (numThreads > 1) {
+		m_ThreadPool = std::make_shared<c_ThreadPool>(numThreads);
+	} else {
+		m_ThreadPool.reset();
+	}
+	_connectThreadPool();
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::setOptimizer(const c_BasicOptimizer<T> &optimizer)
+{
+	// Give every layer its own copy of the optimizer (each holding the state for that layer's weights)
+	for (size_t i = 0; i < m_Size; ++i) {
+		m_Layers[i].setOptimizer(optimizer);
+	}
 }
 
-c_PerceptronLayer& c_NeuralNetwork::operator[](const size_t &idx)
+template <typename T>
+void c_BasicNeuralNetwork<T>::setProfiling(const bool &profiling)
+{
+	// Record the time and work of each layer call (only when built with BASICNN_PROFILE, otherwise a no-op)
+	m_Profiler.setEnabled(profiling);
+}
+
+template <typename T>
+c_BasicPerceptronLayer<T>& c_BasicNeuralNetwork<T>::operator[](const size_t &idx)
+{
+	return m_Layers[idx];
+}
+
+template <typename T>
+const c_BasicPerceptronLayer<T>& c_BasicNeuralNetwork<T>::operator[](const size_t &idx) const
 {
 	return m_Layers[idx];
 }
 
-const size_t c_NeuralNetwork::getSize()
+template <typename T>
+const size_t c_BasicNeuralNetwork<T>::getSize() const
 {
 	return m_Size;
 }
 
-const std::valarray<double>& c_NeuralNetwork::getOutputs()
+template <typename T>
+const size_t c_BasicNeuralNetwork<T>::getNumInputs() const
+{
+	return (m_Inputs != NULL) ? m_Inputs->size() : 0;
+}
+
+template <typename T>
+const e_Activation c_BasicNeuralNetwork<T>::getActivation()
+{
+	return m_ActType;
+}
+
+template <typename T>
+const e_ActPrecision c_BasicNeuralNetwork<T>::getActPrecision()
+{
+	return m_ActPrecision;
+}
+
+template <typename T>
+const size_t c_BasicNeuralNetwork<T>::getThreads()
+{
+	return m_ThreadPool ? m_ThreadPool->getSize() : 1;
+}
+
+template <typename T>
+const std::valarray<T>& c_BasicNeuralNetwork<T>::getOutputs()
+{
+	// A moved-from network has no layers, so no outputs
+	static const std::valarray<T> noOutputs;
+	return (m_Size > 0) ? m_Layers[m_Size - 1].getOutputs() : noOutputs;
+}
+
+template <typename T>
+const bool c_BasicNeuralNetwork<T>::getProfiling()
+{
+	return m_Profiler.isEnabled();
+}
+
+template <typename T>
+const size_t c_BasicNeuralNetwork<T>::getNumWeights()
 {
-	return m_Layers[m_Size - 1].getOutputs();
+	// Number of weights in every layer (bias weights included, row padding excluded)
+	size_t numWeights = 0;
+	for (size_t i = 0; i < m_Size; ++i) {
+		numWeights += m_Layers[i].getSize() * m_Layers[i].getInputSize();
+	}
+	return numWeights;
 }
 
-void c_NeuralNetwork::evaluate()
+template <typename T>
+const size_t c_BasicNeuralNetwork<T>::getNumPruned()
+{
+	size_t numPruned = 0;
+	for (size_t i = 0; i < m_Size; ++i) {
+		numPruned += m_Layers[i].getNumPruned();
+	}
+	return numPruned;
+}
+
+template <typename T>
+s_ProfileCounters c_BasicNeuralNetwork<T>::getProfile(const size_t &layer, const e_ProfilePhase &phase)
+{
+	return m_Profiler.getCounters(layer, phase);
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::evaluate()
 {
 	// Evaluate the network (feedforwards)
 	if (m_Inputs != NULL) {
 		_updateLocalInputs();
 		for (size_t i = 0; i < m_Size; ++i) {
+			BASICNN_PROFILE_LAYER(m_Profiler, i, PROFILE_EVALUATE, m_Layers[i].getSize(), m_Layers[i].getInputSize(), 1, sizeof(T));
 			m_Layers[i].evaluate();
 		}
 	}
 }
 
-void c_NeuralNetwork::train()
+template <typename T>
+void c_BasicNeuralNetwork<T>::train()
 {
 	// Train the network (backpropagation)
 	if ((m_Inputs != NULL) && (m_Targets != NULL)) {
 		_updateLocalInputs();
 		for (size_t i = m_Size; i > 0; --i) {
+			BASICNN_PROFILE_LAYER(m_Profiler, i - 1, PROFILE_TRAIN, m_Layers[(i - 1)].getSize(), m_Layers[(i - 1)].getInputSize(), 1, sizeof(T));
 			m_Layers[(i - 1)].train();
 		}
 	}
 }
 
-void c_NeuralNetwork::_updateLocalInputs()
+template <typename T>
+T c_BasicNeuralNetwork<T>::step()
 {
+	// Train the network on the current inputs and targets in a single sweep (the same result as evaluate() then
+	// train()): forwards through the hidden layers, the output layer evaluated and trained together, then backwards
+	// through the hidden layers, whose activations are still those just evaluated. Returns the mean squared error
+	// of the outputs, as evaluated before training
+	if ((m_Inputs == NULL) || (m_Targets == NULL)) {
+		return 0.0;
+	}
+	_updateLocalInputs();
+	for (size_t i = 0; i < (m_Size - 1); ++i) {
+		BASICNN_PROFILE_LAYER(m_Profiler, i, PROFILE_EVALUATE, m_Layers[i].getSize(), m_Layers[i].getInputSize(), 1, sizeof(T));
+		m_Layers[i].evaluate();
+	}
+	c_BasicPerceptronLayer<T> &outputLayer = m_Layers[m_Size - 1];
+	T error;
+	{
+		BASICNN_PROFILE_LAYER(m_Profiler, m_Size - 1, PROFILE_STEP, outputLayer.getSize(), outputLayer.getInputSize(), 1, sizeof(T));
+		error = outputLayer.step();
+	}
+	for (size_t i = (m_Size - 1); i > 0; --i) {
+		BASICNN_PROFILE_LAYER(m_Profiler, i - 1, PROFILE_TRAIN, m_Layers[(i - 1)].getSize(), m_Layers[(i - 1)].getInputSize(), 1, sizeof(T));
+		m_Layers[(i - 1)].train();
+	}
+	return error / static_cast<T>(outputLayer.getSize());
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::evaluateBatch(const T *inputs, const size_t &rows, T *outputs)
+{
+	// Evaluate the network (feedforwards) for a batch of row-major input rows, writing row-major output rows
+	if ((m_Inputs != NULL) && (rows > 0)) {
+		_evaluateBatch(inputs, rows);
+		c_BasicPerceptronLayer<T> &outputLayer = m_Layers[m_Size - 1];
+		const size_t numOutputs = outputLayer.getSize();
+		for (size_t r = 0; r < rows; ++r) {
+			const T *batchOutputs = outputLayer.getBatchOutputs() + (r * outputLayer.getBatchStride());
+			for (size_t i = 0; i < numOutputs; ++i) {
+				outputs[(r * numOutputs) + i] = batchOutputs[i];
+			}
+		}
+	}
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::trainBatch(const T *inputs, const T *targets, const size_t &rows)
+{
+	// Train the network (backpropagation) on a batch of row-major input and target rows, averaging the weight changes
+	if ((m_Inputs != NULL) && (rows > 0)) {
+		_evaluateBatch(inputs, rows);
+		for (size_t i = m_Size; i > 0; --i) {
+			BASICNN_PROFILE_LAYER(m_Profiler, i - 1, PROFILE_TRAIN_BATCH, m_Layers[i - 1].getSize(), m_Layers[i - 1].getInputSize(), rows, sizeof(T));
+			if (i == 1) {
+				// The first layer is also the output layer of a single-layer network
+				m_Layers[0].trainBatch(inputs, getNumInputs(), (m_Size == 1) ? targets : NULL, rows);
+			} else {
+				c_BasicPerceptronLayer<T> &input = m_Layers[i - 2];
+				m_Layers[i - 1].trainBatch(input.getBatchOutputs(), input.getBatchStride(), (i == m_Size) ? targets : NULL, rows);
+			}
+		}
+	}
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::evaluate(const T *inputs, c_BasicExecContext<T> &context) const
+{
+	// Evaluate the network (feedforwards) for one sample using the context's buffers only, so any number of
+	// threads can evaluate at once, each with its own context (a moved-from network has no inputs or layers)
+	if (m_Inputs == NULL) {
+		return;
+	}
+	const size_t numInputs = m_Inputs->size();
+	for (size_t i = 0; i < numInputs; ++i) {
+		context.m_Inputs[i] = inputs[i];
+	}
+	m_Layers[0].evaluateSample(context.m_Inputs.data(), context.m_Sums[0].data(), context.m_Outputs[0].data());
+	for (size_t i = 1; i < m_Size; ++i) {
+		m_Layers[i].evaluateSample(context.m_Outputs[i - 1].data(), context.m_Sums[i].data(), context.m_Outputs[i].data());
+	}
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::infer(const T *inputs, T *outputs, c_BasicExecContext<T> &context) const
+{
+	// Thread-safe inference: the network is not modified, and the context (built for this network) acts as a
+	// small per-thread workspace holding the activations, so one set of weights can serve any number of threads
+	if (m_Inputs == NULL) {
+		return;
+	}
+	evaluate(inputs, context);
+	const c_BasicPerceptronLayer<T> &outputLayer = m_Layers[m_Size - 1];
+	const T *contextOutputs = context.m_Outputs[m_Size - 1].data();
+	for (size_t i = 0; i < outputLayer.getSize(); ++i) {
+		outputs[i] = contextOutputs[i];
+	}
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::accumulate(const T *inputs, const T *targets, c_BasicExecContext<T> &context)
+{
+	// Evaluate and backpropagate one sample, adding its gradients to the context rather than updating the (shared)
+	// weights; the accumulated gradients are applied with applyGradients
+	if (m_Inputs == NULL) {
+		return;
+	}
+	context._resizeGradients(*this);
+	evaluate(inputs, context);
+	const size_t numOutputs = m_Layers[m_Size - 1].getSize();
+	const T *outputs = context.m_Outputs[m_Size - 1].data();
+	for (size_t i = 0; i < numOutputs; ++i) {
+		context.m_Errors[i] = targets[i] - outputs[i];
+	}
+	for (size_t i = m_Size; i > 0; --i) {
+		const size_t l = i - 1;
+		const T *layerInputs = (l > 0) ? context.m_Outputs[l - 1].data() : context.m_Inputs.data();
+		const T *errors = (l == (m_Size - 1)) ? context.m_Errors.data() : context.m_WeightedDeltaSums[l + 1].data();
+		m_Layers[l].backpropSample(layerInputs, context.m_Sums[l].data(), context.m_Outputs[l].data(), errors, context.m_Deltas[l].data(),
+			(l > 0) ? context.m_WeightedDeltaSums[l].data() : NULL, context.m_Gradients[l].data());
+	}
+	++context.m_Samples;
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::applyGradients(c_BasicExecContext<T> *contexts, const size_t &numContexts)
+{
+	// Reduce the gradients of every context (in order, so the result does not depend on thread timing) and apply
+	// their average to the weights, then clear the contexts. No context may be in use while this runs
+	if (numContexts == 0) {
+		return;
+	}
+	c_BasicExecContext<T> &total = contexts[0];
+	total._resizeGradients(*this);
+	for (size_t c = 1; c < numContexts; ++c) {
+		if (contexts[c].m_Samples == 0) {
+			continue;
+		}
+		for (size_t l = 0; l < m_Size; ++l) {
+			kernelAxpy(static_cast<T>(1.0), contexts[c].m_Gradients[l].data(), total.m_Gradients[l].data(), total.m_Gradients[l].size());
+		}
+		total.m_Samples += contexts[c].m_Samples;
+		contexts[c].clearGradients();
+	}
+	for (size_t l = 0; l < m_Size; ++l) {
+		BASICNN_PROFILE_LAYER(m_Profiler, l, PROFILE_APPLY_GRADIENTS, m_Layers[l].getSize(), m_Layers[l].getInputSize(), 1, sizeof(T));
+		m_Layers[l].applyGradients(total.m_Gradients[l].data(), total.m_Samples);
+	}
+	total.clearGradients();
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::trainParallel(const T *inputs, const T *targets, const size_t &rows)
+{
+	// Train on a batch of row-major input and target rows, data-parallel across the thread pool: each thread
+	// accumulates the gradients of its own contiguous shard of rows in its own context against the shared weights,
+	// then the gradients are reduced and applied once (a synchronous mini-batch, so unlike Hogwild the result is
+	// deterministic). Unlike trainBatch, this scales with the number of threads even for narrow layers
+	if ((m_Inputs == NULL) || (rows == 0)) {
+		return;
+	}
+	const size_t numContexts = getThreads();
+	if ((m_Contexts.size() != numContexts) || !m_Contexts[0]._matches(*this)) {
+		m_Contexts.clear();
+		m_Contexts.reserve(numContexts);
+		for (size_t i = 0; i < numContexts; ++i) {
+			m_Contexts.push_back(c_BasicExecContext<T>(*this));
+		}
+	}
+	m_ShardInputs = inputs;
+	m_ShardTargets = targets;
+	m_ShardRows = rows;
+	if (m_ThreadPool && (numContexts > 1)) {
+		m_ThreadPool->run(numContexts, [this](const size_t &shard) { _trainShard(shard); });
+	} else {
+		_trainShard(0);
+	}
+	applyGradients(m_Contexts.data(), m_Contexts.size());
+}
+
+template <typename T>
+bool c_BasicNeuralNetwork<T>::save(const std::string &filename)
+{
+	// Save the network configuration and weights to a binary model file
+	s_ModelHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MODEL_MAGIC, sizeof(header.magic));
+	header.version = MODEL_VERSION;
+	header.byteOrder = MODEL_BYTE_ORDER;
+	header.scalarSize = sizeof(T);
+	header.numLayers = static_cast<uint32_t>(m_Size);
+	header.actType = static_cast<uint32_t>(m_ActType);
+	header.bias = m_Bias ? 1 : 0;
+	header.numInputs = (m_Inputs != NULL) ? m_Inputs->size() : 0;
+	header.trainRate = m_TrainRate;
+	std::vector<s_ModelLayer> layers(m_Size);
+	uint64_t offset = _alignOffset(sizeof(header) + (m_Size * sizeof(s_ModelLayer)));
+	for (size_t i = 0; i < m_Size; ++i) {
+		layers[i].size = m_Layers[i].getSize();
+		layers[i].inputSize = m_Layers[i].getInputSize();
+		layers[i].stride = m_Layers[i].getStride();
+		layers[i].offset = offset;
+		offset = _alignOffset(offset + (layers[i].size * layers[i].stride * sizeof(T)));
+	}
+	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+	if (!file) {
+		return false;
+	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(layers.data()), m_Size * sizeof(s_ModelLayer));
+	const char padding[ALIGN_BYTES] = {0};
+	for (size_t i = 0; i < m_Size; ++i) {
+		// Pad up to the aligned offset of this layer's weights
+		file.write(padding, static_cast<std::streamsize>(layers[i].offset - static_cast<uint64_t>(file.tellp())));
+		file.write(reinterpret_cast<const char*>(m_Layers[i].getWeights()), static_cast<std::streamsize>(layers[i].size * layers[i].stride * sizeof(T)));
+	}
+	return static_cast<bool>(file);
+}
+
+template <typename T>
+bool c_BasicNeuralNetwork<T>::load(const std::string &filename)
+{
+	// Rebuild the network from a binary model file, copying the weights
+	std::ifstream file(filename.c_str(), std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (!_load(data.data(), data.size(), false)) {
+		return false;
+	}
+	// Release any previously mapped model, now no layer refers to it
+	m_MappedFile.reset();
+	return true;
+}
+
+template <typename T>
+bool c_BasicNeuralNetwork<T>::loadMapped(const std::string &filename)
+{
+	// Rebuild the network from a memory-mapped binary model file, with the layer weights pointing straight into the
+	// mapping (no parse or copy step, and the pages are shared by every process mapping the same model).
+	// The mapping is private, so training the loaded network copies only the pages it writes, never changing the file
+	std::shared_ptr<c_MappedFile> mappedFile = std::make_shared<c_MappedFile>();
+	if (!mappedFile->open(filename) || !_load(mappedFile->data(), mappedFile->size(), true)) {
+		return false;
+	}
+	m_MappedFile = mappedFile;
+	return true;
+}
+
+template <typename T>
+size_t c_BasicNeuralNetwork<T>::prune(const T &threshold)
+{
+	// Prune the weights smaller in magnitude than the threshold in every layer (see c_PerceptronLayer::prune), so
+	// they stay zero through fine-tuning until clearPruneMask(). Returns the number of weights pruned in all
+	for (size_t i = 0; i < m_Size; ++i) {
+		m_Layers[i].prune(threshold);
+	}
+	return getNumPruned();
+}
+
+template <typename T>
+size_t c_BasicNeuralNetwork<T>::pruneFraction(const T &fraction)
+{
+	// Prune the smallest magnitude weights across the whole network (one threshold for every layer), until the
+	// given fraction (0 to 1) of them are pruned. Layers with smaller weights lose more of them; to prune every
+	// layer to the same sparsity, prune the layers individually
+	const size_t numWeights = getNumWeights();
+	const size_t target = static_cast<size_t>(fraction * static_cast<T>(numWeights));
+	if ((numWeights == 0) || (target == 0) || (target <= getNumPruned())) {
+		return getNumPruned();
+	}
+	std::vector<T> magnitudes;
+	magnitudes.reserve(numWeights);
+	for (size_t l = 0; l < m_Size; ++l) {
+		c_BasicPerceptronLayer<T> &layer = m_Layers[l];
+		const T *weights = layer.getWeights();
+		for (size_t i = 0; i < layer.getSize(); ++i) {
+			for (size_t j = 0; j < layer.getInputSize(); ++j) {
+				magnitudes.push_back(std::fabs(weights[(i * layer.getStride()) + j]));
+			}
+		}
+	}
+	if (target >= numWeights) {
+		return prune(*std::max_element(magnitudes.begin(), magnitudes.end()) + static_cast<T>(1.0));
+	}
+	std::nth_element(magnitudes.begin(), magnitudes.begin() + target, magnitudes.end());
+	return prune(magnitudes[target]);
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::clearPruneMask()
+{
+	for (size_t i = 0; i < m_Size; ++i) {
+		m_Layers[i].clearPruneMask();
+	}
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::initWeights(const c_BasicInitializer<T> &initializer)
+{
+	// Each layer draws from its own stream (its index), so no two layers share weights
+	for (size_t i = 0; i < m_Size; ++i) {
+		m_Layers[i].initWeights(initializer, i);
+	}
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::clearProfile()
+{
+	m_Profiler.clear();
+}
+
+template <typename T>
+bool c_BasicNeuralNetwork<T>::saveProfileTrace(const std::string &filename)
+{
+	// Write the recorded layer calls as a Chrome trace (load it in chrome://tracing or Perfetto)
+	return m_Profiler.saveTrace(filename);
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::_evaluateBatch(const T *inputs, const size_t &rows)
+{
+	// Feed the batch forwards through each layer, with the first layer reading the input rows in place (the bias
+	// weights are applied implicitly, so the rows need no bias column) and each later layer the batch outputs of the
+	// layer before
+	for (size_t i = 0; i < m_Size; ++i) {
+		BASICNN_PROFILE_LAYER(m_Profiler, i, PROFILE_EVALUATE_BATCH, m_Layers[i].getSize(), m_Layers[i].getInputSize(), rows, sizeof(T));
+		if (i == 0) {
+			m_Layers[0].evaluateBatch(inputs, getNumInputs(), rows);
+		} else {
+			m_Layers[i].evaluateBatch(m_Layers[i - 1].getBatchOutputs(), m_Layers[i - 1].getBatchStride(), rows);
+		}
+	}
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::_trainShard(const size_t &shard)
+{
+	const size_t numInputs = getNumInputs();
+	const size_t numOutputs = m_Layers[m_Size - 1].getSize();
+	const size_t shardRows = (m_ShardRows + m_Contexts.size() - 1) / m_Contexts.size();
+	const size_t begin = shard * shardRows;
+	const size_t end = ((begin + shardRows) < m_ShardRows) ? (begin + shardRows) : m_ShardRows;
+	for (size_t r = begin; r < end; ++r) {
+		accumulate(m_ShardInputs + (r * numInputs), m_ShardTargets + (r * numOutputs), m_Contexts[shard]);
+	}
+}
+
+template <typename T>
+bool c_BasicNeuralNetwork<T>::_load(unsigned char *data, const size_t &size, const bool &attach)
+{
+	// Validate the whole model before changing the network, so a failed load leaves it untouched
+	if (size < sizeof(s_ModelHeader)) {
+		return false;
+	}
+	s_ModelHeader header;
+	memcpy(&header, data, sizeof(header));
+	if ((memcmp(header.magic, MODEL_MAGIC, sizeof(header.magic)) != 0) || (header.version != MODEL_VERSION) ||
+		(header.byteOrder != MODEL_BYTE_ORDER) || (header.scalarSize != sizeof(T)) || (header.numLayers == 0) ||
+		(header.actType > ACT_SIGMOID) || (header.bias > 1) ||
+		((m_Inputs != NULL) && (header.numInputs != m_Inputs->size())) ||
+		(size < (sizeof(header) + (header.numLayers * sizeof(s_ModelLayer))))) {
+		return false;
+	}
+	std::vector<s_ModelLayer> layers(header.numLayers);
+	memcpy(layers.data(), data + sizeof(header), header.numLayers * sizeof(s_ModelLayer));
+	std::vector<size_t> sizes(header.numLayers);
+	uint64_t inputSize = header.numInputs + header.bias;
+	for (size_t i = 0; i < header.numLayers; ++i) {
+		const bool bias = (header.bias != 0) && (i < (header.numLayers - 1));
+		if ((layers[i].size == 0) || (layers[i].inputSize != inputSize) ||
+			(layers[i].stride != c_AlignedBuffer<T>::padSize(inputSize)) || ((layers[i].offset % ALIGN_BYTES) != 0) ||
+			(layers[i].offset > size) || ((layers[i].size * layers[i].stride * sizeof(T)) > (size - layers[i].offset))) {
+			return false;
+		}
+		sizes[i] = layers[i].size;
+		inputSize = layers[i].size + (bias ? 1 : 0);
+	}
+	// Rebuild the layers to the saved configuration, either attaching the weights (which then stay out of the arena)
+	// or copying them
+	std::vector<T*> weights(header.numLayers);
+	for (size_t i = 0; i < header.numLayers; ++i) {
+		weights[i] = reinterpret_cast<T*>(data + layers[i].offset);
+	}
+	m_Layers.clear();
+	m_Size = sizes.size();
+	m_Bias = (header.bias != 0);
+	m_SparseInputs = false;
+	_build(sizes, attach ? weights.data() : NULL);
+	setTrainRate(static_cast<T>(header.trainRate));
+	setActivation(static_cast<e_Activation>(header.actType));
+	setActPrecision(m_ActPrecision);
+	_connectThreadPool();
+	if (!attach) {
+		for (size_t i = 0; i < m_Size; ++i) {
+			memcpy(m_Layers[i].getWeights(), weights[i], layers[i].size * layers[i].stride * sizeof(T));
+		}
+	}
+	return true;
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::_updateLocalInputs()
+{
+	// Copy the inputs element by element into the (already sized) local inputs array, so this never allocates
+	// (sparse inputs are read by the first layer directly)
+	if (m_SparseInputs) {
+		return;
+	}
+	const size_t numInputs = m_Inputs->size();
+	for (size_t i = 0; i < numInputs; ++i) {
+		m_LocalInputs[i] = (*m_Inputs)[i];
+	}
 	if (m_Bias) {
-		// Set the first N values of the local inputs array (leaving the last one untouched)
-		m_LocalInputs[std::slice(0, m_Inputs->size(), 1)] = (*m_Inputs);
 		// Set the last local input to the bias value
-		m_LocalInputs[m_LocalInputs.size() - 1] = 1.0;
-	} else {
-		// Copy the input array directly to the local inputs array
-		m_LocalInputs = (*m_Inputs);
+		m_LocalInputs[numInputs] = 1.0;
 	}
 }
 
-void c_NeuralNetwork::_resizeLocalInputs()
+template <typename T>
+void c_BasicNeuralNetwork<T>::_resizeLocalInputs()
 {
 	if (m_Inputs != NULL) {
 		if (m_Bias) {
@@ -150,21 +795,83 @@ void c_NeuralNetwork::_resizeLocalInputs()
 	}
 }
 
-void c_NeuralNetwork::_copy(const c_NeuralNetwork &src)
+template <typename T>
+void c_BasicNeuralNetwork<T>::_copy(const c_BasicNeuralNetwork &src)
 {
 	// Copy member variables
 	m_Inputs = src.m_Inputs;
 	m_Targets = src.m_Targets;
-	m_Layers = src.m_Layers;
+	m_LocalInputs = src.m_LocalInputs;
+	m_SparseIndices = src.m_SparseIndices;
+	m_SparseValues = src.m_SparseValues;
+	// One allocation (and copy) for every buffer in the source's arena, then the layers are attached to their
+	// blocks of the copy rather than copying those buffers one by one
+	m_Arena = src.m_Arena;
+	m_Layers.clear();
+	m_Layers.reserve(src.m_Layers.size());
+	for (size_t i = 0; i < src.m_Layers.size(); ++i) {
+		const c_BasicPerceptronLayer<T> &layer = src.m_Layers[i];
+		T *arena = (layer.m_Arena != NULL) ? (m_Arena.data() + (layer.m_Arena - src.m_Arena.data())) : NULL;
+		m_Layers.push_back(c_BasicPerceptronLayer<T>(layer, arena));
+	}
+	m_ThreadPool = src.m_ThreadPool;
+	// The copied layers own their weights, so the source's mapped file (if any) is not needed; the contexts are
+	// scratch space, so are not copied
+	m_MappedFile.reset();
+	m_Contexts.clear();
+	// The copy starts with its own (disabled) profile
+	m_Profiler = c_Profiler();
 	m_Bias = src.m_Bias;
 	m_Size = src.m_Size;
+	m_SparseCount = src.m_SparseCount;
+	m_SparseInputs = src.m_SparseInputs;
+	m_ShardInputs = NULL;
+	m_ShardTargets = NULL;
+	m_ShardRows = 0;
 	m_TrainRate = src.m_TrainRate;
 	m_ActType = src.m_ActType;
-	// Connect the new layers correctly
-	_connect();
+	m_ActPrecision = src.m_ActPrecision;
+	// Point the new layers at each other, rather than at the source's layers
+	_relink();
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::_move(c_BasicNeuralNetwork &src)
+{
+	// Take over the source's layers (and the mapped file their weights may be attached to); the layers vector
+	// keeps its storage, so only the links to this network's local inputs need updating
+	m_Inputs = src.m_Inputs;
+	m_Targets = src.m_Targets;
+	m_LocalInputs = std::move(src.m_LocalInputs);
+	m_Arena = std::move(src.m_Arena);
+	m_SparseIndices = std::move(src.m_SparseIndices);
+	m_SparseValues = std::move(src.m_SparseValues);
+	m_Layers = std::move(src.m_Layers);
+	m_ThreadPool = std::move(src.m_ThreadPool);
+	m_MappedFile = std::move(src.m_MappedFile);
+	m_Contexts = std::move(src.m_Contexts);
+	m_Profiler = std::move(src.m_Profiler);
+	m_Bias = src.m_Bias;
+	m_Size = src.m_Size;
+	m_SparseCount = src.m_SparseCount;
+	m_SparseInputs = src.m_SparseInputs;
+	m_ShardInputs = NULL;
+	m_ShardTargets = NULL;
+	m_ShardRows = 0;
+	m_TrainRate = src.m_TrainRate;
+	m_ActType = src.m_ActType;
+	m_ActPrecision = src.m_ActPrecision;
+	// Leave the source as an empty network
+	src.m_Inputs = NULL;
+	src.m_Targets = NULL;
+	src.m_Size = 0;
+	src.m_SparseCount = 0;
+	src.m_SparseInputs = false;
+	_relink();
 }
 
-void c_NeuralNetwork::_build(const std::vector<size_t> &layers)
+template <typename T>
+void c_BasicNeuralNetwork<T>::_build(const std::vector<size_t> &layers, T *const *weights)
 {
 	// Build a single-layer or multi-layer neural network
 	// Reserve the layers vector size
@@ -173,11 +880,62 @@ void c_NeuralNetwork::_build(const std::vector<size_t> &layers)
 		// For each required layer, push back a blank layer of the required size
 		m_Layers.push_back(layers[i]);
 	}
+	// Apply the bias state to all but the last layer, so the whole topology is known before anything is sized
+	for (size_t i = 0; i < m_Size; ++i) {
+		m_Layers[i].setBias(((i + 1) < m_Size) ? m_Bias : false);
+	}
+	_resizeLocalInputs();
+	// Size every layer's buffers at once in the arena (with the weights attached to external memory, if given),
+	// so connecting the layers then finds them the right size and allocates nothing
+	_buildArena(weights);
 	// Connect the layers
 	_connect();
 }
 
-void c_NeuralNetwork::_connect()
+template <typename T>
+void c_BasicNeuralNetwork<T>::_buildArena(T *const *weights)
+{
+	// Lay out the buffers sized by the topology alone (weights, weighted deltas, sums, deltas and chunk sums) of
+	// every layer in one aligned, zeroed allocation: a network is then built, copied and destroyed with a single
+	// allocation for all of them, whatever its depth. Buffers already that size keep their contents, so this also
+	// repacks the arena after the topology changes. Batch buffers (sized by the batch), gradients and optimizer
+	// state (only with an optimizer) and prune masks are allocated separately when first needed
+	size_t size = 0;
+	size_t inputSize = m_LocalInputs.size();
+	for (size_t i = 0; i < m_Size; ++i) {
+		c_BasicPerceptronLayer<T> &layer = m_Layers[i];
+		layer._setInputSize(inputSize);
+		if (weights != NULL) {
+			layer.attachWeights(weights[i]);
+		}
+		size += layer._getArenaSize((i > 0) ? m_Layers[i - 1].getSize() : 0);
+		inputSize = layer.getOutputs().size();
+	}
+	c_AlignedBuffer<T> arena;
+	arena.resize(size);
+	T *next = arena.data();
+	for (size_t i = 0; i < m_Size; ++i) {
+		m_Layers[i]._attachArena(next, (i > 0) ? m_Layers[i - 1].getSize() : 0);
+		next += m_Layers[i].m_ArenaSize;
+	}
+	// Release the previous arena, now no layer refers to it
+	m_Arena = std::move(arena);
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::_updateArena()
+{
+	// Repack the arena if a change of topology moved any layer's buffers out of it
+	for (size_t i = 0; i < m_Size; ++i) {
+		if (!m_Layers[i]._isInArena()) {
+			_buildArena();
+			return;
+		}
+	}
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::_connect()
 {
 	// Connect the layers correctly
 	_connectInputs();
@@ -185,17 +943,38 @@ void c_NeuralNetwork::_connect()
 	_connectLayers();
 }
 
-void c_NeuralNetwork::_connectInputs()
+template <typename T>
+void c_BasicNeuralNetwork<T>::_relink()
+{
+	// Point each layer at its neighbours in this network's own layers, and the first and last layers at this
+	// network's inputs and targets. This is one step per layer (no layer is rebuilt and no perceptron is visited),
+	// as a copied or moved network already has the right sizes
+	for (size_t i = 0; i < m_Layers.size(); ++i) {
+		m_Layers[i]._link((i > 0) ? &m_Layers[i - 1] : NULL, ((i + 1) < m_Layers.size()) ? &m_Layers[i + 1] : NULL);
+	}
+	_connectInputs();
+	_connectTargets();
+}
+
+template <typename T>
+void c_BasicNeuralNetwork<T>::_connectInputs()
 {
 	if (m_Layers.size() > 0) {
-		// Connect the inputs to the first layer
+		// Connect the inputs to the first layer, whose last input is the network's bias node (if enabled)
 		if (m_Inputs != NULL) {
 			m_Layers[0].setInputs(m_LocalInputs);
 		}
+		m_Layers[0]._setInputBias(m_Bias);
+		if (m_SparseInputs) {
+			m_Layers[0].setSparseInputs(m_SparseIndices.data(), m_SparseValues.data(), m_SparseCount);
+		} else {
+			m_Layers[0].setSparseInputs(NULL, NULL, 0);
+		}
 	}
 }
 
-void c_NeuralNetwork::_connectTargets()
+template <typename T>
+void c_BasicNeuralNetwork<T>::_connectTargets()
 {
 	if (m_Layers.size() > 0) {
 		// Connect the targets to the last layer
@@ -205,7 +984,8 @@ void c_NeuralNetwork::_connectTargets()
 	}
 }
 
-void c_NeuralNetwork::_connectLayers()
+template <typename T>
+void c_BasicNeuralNetwork<T>::_connectLayers()
 {
 	if (m_Layers.size() > 1) {
 		// Connect the layers for all layers after the first
@@ -215,5 +995,15 @@ void c_NeuralNetwork::_connectLayers()
 	}
 }
 
+template <typename T>
+void c_BasicNeuralNetwork<T>::_connectThreadPool()
+{
+	// Share the network's thread pool (if any) with every layer
+	for (size_t i = 0; i < m_Layers.size(); ++i) {
+		m_Layers[i].setThreadPool(m_ThreadPool.get());
+	}
+}
 
-
+// Explicit instantiations
+template class c_BasicNeuralNetwork<float>;
+template class c_BasicNeuralNetwork<double>;
@@ -27,51 +27,117 @@
 #ifndef NEURALNETWORK_H_
 #define NEURALNETWORK_H_
 
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <valarray>
 #include <vector>
 
+#include "ExecContext.h"
+#include "MappedFile.h"
 #include "PerceptronLayer.h"
+#include "Profiler.h"
 
-class c_NeuralNetwork {
+template <typename T>
+class c_BasicNeuralNetwork {
 public:
 	// Constructors
-									c_NeuralNetwork(const std::valarray<double> &inputs, const std::valarray<double> &targets, const std::vector<size_t> &layers, const e_Activation &actType, const double &trainRate, const bool &bias);
-									c_NeuralNetwork(const c_NeuralNetwork &src);
+									c_BasicNeuralNetwork(const std::valarray<T> &inputs, const std::valarray<T> &targets, const std::vector<size_t> &layers, const e_Activation &actType, const T &trainRate, const bool &bias);
+									c_BasicNeuralNetwork(const c_BasicNeuralNetwork &src);
+									c_BasicNeuralNetwork(c_BasicNeuralNetwork &&src) noexcept;
 	// Destructor
-	virtual							~c_NeuralNetwork();
+	virtual							~c_BasicNeuralNetwork();
+	// Operators
+	c_BasicNeuralNetwork&			operator=(const c_BasicNeuralNetwork &src);
+	c_BasicNeuralNetwork&			operator=(c_BasicNeuralNetwork &&src) noexcept;
 	// Set
-	void							setInputs(const std::valarray<double> &inputs);
-	void							setTargets(const std::valarray<double> &targets);
-	void							setTrainRate(const double &trainRate);
+	void							setInputs(const std::valarray<T> &inputs);
+	bool							setSparseInputs(const uint32_t *indices, const T *values, const size_t &count);
+	void							setTargets(const std::valarray<T> &targets);
+	void							setTrainRate(const T &trainRate);
 	void							setActivation(const e_Activation &actType);
+	void							setActPrecision(const e_ActPrecision &actPrecision);
 	void							setBias(const bool &bias);
+	void							setThreads(const size_t &numThreads);
+	void							setOptimizer(const c_BasicOptimizer<T> &optimizer);
+	void							setProfiling(const bool &profiling);
 	// Get
-	c_PerceptronLayer&				operator[](const size_t &idx);
-	const size_t					getSize();
-	const std::valarray<double>&	getOutputs();
+	c_BasicPerceptronLayer<T>&		operator[](const size_t &idx);
+	const c_BasicPerceptronLayer<T>&	operator[](const size_t &idx) const;
+	const size_t					getSize() const;
+	const size_t					getNumInputs() const;
+	const e_Activation				getActivation();
+	const e_ActPrecision			getActPrecision();
+	const size_t					getThreads();
+	const std::valarray<T>&			getOutputs();
+	const bool						getProfiling();
+	const size_t					getNumWeights();
+	const size_t					getNumPruned();
+	s_ProfileCounters				getProfile(const size_t &layer, const e_ProfilePhase &phase);
 	// Functions
 	void							evaluate();
 	void							train();
+	T								step();
+	void							evaluateBatch(const T *inputs, const size_t &rows, T *outputs);
+	void							trainBatch(const T *inputs, const T *targets, const size_t &rows);
+	void							evaluate(const T *inputs, c_BasicExecContext<T> &context) const;
+	void							infer(const T *inputs, T *outputs, c_BasicExecContext<T> &context) const;
+	void							accumulate(const T *inputs, const T *targets, c_BasicExecContext<T> &context);
+	void							applyGradients(c_BasicExecContext<T> *contexts, const size_t &numContexts);
+	void							trainParallel(const T *inputs, const T *targets, const size_t &rows);
+	bool							save(const std::string &filename);
+	bool							load(const std::string &filename);
+	bool							loadMapped(const std::string &filename);
+	size_t							prune(const T &threshold);
+	size_t							pruneFraction(const T &fraction);
+	void							clearPruneMask();
+	void							initWeights(const c_BasicInitializer<T> &initializer);
+	void							clearProfile();
+	bool							saveProfileTrace(const std::string &filename);
 private:
 	// Functions
+	void							_evaluateBatch(const T *inputs, const size_t &rows);
+	void							_trainShard(const size_t &shard);
+	bool							_load(unsigned char *data, const size_t &size, const bool &attach);
 	void							_updateLocalInputs();
 	void							_resizeLocalInputs();
-	void							_copy(const c_NeuralNetwork &src);
-	void							_build(const std::vector<size_t> &layers);
+	void							_copy(const c_BasicNeuralNetwork &src);
+	void							_move(c_BasicNeuralNetwork &src);
+	void							_build(const std::vector<size_t> &layers, T *const *weights = NULL);
+	void							_buildArena(T *const *weights = NULL);
+	void							_updateArena();
 	void							_connect();
+	void							_relink();
 	void							_connectInputs();
 	void							_connectTargets();
 	void							_connectLayers();
+	void							_connectThreadPool();
 	// Variables
-	const std::valarray<double>		*m_Inputs;
-	const std::valarray<double>		*m_Targets;
-	std::valarray<double>			m_LocalInputs;
-	std::vector<c_PerceptronLayer>	m_Layers;
+	const std::valarray<T>			*m_Inputs;
+	const std::valarray<T>			*m_Targets;
+	std::valarray<T>				m_LocalInputs;
+	c_AlignedBuffer<T>				m_Arena;
+	c_AlignedBuffer<uint32_t>		m_SparseIndices;
+	c_AlignedBuffer<T>				m_SparseValues;
+	std::vector<c_BasicPerceptronLayer<T>>	m_Layers;
+	std::shared_ptr<c_ThreadPool>	m_ThreadPool;
+	std::shared_ptr<c_MappedFile>	m_MappedFile;
+	std::vector<c_BasicExecContext<T>>	m_Contexts;
+	c_Profiler						m_Profiler;
 	bool							m_Bias;
 	size_t							m_Size;
-	double							m_TrainRate;
+	size_t							m_SparseCount;
+	bool							m_SparseInputs;
+	const T							*m_ShardInputs;
+	const T							*m_ShardTargets;
+	size_t							m_ShardRows;
+	T								m_TrainRate;
 	e_Activation					m_ActType;
+	e_ActPrecision					m_ActPrecision;
 };
 
+typedef c_BasicNeuralNetwork<double>	c_NeuralNetwork;
+typedef c_BasicNeuralNetwork<float>		c_NeuralNetworkF;
+
 #endif NEURALNETWORK_H_
 
@@ -0,0 +1,257 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Optimizer
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+
+#include "Kernels.h"
+#include "Optimizer.h"
+
+template <typename T>
+c_BasicOptimizer<T>::c_BasicOptimizer()
+{
+}
+
+template <typename T>
+c_BasicOptimizer<T>::~c_BasicOptimizer()
+{
+}
+
+template <typename T>
+void c_BasicOptimizer<T>::resize(const size_t &/*size*/)
+{
+	// Stateless by default
+}
+
+template <typename T>
+void c_BasicOptimizer<T>::step()
+{
+	// Called once per training step (before that step's updates); nothing to do by default
+}
+
+template <typename T>
+void c_BasicOptimizer<T>::updateSparse(const T &rate, const size_t &offset, const uint32_t *indices, const T *gradients, T *weights, const size_t &n)
+{
+	// One weight at a time by default
+	for (size_t i = 0; i < n; ++i) {
+		update(rate, offset + indices[i], &gradients[i], &weights[indices[i]], 1);
+	}
+}
+
+template <typename T>
+c_BasicSgdOptimizer<T>::c_BasicSgdOptimizer()
+{
+}
+
+template <typename T>
+c_BasicOptimizer<T>* c_BasicSgdOptimizer<T>::clone() const
+{
+	return new c_BasicSgdOptimizer<T>(*this);
+}
+
+template <typename T>
+void c_BasicSgdOptimizer<T>::update(const T &rate, const size_t &/*offset*/, const T *gradients, T *weights, const size_t &n)
+{
+	kernelAxpy(rate, gradients, weights, n);
+}
+
+template <typename T>
+void c_BasicSgdOptimizer<T>::updateSparse(const T &rate, const size_t &/*offset*/, const uint32_t *indices, const T *gradients, T *weights, const size_t &n)
+{
+	kernelAxpySparse(rate, indices, gradients, weights, n);
+}
+
+template <typename T>
+c_BasicMomentumOptimizer<T>::c_BasicMomentumOptimizer(const T &momentum, const bool &nesterov) :
+	m_Momentum(momentum),
+	m_Nesterov(nesterov)
+{
+}
+
+template <typename T>
+void c_BasicMomentumOptimizer<T>::resize(const size_t &size)
+{
+	m_Velocity.resize(size);
+}
+
+template <typename T>
+c_BasicOptimizer<T>* c_BasicMomentumOptimizer<T>::clone() const
+{
+	return new c_BasicMomentumOptimizer<T>(*this);
+}
+
+template <typename T>
+void c_BasicMomentumOptimizer<T>::update(const T &rate, const size_t &offset, const T *gradients, T *weights, const size_t &n)
+{
+	T *velocity = &m_Velocity[offset];
+	// Update the velocity, then step along it (Nesterov steps from the look-ahead position instead)
+	kernelScale(m_Momentum, velocity, velocity, n);
+	kernelAxpy(static_cast<T>(1.0), gradients, velocity, n);
+	if (m_Nesterov) {
+		kernelAxpy(rate, gradients, weights, n);
+		kernelAxpy(rate * m_Momentum, velocity, weights, n);
+	} else {
+		kernelAxpy(rate, velocity, weights, n);
+	}
+}
+
+template <typename T>
+void c_BasicMomentumOptimizer<T>::updateSparse(const T &rate, const size_t &offset, const uint32_t *indices, const T *gradients, T *weights, const size_t &n)
+{
+	T *velocity = &m_Velocity[offset];
+	for (size_t i = 0; i < n; ++i) {
+		const size_t j = indices[i];
+		velocity[j] = (m_Momentum * velocity[j]) + gradients[i];
+		if (m_Nesterov) {
+			weights[j] += (rate * gradients[i]) + (rate * m_Momentum * velocity[j]);
+		} else {
+			weights[j] += rate * velocity[j];
+		}
+	}
+}
+
+template <typename T>
+c_BasicRmsPropOptimizer<T>::c_BasicRmsPropOptimizer(const T &decay, const T &epsilon) :
+	m_Decay(decay),
+	m_Epsilon(epsilon)
+{
+}
+
+template <typename T>
+void c_BasicRmsPropOptimizer<T>::resize(const size_t &size)
+{
+	m_MeanSquare.resize(size);
+}
+
+template <typename T>
+c_BasicOptimizer<T>* c_BasicRmsPropOptimizer<T>::clone() const
+{
+	return new c_BasicRmsPropOptimizer<T>(*this);
+}
+
+template <typename T>
+void c_BasicRmsPropOptimizer<T>::update(const T &rate, const size_t &offset, const T *gradients, T *weights, const size_t &n)
+{
+	T *meanSquare = &m_MeanSquare[offset];
+	const T one = static_cast<T>(1.0);
+	for (size_t i = 0; i < n; ++i) {
+		meanSquare[i] = (m_Decay * meanSquare[i]) + ((one - m_Decay) * gradients[i] * gradients[i]);
+		weights[i] += rate * gradients[i] / (std::sqrt(meanSquare[i]) + m_Epsilon);
+	}
+}
+
+template <typename T>
+void c_BasicRmsPropOptimizer<T>::updateSparse(const T &rate, const size_t &offset, const uint32_t *indices, const T *gradients, T *weights, const size_t &n)
+{
+	T *meanSquare = &m_MeanSquare[offset];
+	const T one = static_cast<T>(1.0);
+	for (size_t i = 0; i < n; ++i) {
+		const size_t j = indices[i];
+		meanSquare[j] = (m_Decay * meanSquare[j]) + ((one - m_Decay) * gradients[i] * gradients[i]);
+		weights[j] += rate * gradients[i] / (std::sqrt(meanSquare[j]) + m_Epsilon);
+	}
+}
+
+template <typename T>
+c_BasicAdamOptimizer<T>::c_BasicAdamOptimizer(const T &beta1, const T &beta2, const T &epsilon) :
+	m_Beta1(beta1),
+	m_Beta2(beta2),
+	m_Epsilon(epsilon),
+	m_Beta1Power(1.0),
+	m_Beta2Power(1.0),
+	m_RateScale(1.0),
+	m_EpsilonScale(epsilon)
+{
+}
+
+template <typename T>
+void c_BasicAdamOptimizer<T>::resize(const size_t &size)
+{
+	// New state, so restart the bias correction
+	m_Mean.resize(size);
+	m_Variance.resize(size);
+	m_Beta1Power = 1.0;
+	m_Beta2Power = 1.0;
+}
+
+template <typename T>
+c_BasicOptimizer<T>* c_BasicAdamOptimizer<T>::clone() const
+{
+	return new c_BasicAdamOptimizer<T>(*this);
+}
+
+template <typename T>
+void c_BasicAdamOptimizer<T>::step()
+{
+	// Fold the bias corrections of this step into the rate and epsilon, so update() is a single pass:
+	// rate * (m / (1 - b1^t)) / (sqrt(v / (1 - b2^t)) + e) == (rate * sqrt(1 - b2^t) / (1 - b1^t)) * m / (sqrt(v) + e * sqrt(1 - b2^t))
+	const T one = static_cast<T>(1.0);
+	m_Beta1Power *= m_Beta1;
+	m_Beta2Power *= m_Beta2;
+	const T root = std::sqrt(one - m_Beta2Power);
+	m_RateScale = root / (one - m_Beta1Power);
+	m_EpsilonScale = m_Epsilon * root;
+}
+
+template <typename T>
+void c_BasicAdamOptimizer<T>::update(const T &rate, const size_t &offset, const T *gradients, T *weights, const size_t &n)
+{
+	T *mean = &m_Mean[offset];
+	T *variance = &m_Variance[offset];
+	const T one = static_cast<T>(1.0);
+	const T scaledRate = rate * m_RateScale;
+	for (size_t i = 0; i < n; ++i) {
+		mean[i] = (m_Beta1 * mean[i]) + ((one - m_Beta1) * gradients[i]);
+		variance[i] = (m_Beta2 * variance[i]) + ((one - m_Beta2) * gradients[i] * gradients[i]);
+		weights[i] += scaledRate * mean[i] / (std::sqrt(variance[i]) + m_EpsilonScale);
+	}
+}
+
+template <typename T>
+void c_BasicAdamOptimizer<T>::updateSparse(const T &rate, const size_t &offset, const uint32_t *indices, const T *gradients, T *weights, const size_t &n)
+{
+	T *mean = &m_Mean[offset];
+	T *variance = &m_Variance[offset];
+	const T one = static_cast<T>(1.0);
+	const T scaledRate = rate * m_RateScale;
+	for (size_t i = 0; i < n; ++i) {
+		const size_t j = indices[i];
+		mean[j] = (m_Beta1 * mean[j]) + ((one - m_Beta1) * gradients[i]);
+		variance[j] = (m_Beta2 * variance[j]) + ((one - m_Beta2) * gradients[i] * gradients[i]);
+		weights[j] += scaledRate * mean[j] / (std::sqrt(variance[j]) + m_EpsilonScale);
+	}
+}
+
+// Explicit instantiations
+template class c_BasicOptimizer<float>;
+template class c_BasicOptimizer<double>;
+template class c_BasicSgdOptimizer<float>;
+template class c_BasicSgdOptimizer<double>;
+template class c_BasicMomentumOptimizer<float>;
+template class c_BasicMomentumOptimizer<double>;
+template class c_BasicRmsPropOptimizer<float>;
+template class c_BasicRmsPropOptimizer<double>;
+template class c_BasicAdamOptimizer<float>;
+template class c_BasicAdamOptimizer<double>;
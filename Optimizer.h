@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Optimizer
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef OPTIMIZER_H_
+#define OPTIMIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "AlignedBuffer.h"
+
+// Weight update rule applied by a perceptron layer. Each layer owns its own optimizer, whose state is held in
+// contiguous buffers laid out exactly as the layer's weights matrix (so rows are found by the same offsets).
+// updateSparse updates only the weights at the given indices (from offset), e.g. those of the nonzero sparse inputs,
+// leaving the state of the others as it is.
+// Gradients are given in the direction of the weight change (the negated gradient of the loss), as the deltas are
+template <typename T>
+class c_BasicOptimizer {
+public:
+	// Constructors
+									c_BasicOptimizer();
+	// Destructor
+	virtual							~c_BasicOptimizer();
+	// Set
+	virtual void					resize(const size_t &size);
+	// Functions
+	virtual c_BasicOptimizer<T>*	clone() const = 0;
+	virtual void					step();
+	virtual void					update(const T &rate, const size_t &offset, const T *gradients, T *weights, const size_t &n) = 0;
+	virtual void					updateSparse(const T &rate, const size_t &offset, const uint32_t *indices, const T *gradients, T *weights, const size_t &n);
+};
+
+// Plain stochastic gradient descent: w += rate * g
+template <typename T>
+class c_BasicSgdOptimizer : public c_BasicOptimizer<T> {
+public:
+	// Constructors
+									c_BasicSgdOptimizer();
+	// Functions
+	c_BasicOptimizer<T>*			clone() const;
+	void							update(const T &rate, const size_t &offset, const T *gradients, T *weights, const size_t &n);
+	void							updateSparse(const T &rate, const size_t &offset, const uint32_t *indices, const T *gradients, T *weights, const size_t &n);
+};
+
+// Momentum (inertia): v = momentum * v + g, then w += rate * v (or w += rate * (g + momentum * v) for Nesterov)
+template <typename T>
+class c_BasicMomentumOptimizer : public c_BasicOptimizer<T> {
+public:
+	// Constructors
+									c_BasicMomentumOptimizer(const T &momentum = 0.9, const bool &nesterov = false);
+	// Set
+	void							resize(const size_t &size);
+	// Functions
+	c_BasicOptimizer<T>*			clone() const;
+	void							update(const T &rate, const size_t &offset, const T *gradients, T *weights, const size_t &n);
+	void							updateSparse(const T &rate, const size_t &offset, const uint32_t *indices, const T *gradients, T *weights, const size_t &n);
+private:
+	// Variables
+	c_AlignedBuffer<T>				m_Velocity;
+	T								m_Momentum;
+	bool							m_Nesterov;
+};
+
+// RMSProp (adaptive learning rate): s = decay * s + (1 - decay) * g^2, then w += rate * g / (sqrt(s) + epsilon)
+template <typename T>
+class c_BasicRmsPropOptimizer : public c_BasicOptimizer<T> {
+public:
+	// Constructors
+									c_BasicRmsPropOptimizer(const T &decay = 0.9, const T &epsilon = 1e-8);
+	// Set
+	void							resize(const size_t &size);
+	// Functions
+	c_BasicOptimizer<T>*			clone() const;
+	void							update(const T &rate, const size_t &offset, const T *gradients, T *weights, const size_t &n);
+	void							updateSparse(const T &rate, const size_t &offset, const uint32_t *indices, const T *gradients, T *weights, const size_t &n);
+private:
+	// Variables
+	c_AlignedBuffer<T>				m_MeanSquare;
+	T								m_Decay;
+	T								m_Epsilon;
+};
+
+// Adam: bias corrected running means of g and g^2, then w += rate * m / (sqrt(v) + epsilon)
+template <typename T>
+class c_BasicAdamOptimizer : public c_BasicOptimizer<T> {
+public:
+	// Constructors
+									c_BasicAdamOptimizer(const T &beta1 = 0.9, const T &beta2 = 0.999, const T &epsilon = 1e-8);
+	// Set
+	void							resize(const size_t &size);
+	// Functions
+	c_BasicOptimizer<T>*			clone() const;
+	void							step();
+	void							update(const T &rate, const size_t &offset, const T *gradients, T *weights, const size_t &n);
+	void							updateSparse(const T &rate, const size_t &offset, const uint32_t *indices, const T *gradients, T *weights, const size_t &n);
+private:
+	// Variables
+	c_AlignedBuffer<T>				m_Mean;
+	c_AlignedBuffer<T>				m_Variance;
+	T								m_Beta1;
+	T								m_Beta2;
+	T								m_Epsilon;
+	T								m_Beta1Power;
+	T								m_Beta2Power;
+	T								m_RateScale;
+	T								m_EpsilonScale;
+};
+
+typedef c_BasicSgdOptimizer<double>			c_SgdOptimizer;
+typedef c_BasicSgdOptimizer<float>			c_SgdOptimizerF;
+typedef c_BasicMomentumOptimizer<double>	c_MomentumOptimizer;
+typedef c_BasicMomentumOptimizer<float>		c_MomentumOptimizerF;
+typedef c_BasicRmsPropOptimizer<double>		c_RmsPropOptimizer;
+typedef c_BasicRmsPropOptimizer<float>		c_RmsPropOptimizerF;
+typedef c_BasicAdamOptimizer<double>		c_AdamOptimizer;
+typedef c_BasicAdamOptimizer<float>			c_AdamOptimizerF;
+
+#endif OPTIMIZER_H_
@@ -24,110 +24,164 @@
 //
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <cmath>
 #include <cstdlib>
 #include <limits>
 
+#include "Kernels.h"
 #include "Perceptron.h"
 
-c_Perceptron::c_Perceptron() :
+template <typename T>
+c_BasicPerceptron<T>::c_BasicPerceptron() :
 	m_Inputs(NULL),
+	m_Weights(NULL),
+	m_WeightedDeltas(NULL),
+	m_Size(0),
 	m_Target(NULL),
 	m_WeightedDeltaSum(NULL),
-	m_SumProducts(0.0),
-	m_Output(0.0),
-	m_Delta(0.0),
+	m_SumProducts(NULL),
+	m_Output(NULL),
+	m_Delta(NULL),
 	m_TrainRate(0.0),
-	m_ActType(ACT_TANH)
+	m_ActType(ACT_TANH),
+	m_ActPrecision(ACTP_EXACT)
 {
 }
 
-c_Perceptron::c_Perceptron(const c_Perceptron &src)
+template <typename T>
+c_BasicPerceptron<T>::c_BasicPerceptron(const c_BasicPerceptron &src)
 {
 	_copy(src);
 }
 
-c_Perceptron::~c_Perceptron()
+template <typename T>
+c_BasicPerceptron<T>::c_BasicPerceptron(c_BasicPerceptron &&src) noexcept
 {
+	// A perceptron only views its layer's storage, so moving is the same as copying
+	_copy(src);
+}
+
+template <typename T>
+c_BasicPerceptron<T>::~c_BasicPerceptron()
+{
+}
+
+template <typename T>
+c_BasicPerceptron<T>& c_BasicPerceptron<T>::operator=(const c_BasicPerceptron &src)
+{
+	if (this != &src) {
+		_copy(src);
+	}
+	return *this;
 }
 
-void c_Perceptron::setWeights()
+template <typename T>
+c_BasicPerceptron<T>& c_BasicPerceptron<T>::operator=(c_BasicPerceptron &&src) noexcept
+{
+	if (this != &src) {
+		_copy(src);
+	}
+	return *this;
+}
+
+template <typename T>
+void c_BasicPerceptron<T>::setWeights()
 {
 	// Randomly seed the weights
-	for (size_t i = 0; i < m_Weights.size(); ++i) {
-		m_Weights[i] = static_cast<double>(rand()) / RAND_MAX;
+	for (size_t i = 0; i < m_Size; ++i) {
+		m_Weights[i] = static_cast<T>(rand()) / RAND_MAX;
 	}
 }
 
-void c_Perceptron::setWeights(const std::valarray<double> &weights)
+template <typename T>
+void c_BasicPerceptron<T>::setWeights(const std::valarray<T> &weights)
 {
-	if ((m_Inputs != NULL) && (weights.size() != m_Inputs->size())) {
-		// Weights do not match the size of the input array, so set the first N values of the weights array
-		m_Weights[std::slice(0, weights.size(), 1)] = weights;
-	} else {
-		m_Weights = weights;
+	// Weights may not match the size of the weights row, so set (at most) the first N values of the row
+	const size_t size = (weights.size() < m_Size) ? weights.size() : m_Size;
+	for (size_t i = 0; i < size; ++i) {
+		m_Weights[i] = weights[i];
 	}
 }
 
-void c_Perceptron::setInputs(const std::valarray<double> &inputs)
+template <typename T>
+void c_BasicPerceptron<T>::setInputs(const std::valarray<T> &inputs)
 {
+	// The weights row is owned (and sized) by the layer, so only the inputs are connected here
 	m_Inputs = &inputs;
-	if (m_Weights.size() != inputs.size()) {
-		// Weights do not match the size of the input array, so resize accordingly
-		m_Weights.resize(inputs.size());
-		m_WeightedDeltas.resize(inputs.size());
-	}
 }
 
-void c_Perceptron::setWeightedDeltaSum(const double &weightedDeltaSum)
+template <typename T>
+void c_BasicPerceptron<T>::setWeightedDeltaSum(const T &weightedDeltaSum)
 {
 	m_WeightedDeltaSum = &weightedDeltaSum;
 	// Clear the Target
 	m_Target = NULL;
 }
 
-void c_Perceptron::setTarget(const double &target)
+template <typename T>
+void c_BasicPerceptron<T>::setTarget(const T &target)
 {
 	m_Target = &target;
 	// Clear the Weighted Delta Sum
 	m_WeightedDeltaSum = NULL;
 }
 
-void c_Perceptron::setTrainRate(const double &trainRate)
+template <typename T>
+void c_BasicPerceptron<T>::setTrainRate(const T &trainRate)
 {
 	m_TrainRate = trainRate;
 }
 
-void c_Perceptron::setActivation(const e_Activation &actType)
+template <typename T>
+void c_BasicPerceptron<T>::setActivation(const e_Activation &actType)
 {
 	m_ActType = actType;
 }
 
-double& c_Perceptron::operator[](const size_t &idx)
+template <typename T>
+void c_BasicPerceptron<T>::setActPrecision(const e_ActPrecision &actPrecision)
+{
+	m_ActPrecision = actPrecision;
+}
+
+template <typename T>
+T& c_BasicPerceptron<T>::operator[](const size_t &idx)
 {
 	return m_Weights[idx];
 }
 
-const size_t c_Perceptron::getSize()
+template <typename T>
+const size_t c_BasicPerceptron<T>::getSize()
+{
+	return m_Size;
+}
+
+template <typename T>
+const T& c_BasicPerceptron<T>::getOutput()
 {
-	return m_Weights.size();
+	return *m_Output;
 }
 
-const double& c_Perceptron::getOutput()
+template <typename T>
+const T& c_BasicPerceptron<T>::getDelta()
 {
-	return m_Output;
+	return *m_Delta;
 }
 
-const std::valarray<double>& c_Perceptron::getWeights()
+template <typename T>
+std::valarray<T> c_BasicPerceptron<T>::getWeights()
 {
-	return m_Weights;
+	return std::valarray<T>(m_Weights, m_Size);
 }
 
-const std::valarray<double>& c_Perceptron::getWeightedDeltas()
+template <typename T>
+std::valarray<T> c_BasicPerceptron<T>::getWeightedDeltas()
 {
-	return m_WeightedDeltas;
+	return std::valarray<T>(m_WeightedDeltas, m_Size);
 }
 
-bool c_Perceptron::evaluate()
+template <typename T>
+bool c_BasicPerceptron<T>::evaluate()
 {
 	// Evaluate the perceptron response
 	if (_calcSumProducts()) {
@@ -137,20 +191,39 @@ bool c_Perceptron::evaluate()
 	return false;
 }
 
-bool c_Perceptron::train()
+template <typename T>
+bool c_BasicPerceptron<T>::train()
 {
-	// Train the perceptron
-	_calcDelta();
-	_calcNewWeights();
-	return true;
+	// Train the perceptron (once bound to a layer)
+	if (m_Delta != NULL) {
+		_calcDelta();
+		_calcNewWeights();
+		return true;
+	}
+	return false;
 }
 
-void c_Perceptron::_copy(const c_Perceptron &src)
+template <typename T>
+void c_BasicPerceptron<T>::_bind(T *weights, T *weightedDeltas, const size_t &size, T *sumProducts, T *output, T *delta)
 {
-	// Copy member variables
+	// Point this perceptron at its row of the layer's weight and weighted delta matrices, and at its
+	// elements of the layer's sums of products, outputs and deltas
+	m_Weights = weights;
+	m_WeightedDeltas = weightedDeltas;
+	m_Size = size;
+	m_SumProducts = sumProducts;
+	m_Output = output;
+	m_Delta = delta;
+}
+
+template <typename T>
+void c_BasicPerceptron<T>::_copy(const c_BasicPerceptron &src)
+{
+	// Copy member variables (the weights rows are views, so are rebound by the owning layer)
 	m_Inputs = src.m_Inputs;
 	m_Weights = src.m_Weights;
 	m_WeightedDeltas = src.m_WeightedDeltas;
+	m_Size = src.m_Size;
 	m_Target = src.m_Target;
 	m_WeightedDeltaSum = src.m_WeightedDeltaSum;
 	m_SumProducts = src.m_SumProducts;
@@ -158,84 +231,70 @@ void c_Perceptron::_copy(const c_Perceptron &src)
 	m_Delta = src.m_Delta;
 	m_TrainRate = src.m_TrainRate;
 	m_ActType = src.m_ActType;
+	m_ActPrecision = src.m_ActPrecision;
 }
 
-bool c_Perceptron::_calcSumProducts()
+template <typename T>
+bool c_BasicPerceptron<T>::_calcSumProducts()
 {
-	if (m_Inputs != NULL) {
-		m_SumProducts = (m_Weights * (*m_Inputs)).sum();
+	if ((m_Inputs != NULL) && (m_Weights != NULL)) {
+		*m_SumProducts = kernelDot(m_Weights, &(*m_Inputs)[0], m_Size);
 		return true;
 	}
 	return false;
 }
 
-bool c_Perceptron::_calcNewWeights()
+template <typename T>
+bool c_BasicPerceptron<T>::_calcNewWeights()
 {
-	std::valarray<double> m_DeltaWeights;
-	if (m_Inputs != NULL) {
+	if ((m_Inputs != NULL) && (m_Weights != NULL)) {
 		// Delta already determined; apply it to the weights to determine the weighted Deltas
-		m_WeightedDeltas = m_Delta * m_Weights;
-		m_Weights += m_TrainRate * m_Delta * (*m_Inputs);
+		kernelScale(*m_Delta, m_Weights, m_WeightedDeltas, m_Size);
+		kernelAxpy(m_TrainRate * (*m_Delta), &(*m_Inputs)[0], m_Weights, m_Size);
 		return true;
 	}
 	return false;
 }
 
-void c_Perceptron::_calcActivation()
-{
-	// Perform activation function based on activation type
-	switch (m_ActType) {
-	case ACT_TANH:
-		// Activate using the tanh function [-1:0:1]
-		m_Output = tanh((m_SumProducts / 2.0));
-		break;
-	case ACT_SIGMOID:
-		// Activate using the sigmoid function [0:0.5:1]
-		m_Output = (1.0 / (1.0 + exp(-m_SumProducts)));
-		break;
-	default:
-		m_Output = m_SumProducts;
-		break;
-	}
+template <typename T>
+void c_BasicPerceptron<T>::_calcActivation()
+{
+	activate(m_ActType, m_ActPrecision, m_SumProducts, m_Output, 1);
 }
 
-double c_Perceptron::_calcActivDeriv()
+template <typename T>
+T c_BasicPerceptron<T>::_calcActivDeriv()
 {
-	// Calculate activation derivative function based on activation type
-	switch (m_ActType) {
-	case ACT_TANH:
-		// Calculate from derivative of the tanh function (sech^2(x))
-		return pow((2.0 * cosh(m_SumProducts) / (cosh(2.0 * m_SumProducts) + 1)), 2);
-	case ACT_SIGMOID:
-		// Calculate from derivative of the sigmoid function (e^x / (1 + e^x)^2)
-		return exp(m_SumProducts) / pow((exp(m_SumProducts) + 1.0), 2);
-	default:
-		return m_SumProducts;
-	}
+	T deriv;
+	activateDeriv(m_ActType, m_ActPrecision, m_SumProducts, m_Output, &deriv, 1);
+	return deriv;
 }
 
-void c_Perceptron::_calcDelta()
+template <typename T>
+void c_BasicPerceptron<T>::_calcDelta()
 {
 	// First calculate the derivative of activation type
-	m_Delta = _calcActivDeriv();
+	*m_Delta = _calcActivDeriv();
 	// Second calculate delta from the activation derivative multiplied by the error
 	// Check the type of delta (output layer perceptron, or backpropagation perceptron)
 	if (m_Target != NULL) {
 		// Target set, output layer perceptron
-		m_Delta *= (*m_Target) - m_Output;
+		*m_Delta *= (*m_Target) - (*m_Output);
 	} else if (m_WeightedDeltaSum != NULL) {
 		// WeightedDeltaSum set, backpropagation perceptron
-		m_Delta *= (*m_WeightedDeltaSum);
+		*m_Delta *= (*m_WeightedDeltaSum);
 	} else {
 		// No Target or Deltas set, cannot train!
-		m_Delta = 0.0;
+		*m_Delta = 0.0;
 	}
 }
 
-bool c_Perceptron::_fcmp(const double &lhs, const double &rhs)
+template <typename T>
+bool c_BasicPerceptron<T>::_fcmp(const T &lhs, const T &rhs)
 {
-	return (fabs(lhs - rhs) < std::numeric_limits<double>::epsilon());
+	return (std::fabs(lhs - rhs) < std::numeric_limits<T>::epsilon());
 }
 
-
-
+// Explicit instantiations
+template class c_BasicPerceptron<float>;
+template class c_BasicPerceptron<double>;
@@ -29,57 +29,70 @@
 
 #include <valarray>
 
-enum e_Activation {
-	ACT_TANH,
-	ACT_SIGMOID
-};
+#include "Activation.h"
+
+template <typename T>
+class c_BasicPerceptronLayer;
 
-class c_Perceptron {
+template <typename T>
+class c_BasicPerceptron {
 public:
 	// Constructors
-									c_Perceptron();
-									c_Perceptron(const c_Perceptron &src);
+									c_BasicPerceptron();
+									c_BasicPerceptron(const c_BasicPerceptron &src);
+									c_BasicPerceptron(c_BasicPerceptron &&src) noexcept;
 	// Destructor
-	virtual							~c_Perceptron();
+	virtual							~c_BasicPerceptron();
+	// Operators
+	c_BasicPerceptron&				operator=(const c_BasicPerceptron &src);
+	c_BasicPerceptron&				operator=(c_BasicPerceptron &&src) noexcept;
 	// Set
 	void							setWeights();
-	void							setWeights(const std::valarray<double> &weights);
-	void							setInputs(const std::valarray<double> &inputs);
-	void							setWeightedDeltaSum(const double &weightedDeltaSum);
-	void							setTarget(const double &target);
-	void							setTrainRate(const double &trainRate);
+	void							setWeights(const std::valarray<T> &weights);
+	void							setInputs(const std::valarray<T> &inputs);
+	void							setWeightedDeltaSum(const T &weightedDeltaSum);
+	void							setTarget(const T &target);
+	void							setTrainRate(const T &trainRate);
 	void							setActivation(const e_Activation &actType);
+	void							setActPrecision(const e_ActPrecision &actPrecision);
 	// Get
-	double&							operator[](const size_t &idx);
+	T&								operator[](const size_t &idx);
 	const size_t					getSize();
-	const double&					getOutput();
-	const double&					getDelta();
-	const std::valarray<double>&	getWeights();
-	const std::valarray<double>&	getWeightedDeltas();
+	const T&						getOutput();
+	const T&						getDelta();
+	std::valarray<T>				getWeights();
+	std::valarray<T>				getWeightedDeltas();
 	// Functions
 	bool							evaluate();
 	bool							train();
 private:
+	friend class c_BasicPerceptronLayer<T>;
 	// Functions
-	void							_copy(const c_Perceptron &src);
+	void							_bind(T *weights, T *weightedDeltas, const size_t &size, T *sumProducts, T *output, T *delta);
+	void							_copy(const c_BasicPerceptron &src);
 	bool							_calcSumProducts();
 	bool							_calcNewWeights();
 	void							_calcActivation();
-	double							_calcActivDeriv();
+	T								_calcActivDeriv();
 	void							_calcDelta();
-	bool							_fcmp(const double &lhs, const double &rhs);
+	bool							_fcmp(const T &lhs, const T &rhs);
 	// Variables
-	const std::valarray<double>		*m_Inputs;
-	std::valarray<double>			m_Weights;
-	std::valarray<double>			m_WeightedDeltas;
-	const double					*m_Target;
-	const double					*m_WeightedDeltaSum;
-	double							m_SumProducts;
-	double							m_Output;
-	double							m_Delta;
-	double							m_TrainRate;
+	const std::valarray<T>			*m_Inputs;
+	T								*m_Weights;
+	T								*m_WeightedDeltas;
+	size_t							m_Size;
+	const T							*m_Target;
+	const T							*m_WeightedDeltaSum;
+	T								*m_SumProducts;
+	T								*m_Output;
+	T								*m_Delta;
+	T								m_TrainRate;
 	e_Activation					m_ActType;
+	e_ActPrecision					m_ActPrecision;
 };
 
+typedef c_BasicPerceptron<double>	c_Perceptron;
+typedef c_BasicPerceptron<float>	c_PerceptronF;
+
 #endif PERCEPTRON_H_
 
@@ -24,155 +24,675 @@
 //
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "Gemm.h"
+#include "Kernels.h"
 #include "PerceptronLayer.h"
 
-c_PerceptronLayer::c_PerceptronLayer(const size_t &numPerceptrons) :
+// Target size (in bytes) of the weights processed by one parallel task, sized to sit in the L1 cache
+const size_t CHUNK_BYTES = 32768;
+// Number of batch rows processed by one parallel task when backpropagating a batch, and number of perceptrons by one
+// task when evaluating a batch or applying its weight changes. Each task is one call of the packed GEMM engine, so
+// these are large enough that packing the operand shared by every task costs little next to the product itself
+const size_t BATCH_ROW_BLOCK = 256;
+const size_t BATCH_CHUNK_SIZE = 256;
+
+template <typename T>
+c_BasicPerceptronLayer<T>::c_BasicPerceptronLayer(const size_t &numPerceptrons) :
 	m_Inputs(NULL),
 	m_Targets(NULL),
 	m_WeightedDeltaSumsIn(NULL),
+	m_SparseIndices(NULL),
+	m_SparseValues(NULL),
+	m_SparseCount(0),
 	m_Input(NULL),
 	m_Output(NULL),
+	m_Arena(NULL),
+	m_ArenaSize(0),
+	m_PerceptronsBound(false),
 	m_Bias(true),
+	m_InputBias(false),
 	m_Size(numPerceptrons),
+	m_InputSize(0),
+	m_Stride(0),
+	m_NumPruned(0),
+	m_BatchRows(0),
+	m_BatchStride(0),
+	m_BatchInputs(NULL),
+	m_BatchInputStride(0),
+	m_BatchSize(0),
+	m_Initializer(NULL),
+	m_InitStream(0),
+	m_ThreadPool(NULL),
 	m_TrainRate(0.0),
-	m_ActType(ACT_TANH)
+	m_ActType(ACT_TANH),
+	m_ActPrecision(ACTP_EXACT)
 {
 	_build();
 }
 
-c_PerceptronLayer::c_PerceptronLayer(const c_PerceptronLayer &src)
+template <typename T>
+c_BasicPerceptronLayer<T>::c_BasicPerceptronLayer(const c_BasicPerceptronLayer &src)
 {
 	_copy(src);
 }
 
-c_PerceptronLayer::~c_PerceptronLayer()
+template <typename T>
+c_BasicPerceptronLayer<T>::c_BasicPerceptronLayer(c_BasicPerceptronLayer &&src) noexcept
+{
+	_move(src);
+}
+
+template <typename T>
+c_BasicPerceptronLayer<T>::c_BasicPerceptronLayer(const c_BasicPerceptronLayer &src, T *arena)
+{
+	// Copy a layer into a network's copy of the source network's arena (see _copy)
+	_copy(src, arena);
+}
+
+template <typename T>
+c_BasicPerceptronLayer<T>::~c_BasicPerceptronLayer()
+{
+}
+
+template <typename T>
+c_BasicPerceptronLayer<T>& c_BasicPerceptronLayer<T>::operator=(const c_BasicPerceptronLayer &src)
 {
+	if (this != &src) {
+		_copy(src);
+	}
+	return *this;
 }
 
-void c_PerceptronLayer::setInput(c_PerceptronLayer &input)
+template <typename T>
+c_BasicPerceptronLayer<T>& c_BasicPerceptronLayer<T>::operator=(c_BasicPerceptronLayer &&src) noexcept
+{
+	if (this != &src) {
+		_move(src);
+	}
+	return *this;
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::setInput(c_BasicPerceptronLayer &input)
 {
 	m_Input = &input;
 	_build();
 }
 
-void c_PerceptronLayer::setInputs(const std::valarray<double> &inputs)
+template <typename T>
+void c_BasicPerceptronLayer<T>::setInputs(const std::valarray<T> &inputs)
 {
 	m_Inputs = &inputs;
 	_connectInputs();
 }
 
-void c_PerceptronLayer::setTargets(const std::valarray<double> &targets)
+template <typename T>
+void c_BasicPerceptronLayer<T>::setSparseInputs(const uint32_t *indices, const T *values, const size_t &count)
+{
+	// Read the inputs as (index, value) pairs, the indices (which must be distinct and below the input size) of the
+	// nonzero inputs only, so evaluating and training touch only those weights columns. The pairs are not copied,
+	// and NULL indices return to the dense inputs
+	m_SparseIndices = indices;
+	m_SparseValues = (indices != NULL) ? values : NULL;
+	m_SparseCount = (indices != NULL) ? count : 0;
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::setTargets(const std::valarray<T> &targets)
 {
 	if (targets.size() == m_Size) {
 		m_Targets = &targets;
 		// Clear the Weighted Delta Sums
 		m_WeightedDeltaSumsIn = NULL;
-		_connectTargets();
+		m_PerceptronsBound = false;
 	}
 }
 
-void c_PerceptronLayer::setTrainRate(const double &trainRate)
+template <typename T>
+void c_BasicPerceptronLayer<T>::setTrainRate(const T &trainRate)
 {
 	m_TrainRate = trainRate;
-	// Apply the new training rate to all perceptrons in the layer
-	for (size_t i = 0; i < m_Size; ++i) {
-		m_Perceptrons[i].setTrainRate(trainRate);
-	}
+	m_PerceptronsBound = false;
 }
 
-void c_PerceptronLayer::setActivation(const e_Activation &actType)
+template <typename T>
+void c_BasicPerceptronLayer<T>::setActivation(const e_Activation &actType)
 {
 	m_ActType = actType;
-	// Apply the new activation type to all perceptrons in the layer
-	for (size_t i = 0; i < m_Size; ++i) {
-		m_Perceptrons[i].setActivation(actType);
-	}
+	m_PerceptronsBound = false;
 }
 
-void c_PerceptronLayer::setBias(const bool &bias)
+template <typename T>
+void c_BasicPerceptronLayer<T>::setActPrecision(const e_ActPrecision &actPrecision)
+{
+	m_ActPrecision = actPrecision;
+	m_PerceptronsBound = false;
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::setBias(const bool &bias)
 {
 	m_Bias = bias;
 	_build();
 }
 
-c_Perceptron& c_PerceptronLayer::operator[](const size_t &idx)
+template <typename T>
+void c_BasicPerceptronLayer<T>::setThreadPool(c_ThreadPool *threadPool)
+{
+	// Setting a thread pool enables parallel evaluation and training (NULL to run serially)
+	m_ThreadPool = threadPool;
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::setOptimizer(const c_BasicOptimizer<T> &optimizer)
+{
+	// The layer keeps its own copy of the optimizer (with its own state); without one, plain SGD is applied directly
+	m_Optimizer.reset(optimizer.clone());
+	_resizeOptimizer();
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::attachWeights(T *weights)
+{
+	// Use external storage (getSize() rows of getStride() elements) as the weights matrix, rather than a copy
+	m_Weights.attach(weights, m_Size * m_Stride);
+	m_PerceptronsBound = false;
+}
+
+template <typename T>
+c_BasicPerceptron<T>& c_BasicPerceptronLayer<T>::operator[](const size_t &idx)
 {
+	_bindPerceptrons();
 	return m_Perceptrons[idx];
 }
 
-const size_t c_PerceptronLayer::getSize()
+template <typename T>
+const size_t c_BasicPerceptronLayer<T>::getSize() const
 {
 	return m_Size;
 }
 
-const std::valarray<double>& c_PerceptronLayer::getOutputs()
+template <typename T>
+const size_t c_BasicPerceptronLayer<T>::getInputSize() const
+{
+	return m_InputSize;
+}
+
+template <typename T>
+const size_t c_BasicPerceptronLayer<T>::getStride() const
+{
+	return m_Stride;
+}
+
+template <typename T>
+T* c_BasicPerceptronLayer<T>::getWeights()
+{
+	// Row-major weight matrix; row i (of getInputSize() weights) starts at i * getStride()
+	return m_Weights.data();
+}
+
+template <typename T>
+const std::valarray<T>& c_BasicPerceptronLayer<T>::getOutputs() const
 {
 	return m_Outputs;
 }
 
-const std::valarray<double>& c_PerceptronLayer::getWeightedDeltaSumsOut()
+template <typename T>
+const std::valarray<T>& c_BasicPerceptronLayer<T>::getWeightedDeltaSumsOut()
 {
 	return m_WeightedDeltaSumsOut;
 }
 
-void c_PerceptronLayer::evaluate()
+template <typename T>
+const T* c_BasicPerceptronLayer<T>::getBatchOutputs()
+{
+	// Row-major batch output matrix (without a bias column); row r starts at r * getBatchStride()
+	return m_BatchOutputs.data();
+}
+
+template <typename T>
+const size_t c_BasicPerceptronLayer<T>::getBatchStride()
+{
+	return m_BatchStride;
+}
+
+template <typename T>
+const size_t c_BasicPerceptronLayer<T>::getNumPruned()
+{
+	return m_NumPruned;
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::evaluate()
+{
+	// Evaluate the perceptron layer, one chunk of perceptrons per task
+	_parallelFor(_getNumChunks(), [this](const size_t &chunk) { _evaluateChunk(chunk); });
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::train()
+{
+	// Train the perceptron layer
+	if (m_Optimizer) {
+		m_Optimizer->step();
+	}
+	const size_t numChunks = _getNumChunks();
+	_resizeChunkSums(numChunks);
+	// Train one chunk of perceptrons per task, each accumulating its own partial weighted delta sums
+	_parallelFor(numChunks, [this](const size_t &chunk) { _trainChunk(chunk); });
+	_mergeChunkSums(numChunks);
+}
+
+template <typename T>
+T c_BasicPerceptronLayer<T>::step()
+{
+	// Evaluate and train the perceptron layer in one pass, each chunk of perceptrons being trained straight after
+	// it is evaluated (while its weights rows are still in cache). The result matches evaluate() then train(), and
+	// the sum of the squared errors against the targets (if set) is returned
+	if (m_Optimizer) {
+		m_Optimizer->step();
+	}
+	const size_t numChunks = _getNumChunks();
+	_resizeChunkSums(numChunks);
+	if (m_ChunkErrors.size() != numChunks) {
+		m_ChunkErrors.resize(numChunks);
+	}
+	_parallelFor(numChunks, [this](const size_t &chunk) { _stepChunk(chunk); });
+	_mergeChunkSums(numChunks);
+	// Merge the partial errors in chunk order too
+	T error = 0.0;
+	for (size_t chunk = 0; chunk < numChunks; ++chunk) {
+		error += m_ChunkErrors[chunk];
+	}
+	return error;
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::evaluateBatch(const T *inputs, const size_t &inputStride, const size_t &rows)
+{
+	// Evaluate the perceptron layer for a batch of input rows as a single matrix-matrix product (the rows hold no
+	// bias column when the last input is a bias node of the input layer or network, see _getBatchInputSize)
+	_resizeBatch(rows);
+	_setBatchInputs(inputs, inputStride, rows);
+	_parallelFor(_getNumBatchChunks(), [this](const size_t &chunk) { _evaluateBatchChunk(chunk); });
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::trainBatch(const T *inputs, const size_t &inputStride, const T *targets, const size_t &rows)
+{
+	// Train the perceptron layer for a batch of input rows (evaluateBatch must already have been called for these rows)
+	// First calculate the deltas from the activation derivatives multiplied by the errors
+	const T *weightedDeltaSumsIn = NULL;
+	size_t weightedDeltaSumsStride = 0;
+	if ((targets == NULL) && (m_Output != NULL)) {
+		weightedDeltaSumsIn = m_Output->m_BatchWeightedDeltaSumsOut.data();
+		weightedDeltaSumsStride = m_Output->_getBatchSumsStride();
+	}
+	for (size_t r = 0; r < rows; ++r) {
+		const T *sums = &m_BatchSums[r * m_BatchStride];
+		const T *outputs = &m_BatchOutputs[r * m_BatchStride];
+		T *deltas = &m_BatchDeltas[r * m_BatchStride];
+		activateDeriv(m_ActType, m_ActPrecision, sums, outputs, deltas, m_Size);
+		for (size_t i = 0; i < m_Size; ++i) {
+			T error = 0.0;
+			if (targets != NULL) {
+				// Targets set, output layer
+				error = targets[(r * m_Size) + i] - outputs[i];
+			} else if (weightedDeltaSumsIn != NULL) {
+				// Output layer set, backpropagation layer
+				error = weightedDeltaSumsIn[(r * weightedDeltaSumsStride) + i];
+			}
+			deltas[i] *= error;
+		}
+	}
+	_setBatchInputs(inputs, inputStride, rows);
+	if (m_Optimizer) {
+		m_Optimizer->step();
+	}
+	// Second backpropagate the deltas through the (not yet updated) weights to the input layer, one block of rows per task
+	if (m_Input != NULL) {
+		_parallelFor((rows + BATCH_ROW_BLOCK - 1) / BATCH_ROW_BLOCK, [this](const size_t &block) { _backpropBatchBlock(block); });
+	}
+	// Finally apply the weight changes averaged over the batch, one chunk of perceptrons (weight rows) per task
+	_parallelFor(_getNumBatchChunks(), [this](const size_t &chunk) { _updateBatchChunk(chunk); });
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::evaluateSample(const T *inputs, T *sums, T *outputs) const
 {
-	// Evaluate the perceptron layer
+	// Evaluate one sample into caller-owned arrays, leaving the layer's own state untouched (weights are only read)
 	for (size_t i = 0; i < m_Size; ++i) {
-		if (m_Perceptrons[i].evaluate()) {
-			m_Outputs[i] = m_Perceptrons[i].getOutput();
+		sums[i] = kernelDot(&m_Weights[i * m_Stride], inputs, m_InputSize);
+	}
+	activate(m_ActType, m_ActPrecision, sums, outputs, m_Size);
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::backpropSample(const T *inputs, const T *sums, const T *outputs, const T *errors, T *deltas, T *weightedDeltaSumsOut, T *gradients)
+{
+	// Backpropagate one sample evaluated by evaluateSample, through caller-owned arrays: the weighted delta sums
+	// (if not NULL) are written for the input layer, and this sample's gradients are added to the gradients matrix
+	// (laid out as the weights). Weights are only read
+	activateDeriv(m_ActType, m_ActPrecision, sums, outputs, deltas, m_Size);
+	for (size_t i = 0; i < m_Size; ++i) {
+		deltas[i] *= errors[i];
+	}
+	if ((weightedDeltaSumsOut != NULL) && (m_Input != NULL)) {
+		const size_t numSums = m_Input->getSize();
+		for (size_t j = 0; j < numSums; ++j) {
+			weightedDeltaSumsOut[j] = 0.0;
 		}
+		for (size_t i = 0; i < m_Size; ++i) {
+			kernelAxpy(deltas[i], &m_Weights[i * m_Stride], weightedDeltaSumsOut, numSums);
+		}
+	}
+	for (size_t i = 0; i < m_Size; ++i) {
+		kernelAxpy(deltas[i], inputs, &gradients[i * m_Stride], m_InputSize);
 	}
 }
 
-void c_PerceptronLayer::train()
+template <typename T>
+void c_BasicPerceptronLayer<T>::trainSample(const T *inputs, const T *sums, const T *outputs, const T *errors, T *deltas, T *weightedDeltaSumsOut, T *gradients)
 {
-	// Train the perceptron layer
-	m_WeightedDeltaSumsOut = 0;
+	// Backpropagate one sample evaluated by evaluateSample and update the weights straight away (as train() does,
+	// but through caller-owned arrays), a row at a time: the weighted delta sums (if not NULL) through the weights
+	// before their update, then the update itself while the row is still in cache. The gradients matrix (laid out as
+	// the weights) is only used as scratch for the optimizer, if one is set
+	activateDeriv(m_ActType, m_ActPrecision, sums, outputs, deltas, m_Size);
 	for (size_t i = 0; i < m_Size; ++i) {
-		if (m_Perceptrons[i].train()) {
-			m_WeightedDeltaSumsOut += m_Perceptrons[i].getWeightedDeltas();
+		deltas[i] *= errors[i];
+	}
+	const size_t numSums = ((weightedDeltaSumsOut != NULL) && (m_Input != NULL)) ? m_Input->getSize() : 0;
+	for (size_t j = 0; j < numSums; ++j) {
+		weightedDeltaSumsOut[j] = 0.0;
+	}
+	if (m_Optimizer) {
+		m_Optimizer->step();
+	}
+	for (size_t i = 0; i < m_Size; ++i) {
+		T *weights = &m_Weights[i * m_Stride];
+		kernelAxpy(deltas[i], weights, weightedDeltaSumsOut, numSums);
+		if (m_Optimizer) {
+			T *rowGradients = &gradients[i * m_Stride];
+			kernelScale(deltas[i], inputs, rowGradients, m_InputSize);
+			m_Optimizer->update(m_TrainRate, i * m_Stride, rowGradients, weights, m_InputSize);
+		} else {
+			kernelAxpy(m_TrainRate * deltas[i], inputs, weights, m_InputSize);
 		}
 	}
+	_applyPruneMask(0, m_Size);
 }
 
-void c_PerceptronLayer::_setOutput(c_PerceptronLayer &output)
+template <typename T>
+void c_BasicPerceptronLayer<T>::applyGradients(T *gradients, const size_t &samples)
+{
+	// Apply gradients accumulated over a number of samples (averaging them), through the optimizer if one is set.
+	// The gradients matrix is used as scratch
+	if (samples == 0) {
+		return;
+	}
+	const T scale = static_cast<T>(1.0) / static_cast<T>(samples);
+	if (m_Optimizer) {
+		kernelScale(scale, gradients, gradients, m_Size * m_Stride);
+		m_Optimizer->step();
+		m_Optimizer->update(m_TrainRate, 0, gradients, m_Weights.data(), m_Size * m_Stride);
+	} else {
+		kernelAxpy(m_TrainRate * scale, gradients, m_Weights.data(), m_Size * m_Stride);
+	}
+	_applyPruneMask(0, m_Size);
+}
+
+template <typename T>
+size_t c_BasicPerceptronLayer<T>::prune(const T &threshold)
+{
+	// Magnitude pruning: zero every weight (bias weights included) smaller in magnitude than the threshold, and
+	// keep them at zero through any further training (so the layer can be fine-tuned with its sparsity fixed)
+	// until clearPruneMask(). Pruning again only adds to the pruned weights. Returns the number pruned in all
+	if (m_PruneMask.size() != m_Weights.size()) {
+		m_PruneMask.resize(m_Weights.size());
+		for (size_t i = 0; i < m_Size; ++i) {
+			for (size_t j = 0; j < m_Stride; ++j) {
+				// The row padding is never a weight, so is left out of the mask
+				m_PruneMask[(i * m_Stride) + j] = (j < m_InputSize) ? static_cast<T>(1.0) : static_cast<T>(0.0);
+			}
+		}
+		m_NumPruned = 0;
+	}
+	for (size_t i = 0; i < m_Size; ++i) {
+		for (size_t j = 0; j < m_InputSize; ++j) {
+			const size_t idx = (i * m_Stride) + j;
+			if ((m_PruneMask[idx] != 0.0) && (std::fabs(m_Weights[idx]) < threshold)) {
+				m_PruneMask[idx] = 0.0;
+				++m_NumPruned;
+			}
+		}
+	}
+	_applyPruneMask(0, m_Size);
+	m_PerceptronsBound = false;
+	return m_NumPruned;
+}
+
+template <typename T>
+size_t c_BasicPerceptronLayer<T>::pruneFraction(const T &fraction)
+{
+	// Prune the smallest magnitude weights of this layer, until the given fraction (0 to 1) of them are pruned
+	const size_t numWeights = m_Size * m_InputSize;
+	const size_t target = static_cast<size_t>(fraction * static_cast<T>(numWeights));
+	if ((numWeights == 0) || (target == 0) || (target <= m_NumPruned)) {
+		return m_NumPruned;
+	}
+	std::vector<T> magnitudes(numWeights);
+	for (size_t i = 0; i < m_Size; ++i) {
+		for (size_t j = 0; j < m_InputSize; ++j) {
+			magnitudes[(i * m_InputSize) + j] = std::fabs(m_Weights[(i * m_Stride) + j]);
+		}
+	}
+	if (target >= numWeights) {
+		return prune(*std::max_element(magnitudes.begin(), magnitudes.end()) + static_cast<T>(1.0));
+	}
+	// The weights below the target-th smallest magnitude are pruned (already pruned weights being zero are among them)
+	std::nth_element(magnitudes.begin(), magnitudes.begin() + target, magnitudes.end());
+	return prune(magnitudes[target]);
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::clearPruneMask()
+{
+	// Let the pruned weights train again (they stay zero until they do)
+	m_PruneMask.resize(0);
+	m_NumPruned = 0;
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::initWeights(const c_BasicInitializer<T> &initializer, const uint64_t &stream)
+{
+	// Draw every weight (bias weights included) from the initializer. Each row comes from its own counter-based
+	// stream, so the chunks fill in parallel and the weights are the same for any number of threads. Pruned
+	// weights stay zero
+	m_Initializer = &initializer;
+	m_InitStream = stream;
+	_parallelFor(_getNumChunks(), [this](const size_t &chunk) { _initChunk(chunk); });
+	m_Initializer = NULL;
+	m_PerceptronsBound = false;
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_setBatchInputs(const T *inputs, const size_t &inputStride, const size_t &rows)
+{
+	// Hold the current batch for the parallel tasks, so each task captures only this (small enough for
+	// std::function to store without a heap allocation)
+	m_BatchInputs = inputs;
+	m_BatchInputStride = inputStride;
+	m_BatchSize = rows;
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_setOutput(c_BasicPerceptronLayer &output)
 {
 	m_Output = &output;
 }
 
-void c_PerceptronLayer::_setWeightedDeltaSumsIn(const std::valarray<double> &weightedDeltaSums)
+template <typename T>
+void c_BasicPerceptronLayer<T>::_setWeightedDeltaSumsIn(const std::valarray<T> &weightedDeltaSums)
 {
 	m_WeightedDeltaSumsIn = &weightedDeltaSums;
 	// Clear the Targets
 	m_Targets = NULL;
-	// Connect these weighted delta sums to the perceptrons
-	_connectWeightedDeltaSums();
+	m_PerceptronsBound = false;
 }
 
-void c_PerceptronLayer::_copy(const c_PerceptronLayer &src)
+template <typename T>
+void c_BasicPerceptronLayer<T>::_copy(const c_BasicPerceptronLayer &src, T *arena)
 {
-	// Copy member variables
+	// Copy member variables. Given an arena (the copy of the source's arena block, made by the network being
+	// copied), the buffers in the source's arena are attached at the same offsets in it rather than copied;
+	// otherwise every buffer is copied into owned memory
 	m_Inputs = src.m_Inputs;
 	m_Targets = src.m_Targets;
 	m_WeightedDeltaSumsIn = src.m_WeightedDeltaSumsIn;
+	m_SparseIndices = src.m_SparseIndices;
+	m_SparseValues = src.m_SparseValues;
+	m_SparseCount = src.m_SparseCount;
 	m_Input = src.m_Input;
 	m_Output = src.m_Output;
 	m_Outputs = src.m_Outputs;
+	_copyBuffer(m_Sums, src.m_Sums, src, arena);
+	_copyBuffer(m_Deltas, src.m_Deltas, src, arena);
 	m_WeightedDeltaSumsOut = src.m_WeightedDeltaSumsOut;
-	m_Perceptrons = src.m_Perceptrons;
+	_copyBuffer(m_Weights, src.m_Weights, src, arena);
+	_copyBuffer(m_WeightedDeltas, src.m_WeightedDeltas, src, arena);
+	if (arena != NULL) {
+		// The chunk sums are scratch space, so only take their place in the arena
+		_copyBuffer(m_ChunkSums, src.m_ChunkSums, src, arena);
+	}
+	m_Arena = arena;
+	m_ArenaSize = (arena != NULL) ? src.m_ArenaSize : 0;
+	m_PruneMask = src.m_PruneMask;
+	m_NumPruned = src.m_NumPruned;
 	m_Bias = src.m_Bias;
+	m_InputBias = src.m_InputBias;
 	m_Size = src.m_Size;
+	m_InputSize = src.m_InputSize;
+	m_Stride = src.m_Stride;
+	// The batch buffers are scratch space, so are not copied
+	m_BatchRows = 0;
+	m_BatchStride = 0;
+	m_BatchInputs = NULL;
+	m_BatchInputStride = 0;
+	m_BatchSize = 0;
+	m_Initializer = NULL;
+	m_InitStream = 0;
+	m_ThreadPool = src.m_ThreadPool;
+	m_Optimizer.reset((src.m_Optimizer) ? src.m_Optimizer->clone() : NULL);
+	m_Gradients = src.m_Gradients;
 	m_TrainRate = src.m_TrainRate;
 	m_ActType = src.m_ActType;
+	m_ActPrecision = src.m_ActPrecision;
 	// Connect the new perceptrons correctly
 	_connect();
 }
 
-void c_PerceptronLayer::_build()
+template <typename T>
+void c_BasicPerceptronLayer<T>::_move(c_BasicPerceptronLayer &src)
+{
+	// Take over the source's buffers, which keep their addresses; only the perceptron views (rebound lazily) and
+	// the links between neighbouring layers (see _link) refer to the layer objects themselves
+	m_Inputs = src.m_Inputs;
+	m_Targets = src.m_Targets;
+	m_WeightedDeltaSumsIn = src.m_WeightedDeltaSumsIn;
+	m_SparseIndices = src.m_SparseIndices;
+	m_SparseValues = src.m_SparseValues;
+	m_SparseCount = src.m_SparseCount;
+	m_Input = src.m_Input;
+	m_Output = src.m_Output;
+	m_Outputs = std::move(src.m_Outputs);
+	m_WeightedDeltaSumsOut = std::move(src.m_WeightedDeltaSumsOut);
+	m_Sums = std::move(src.m_Sums);
+	m_Deltas = std::move(src.m_Deltas);
+	m_Weights = std::move(src.m_Weights);
+	m_WeightedDeltas = std::move(src.m_WeightedDeltas);
+	m_Gradients = std::move(src.m_Gradients);
+	m_BatchSums = std::move(src.m_BatchSums);
+	m_BatchOutputs = std::move(src.m_BatchOutputs);
+	m_BatchDeltas = std::move(src.m_BatchDeltas);
+	m_BatchWeightedDeltaSumsOut = std::move(src.m_BatchWeightedDeltaSumsOut);
+	m_ChunkSums = std::move(src.m_ChunkSums);
+	m_ChunkErrors = std::move(src.m_ChunkErrors);
+	m_PruneMask = std::move(src.m_PruneMask);
+	m_NumPruned = src.m_NumPruned;
+	m_Perceptrons = std::move(src.m_Perceptrons);
+	m_Arena = src.m_Arena;
+	m_ArenaSize = src.m_ArenaSize;
+	m_PerceptronsBound = false;
+	m_Bias = src.m_Bias;
+	m_InputBias = src.m_InputBias;
+	m_Size = src.m_Size;
+	m_InputSize = src.m_InputSize;
+	m_Stride = src.m_Stride;
+	m_BatchRows = src.m_BatchRows;
+	m_BatchStride = src.m_BatchStride;
+	m_BatchInputs = NULL;
+	m_BatchInputStride = 0;
+	m_BatchSize = 0;
+	m_Initializer = NULL;
+	m_InitStream = 0;
+	m_ThreadPool = src.m_ThreadPool;
+	m_Optimizer = std::move(src.m_Optimizer);
+	m_TrainRate = src.m_TrainRate;
+	m_ActType = src.m_ActType;
+	m_ActPrecision = src.m_ActPrecision;
+	// Leave the source as an empty, unconnected layer
+	src.m_Inputs = NULL;
+	src.m_Targets = NULL;
+	src.m_WeightedDeltaSumsIn = NULL;
+	src.m_SparseIndices = NULL;
+	src.m_SparseValues = NULL;
+	src.m_SparseCount = 0;
+	src.m_Input = NULL;
+	src.m_Output = NULL;
+	src.m_Arena = NULL;
+	src.m_ArenaSize = 0;
+	src.m_PerceptronsBound = false;
+	src.m_Size = 0;
+	src.m_InputSize = 0;
+	src.m_Stride = 0;
+	src.m_NumPruned = 0;
+	src.m_BatchRows = 0;
+	src.m_BatchStride = 0;
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_link(c_BasicPerceptronLayer *input, c_BasicPerceptronLayer *output)
+{
+	// Point this layer at its (moved or copied) neighbours without rebuilding it, as the sizes are unchanged
+	m_Input = input;
+	m_Output = output;
+	if (m_Input != NULL) {
+		m_Inputs = &m_Input->m_Outputs;
+	}
+	if (m_Output != NULL) {
+		m_WeightedDeltaSumsIn = &m_Output->m_WeightedDeltaSumsOut;
+		m_Targets = NULL;
+	}
+	m_PerceptronsBound = false;
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_build()
 {
-	// Resize this layer to the number of perceptrons specified
-	m_Perceptrons.resize(m_Size);
+	// Release the batch buffers, as their sizes depend on the layer configuration
+	m_BatchRows = 0;
+	// Resize this layer to the number of perceptrons specified (keeping buffers already that size, which may be in
+	// the network's arena)
+	if (m_Sums.size() != m_Size) {
+		m_Sums.resize(m_Size);
+		m_Deltas.resize(m_Size);
+	}
 	// Resize the output array
 	if (m_Bias) {
 		// Bias is enabled, so increase the output array by one extra element (for bias node)
@@ -199,40 +719,469 @@ void c_PerceptronLayer::_build()
 	_connect();
 }
 
-void c_PerceptronLayer::_connect()
+template <typename T>
+void c_BasicPerceptronLayer<T>::_connect()
 {
-	// Connect the perceptrons correctly
+	// Connect the inputs (sizing the weights to match); the perceptrons are rebound the next time one is accessed
 	_connectInputs();
-	_connectTargets();
-	_connectWeightedDeltaSums();
+	m_PerceptronsBound = false;
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_bindPerceptrons()
+{
+	// The layer computes on its own arrays, so the perceptrons are only views for access through operator[]. They
+	// are bound on demand, so (re)connecting, copying or moving a layer never has to walk every perceptron
+	if (m_PerceptronsBound) {
+		return;
+	}
+	m_Perceptrons.assign(m_Size, c_BasicPerceptron<T>());
+	for (size_t i = 0; i < m_Size; ++i) {
+		c_BasicPerceptron<T> &perceptron = m_Perceptrons[i];
+		// Bind each perceptron to its row of the weight and weighted delta matrices
+		perceptron._bind(m_Weights.data() + (i * m_Stride), m_WeightedDeltas.data() + (i * m_Stride), m_InputSize, &m_Sums[i], &m_Outputs[i], &m_Deltas[i]);
+		perceptron.setTrainRate(m_TrainRate);
+		perceptron.setActivation(m_ActType);
+		perceptron.setActPrecision(m_ActPrecision);
+		if (m_Inputs != NULL) {
+			perceptron.setInputs(*m_Inputs);
+		}
+		if ((m_Targets != NULL) && (m_Targets->size() == m_Size)) {
+			perceptron.setTarget((*m_Targets)[i]);
+		} else if ((m_WeightedDeltaSumsIn != NULL) && (m_WeightedDeltaSumsIn->size() == m_Size)) {
+			perceptron.setWeightedDeltaSum((*m_WeightedDeltaSumsIn)[i]);
+		}
+	}
+	m_PerceptronsBound = true;
 }
 
-void c_PerceptronLayer::_connectInputs()
+template <typename T>
+void c_BasicPerceptronLayer<T>::_resizeOptimizer()
+{
+	if (m_Optimizer) {
+		// Gradients and optimizer state are laid out as the weights matrix (and restart from zero)
+		m_Gradients.resize(m_Size * m_Stride);
+		m_Optimizer->resize(m_Size * m_Stride);
+	}
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_connectInputs()
 {
 	if (m_Inputs != NULL) {
-		// Check the perceptron inputs are available then set for each perceptron
-		for (size_t i = 0; i < m_Size; ++i) {
-			m_Perceptrons[i].setInputs((*m_Inputs));
+		if ((m_Inputs->size() != m_InputSize) || (m_Weights.size() != (m_Size * m_Stride))) {
+			// Weights do not match the size of the input array, so resize accordingly (padding each row for alignment)
+			m_InputSize = m_Inputs->size();
+			m_Stride = c_AlignedBuffer<T>::padSize(m_InputSize);
+			m_Weights.resize(m_Size * m_Stride);
+			m_WeightedDeltas.resize(m_Size * m_Stride);
+			// The weights are new, so nothing is pruned
+			m_PruneMask.resize(0);
+			m_NumPruned = 0;
+			_resizeOptimizer();
 		}
+		m_PerceptronsBound = false;
 	}
 }
 
-void c_PerceptronLayer::_connectTargets()
+template <typename T>
+void c_BasicPerceptronLayer<T>::_copyBuffer(c_AlignedBuffer<T> &buffer, const c_AlignedBuffer<T> &srcBuffer, const c_BasicPerceptronLayer &src, T *arena)
 {
-	if ((m_Targets != NULL) && (m_Targets->size() == m_Size)) {
-		// Check the perceptron targets are available and the right size then set for each perceptron
-		for (size_t i = 0; i < m_Size; ++i) {
-			m_Perceptrons[i].setTarget((*m_Targets)[i]);
+	if ((arena != NULL) && src._isArenaBuffer(srcBuffer)) {
+		buffer.attach(arena + (srcBuffer.data() - src.m_Arena), srcBuffer.size());
+	} else {
+		buffer = srcBuffer;
+	}
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_setInputSize(const size_t &inputSize)
+{
+	// Set the shape of the weights ahead of connecting the inputs (for the network to lay out its arena)
+	m_InputSize = inputSize;
+	m_Stride = c_AlignedBuffer<T>::padSize(inputSize);
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_setInputBias(const bool &inputBias)
+{
+	// Set whether the last input is a bias node, for a first layer (later layers take this from their input layer)
+	m_InputBias = inputBias;
+}
+
+template <typename T>
+const size_t c_BasicPerceptronLayer<T>::_getArenaSize(const size_t &numSums)
+{
+	// Elements of arena needed by the buffers sized by the layer's shape alone: the weights (unless they are
+	// attached to external memory), weighted deltas, sums, deltas and the chunk sums of numSums weighted delta sums
+	const size_t matrixSize = m_Size * m_Stride;
+	size_t size = _hasExternalWeights() ? 0 : matrixSize;
+	size += matrixSize;
+	size += 2 * c_AlignedBuffer<T>::padSize(m_Size);
+	size += _getNumChunks() * c_AlignedBuffer<T>::padSize(numSums);
+	return size;
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_attachArena(T *arena, const size_t &numSums)
+{
+	// Move the shape-sized buffers into the given (zeroed) block of the network's arena, _getArenaSize(numSums)
+	// elements long, keeping the contents of any buffer whose size is unchanged
+	const size_t matrixSize = m_Size * m_Stride;
+	T *next = arena;
+	if (!_hasExternalWeights()) {
+		_attachArenaBuffer(m_Weights, next, matrixSize);
+	}
+	_attachArenaBuffer(m_WeightedDeltas, next, matrixSize);
+	_attachArenaBuffer(m_Sums, next, m_Size);
+	_attachArenaBuffer(m_Deltas, next, m_Size);
+	_attachArenaBuffer(m_ChunkSums, next, _getNumChunks() * c_AlignedBuffer<T>::padSize(numSums));
+	m_Arena = arena;
+	m_ArenaSize = next - arena;
+	m_PerceptronsBound = false;
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_attachArenaBuffer(c_AlignedBuffer<T> &buffer, T *&arena, const size_t &size)
+{
+	if ((buffer.size() == size) && (size > 0)) {
+		memcpy(arena, buffer.data(), size * sizeof(T));
+	}
+	buffer.attach(arena, size);
+	arena += c_AlignedBuffer<T>::padSize(size);
+}
+
+template <typename T>
+const bool c_BasicPerceptronLayer<T>::_isArenaBuffer(const c_AlignedBuffer<T> &buffer) const
+{
+	// Whether the buffer views this layer's block of the network's arena (an empty buffer may sit at its end)
+	return !buffer.isOwner() && (m_Arena != NULL) && (buffer.data() >= m_Arena) && (buffer.data() <= (m_Arena + m_ArenaSize));
+}
+
+template <typename T>
+const bool c_BasicPerceptronLayer<T>::_hasExternalWeights()
+{
+	// Whether the weights are attached to memory outside the arena (e.g. a memory-mapped model), of the right size
+	return !m_Weights.isOwner() && !_isArenaBuffer(m_Weights) && (m_Weights.size() == (m_Size * m_Stride));
+}
+
+template <typename T>
+const bool c_BasicPerceptronLayer<T>::_isInArena()
+{
+	// Whether every shape-sized buffer is still in the arena (resizing one moves it to owned memory)
+	return (_hasExternalWeights() || _isArenaBuffer(m_Weights)) && _isArenaBuffer(m_WeightedDeltas) &&
+		_isArenaBuffer(m_Sums) && _isArenaBuffer(m_Deltas) && _isArenaBuffer(m_ChunkSums);
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_resizeBatch(const size_t &rows)
+{
+	const size_t sumsSize = (m_Input != NULL) ? m_Input->getSize() : 0;
+	if ((rows > m_BatchRows) || (m_BatchStride != c_AlignedBuffer<T>::padSize(m_Size))) {
+		// Grow the batch buffers (these are only ever grown, so repeated batches of the same size do not reallocate).
+		// The outputs have no bias column, as the next layer applies its bias weights implicitly
+		m_BatchRows = rows;
+		m_BatchStride = c_AlignedBuffer<T>::padSize(m_Size);
+		m_BatchSums.resize(m_BatchRows * m_BatchStride);
+		m_BatchOutputs.resize(m_BatchRows * m_BatchStride);
+		m_BatchDeltas.resize(m_BatchRows * m_BatchStride);
+		m_BatchWeightedDeltaSumsOut.resize(m_BatchRows * c_AlignedBuffer<T>::padSize(sumsSize));
+	}
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_resizeChunkSums(const size_t &numChunks)
+{
+	const size_t sumsStride = c_AlignedBuffer<T>::padSize(m_WeightedDeltaSumsOut.size());
+	if (m_ChunkSums.size() != (numChunks * sumsStride)) {
+		m_ChunkSums.resize(numChunks * sumsStride);
+	}
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_mergeChunkSums(const size_t &numChunks)
+{
+	// Merge the partial weighted delta sums in chunk order, so the result does not depend on the number of threads
+	const size_t numSums = m_WeightedDeltaSumsOut.size();
+	const size_t sumsStride = c_AlignedBuffer<T>::padSize(numSums);
+	for (size_t j = 0; j < numSums; ++j) {
+		T sum = 0.0;
+		for (size_t chunk = 0; chunk < numChunks; ++chunk) {
+			sum += m_ChunkSums[(chunk * sumsStride) + j];
 		}
+		m_WeightedDeltaSumsOut[j] = sum;
 	}
 }
 
-void c_PerceptronLayer::_connectWeightedDeltaSums()
+template <typename T>
+const size_t c_BasicPerceptronLayer<T>::_getBatchSumsStride()
 {
-	if ((m_WeightedDeltaSumsIn != NULL) && (m_WeightedDeltaSumsIn->size() == m_Size)) {
-		// Check the weighted delta sums are available and the right size then set for each perceptron
-		for (size_t i = 0; i < m_Size; ++i) {
-			m_Perceptrons[i].setWeightedDeltaSum((*m_WeightedDeltaSumsIn)[i]);
+	return c_AlignedBuffer<T>::padSize((m_Input != NULL) ? m_Input->getSize() : 0);
+}
+
+template <typename T>
+const size_t c_BasicPerceptronLayer<T>::_getBatchInputSize()
+{
+	// Number of columns read from the batch inputs: when the last input is a bias node (of the input layer, or of
+	// the network for the first layer), its weights are applied implicitly and it has no column
+	const bool inputBias = (m_Input != NULL) ? m_Input->m_Bias : m_InputBias;
+	return (inputBias && (m_InputSize > 0)) ? (m_InputSize - 1) : m_InputSize;
+}
+
+template <typename T>
+const size_t c_BasicPerceptronLayer<T>::_getNumBatchChunks()
+{
+	return (m_Size + BATCH_CHUNK_SIZE - 1) / BATCH_CHUNK_SIZE;
+}
+
+template <typename T>
+const size_t c_BasicPerceptronLayer<T>::_getChunkSize()
+{
+	// Number of perceptrons per parallel task; this depends only on the layer shape (never the thread count),
+	// so the order of every floating point reduction is fixed
+	const size_t rowBytes = ((m_Stride > 0) ? m_Stride : 1) * sizeof(T);
+	return (CHUNK_BYTES > rowBytes) ? (CHUNK_BYTES / rowBytes) : 1;
+}
+
+template <typename T>
+const size_t c_BasicPerceptronLayer<T>::_getNumChunks()
+{
+	const size_t chunkSize = _getChunkSize();
+	return (m_Size + chunkSize - 1) / chunkSize;
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_parallelFor(const size_t &numTasks, const std::function<void(const size_t&)> &task)
+{
+	if ((m_ThreadPool != NULL) && (numTasks > 1)) {
+		m_ThreadPool->run(numTasks, task);
+	} else {
+		for (size_t i = 0; i < numTasks; ++i) {
+			task(i);
 		}
 	}
 }
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_evaluateChunk(const size_t &chunk)
+{
+	const size_t chunkSize = _getChunkSize();
+	const size_t begin = chunk * chunkSize;
+	const size_t end = (begin + chunkSize < m_Size) ? (begin + chunkSize) : m_Size;
+	if (m_SparseIndices != NULL) {
+		// Sparse inputs, so gather only the weights of the nonzero inputs from each row
+		for (size_t i = begin; i < end; ++i) {
+			m_Sums[i] = kernelDotSparse(&m_Weights[i * m_Stride], m_SparseIndices, m_SparseValues, m_SparseCount);
+		}
+	} else if (m_Inputs != NULL) {
+		// Sums of products, as a matrix-vector product of the chunk's weights rows
+		gemv<T>(false, end - begin, m_InputSize, 1.0, &m_Weights[begin * m_Stride], m_Stride, &(*m_Inputs)[0], 0.0, &m_Sums[begin]);
+	} else {
+		return;
+	}
+	// Then the activation across the whole chunk at once
+	activate(m_ActType, m_ActPrecision, &m_Sums[begin], &m_Outputs[begin], end - begin);
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_trainChunk(const size_t &chunk)
+{
+	const size_t chunkSize = _getChunkSize();
+	const size_t begin = chunk * chunkSize;
+	const size_t end = (begin + chunkSize < m_Size) ? (begin + chunkSize) : m_Size;
+	const size_t numSums = m_WeightedDeltaSumsOut.size();
+	T *chunkSums = m_ChunkSums.data() + (chunk * c_AlignedBuffer<T>::padSize(numSums));
+	for (size_t j = 0; j < numSums; ++j) {
+		chunkSums[j] = 0.0;
+	}
+	// First calculate the deltas from the activation derivatives (across the whole chunk) multiplied by the errors
+	activateDeriv(m_ActType, m_ActPrecision, &m_Sums[begin], &m_Outputs[begin], &m_Deltas[begin], end - begin);
+	const bool targets = (m_Targets != NULL) && (m_Targets->size() == m_Size);
+	const bool weightedDeltaSums = (m_WeightedDeltaSumsIn != NULL) && (m_WeightedDeltaSumsIn->size() == m_Size);
+	for (size_t i = begin; i < end; ++i) {
+		if (targets) {
+			// Targets set, output layer
+			m_Deltas[i] *= (*m_Targets)[i] - m_Outputs[i];
+		} else if (weightedDeltaSums) {
+			// Weighted delta sums set, backpropagation layer
+			m_Deltas[i] *= (*m_WeightedDeltaSumsIn)[i];
+		} else {
+			// No targets or weighted delta sums set, cannot train!
+			m_Deltas[i] = 0.0;
+		}
+	}
+	if (m_SparseIndices != NULL) {
+		_trainSparseChunk(begin, end, chunkSums);
+		return;
+	}
+	if (m_Inputs == NULL) {
+		return;
+	}
+	const T *inputs = &(*m_Inputs)[0];
+	if (getGemmBackend() == GEMM_BLAS) {
+		// Hand the whole chunk to the BLAS: the weighted delta sums as a transposed matrix-vector product (through the
+		// weights before their update), then the weight changes as a rank-1 update. The weighted deltas of each weight
+		// are still stored from the weights before their update, as the other backends leave them
+		for (size_t i = begin; i < end; ++i) {
+			kernelScale(m_Deltas[i], &m_Weights[i * m_Stride], &m_WeightedDeltas[i * m_Stride], m_InputSize);
+		}
+		if (numSums > 0) {
+			gemv<T>(true, end - begin, numSums, 1.0, &m_Weights[begin * m_Stride], m_Stride, &m_Deltas[begin], 0.0, chunkSums);
+		}
+		if (m_Optimizer) {
+			for (size_t i = begin; i < end; ++i) {
+				T *gradients = &m_Gradients[i * m_Stride];
+				kernelScale(m_Deltas[i], inputs, gradients, m_InputSize);
+				m_Optimizer->update(m_TrainRate, i * m_Stride, gradients, &m_Weights[i * m_Stride], m_InputSize);
+			}
+		} else {
+			ger<T>(end - begin, m_InputSize, m_TrainRate, &m_Deltas[begin], inputs, &m_Weights[begin * m_Stride], m_Stride);
+		}
+		_applyPruneMask(begin, end);
+		return;
+	}
+	// Second apply the deltas to the weights, accumulating each row of weighted deltas (excluding any bias input)
+	for (size_t i = begin; i < end; ++i) {
+		T *weights = &m_Weights[i * m_Stride];
+		T *weightedDeltas = &m_WeightedDeltas[i * m_Stride];
+		kernelScale(m_Deltas[i], weights, weightedDeltas, m_InputSize);
+		if (m_Optimizer) {
+			T *gradients = &m_Gradients[i * m_Stride];
+			kernelScale(m_Deltas[i], inputs, gradients, m_InputSize);
+			m_Optimizer->update(m_TrainRate, i * m_Stride, gradients, weights, m_InputSize);
+		} else {
+			kernelAxpy(m_TrainRate * m_Deltas[i], inputs, weights, m_InputSize);
+		}
+		kernelAxpy(1.0, weightedDeltas, chunkSums, numSums);
+	}
+	_applyPruneMask(begin, end);
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_trainSparseChunk(const size_t &begin, const size_t &end, T *chunkSums)
+{
+	// Apply the deltas to the weights of the nonzero inputs only (the other inputs being zero, their weights do not
+	// change). The weighted deltas are only needed when there is an input layer to backpropagate to; otherwise they
+	// are left as they are, keeping the cost proportional to the nonzeros. With an optimizer, only the state of the
+	// updated weights advances (as with the lazy sparse variants of momentum and Adam)
+	const size_t numSums = m_WeightedDeltaSumsOut.size();
+	for (size_t i = begin; i < end; ++i) {
+		T *weights = &m_Weights[i * m_Stride];
+		if (numSums > 0) {
+			T *weightedDeltas = &m_WeightedDeltas[i * m_Stride];
+			kernelScale(m_Deltas[i], weights, weightedDeltas, m_InputSize);
+			kernelAxpy(1.0, weightedDeltas, chunkSums, numSums);
+		}
+		if (m_Optimizer) {
+			// The row's gradients are packed (one per nonzero input) at the start of its gradients row
+			T *gradients = &m_Gradients[i * m_Stride];
+			kernelScale(m_Deltas[i], m_SparseValues, gradients, m_SparseCount);
+			m_Optimizer->updateSparse(m_TrainRate, i * m_Stride, m_SparseIndices, gradients, weights, m_SparseCount);
+		} else {
+			kernelAxpySparse(m_TrainRate * m_Deltas[i], m_SparseIndices, m_SparseValues, weights, m_SparseCount);
+		}
+	}
+	_applyPruneMask(begin, end);
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_stepChunk(const size_t &chunk)
+{
+	const size_t chunkSize = _getChunkSize();
+	const size_t begin = chunk * chunkSize;
+	const size_t end = (begin + chunkSize < m_Size) ? (begin + chunkSize) : m_Size;
+	_evaluateChunk(chunk);
+	// Sum the squared errors of this chunk's outputs (when the targets are set) before training it
+	T error = 0.0;
+	if ((m_Targets != NULL) && (m_Targets->size() == m_Size)) {
+		for (size_t i = begin; i < end; ++i) {
+			const T diff = (*m_Targets)[i] - m_Outputs[i];
+			error += diff * diff;
+		}
+	}
+	m_ChunkErrors[chunk] = error;
+	_trainChunk(chunk);
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_evaluateBatchChunk(const size_t &chunk)
+{
+	// Produce the output columns of the batch for one chunk of perceptrons, with the bias weights (if any) applied
+	// implicitly rather than against a column of ones in the inputs
+	const size_t begin = chunk * BATCH_CHUNK_SIZE;
+	const size_t end = (begin + BATCH_CHUNK_SIZE < m_Size) ? (begin + BATCH_CHUNK_SIZE) : m_Size;
+	const size_t inputSize = _getBatchInputSize();
+	if (inputSize < m_InputSize) {
+		gemmBias<T>(false, true, m_BatchSize, end - begin, inputSize, 1.0, m_BatchInputs, m_BatchInputStride, &m_Weights[begin * m_Stride], m_Stride, &m_Weights[(begin * m_Stride) + inputSize], m_Stride, 0.0, &m_BatchSums[begin], m_BatchStride);
+	} else {
+		gemm<T>(false, true, m_BatchSize, end - begin, inputSize, 1.0, m_BatchInputs, m_BatchInputStride, &m_Weights[begin * m_Stride], m_Stride, 0.0, &m_BatchSums[begin], m_BatchStride);
+	}
+	for (size_t r = 0; r < m_BatchSize; ++r) {
+		activate(m_ActType, m_ActPrecision, &m_BatchSums[(r * m_BatchStride) + begin], &m_BatchOutputs[(r * m_BatchStride) + begin], end - begin);
+	}
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_backpropBatchBlock(const size_t &block)
+{
+	// Produce the weighted delta sums for one block of batch rows
+	const size_t begin = block * BATCH_ROW_BLOCK;
+	const size_t end = (begin + BATCH_ROW_BLOCK < m_BatchSize) ? (begin + BATCH_ROW_BLOCK) : m_BatchSize;
+	const size_t sumsStride = _getBatchSumsStride();
+	gemm<T>(false, false, end - begin, m_Input->getSize(), m_Size, 1.0, &m_BatchDeltas[begin * m_BatchStride], m_BatchStride, m_Weights.data(), m_Stride, 0.0, &m_BatchWeightedDeltaSumsOut[begin * sumsStride], sumsStride);
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_updateBatchChunk(const size_t &chunk)
+{
+	// Apply the weight changes averaged over the batch for one chunk of perceptrons (weight rows), the bias weights
+	// (if any) taking the sums of the deltas
+	const size_t begin = chunk * BATCH_CHUNK_SIZE;
+	const size_t end = (begin + BATCH_CHUNK_SIZE < m_Size) ? (begin + BATCH_CHUNK_SIZE) : m_Size;
+	const size_t inputSize = _getBatchInputSize();
+	const T alpha = (m_Optimizer ? static_cast<T>(1.0) : m_TrainRate) / static_cast<T>(m_BatchSize);
+	// Average the gradients over the batch into the gradients for the optimizer, or straight into the weights
+	T *target = m_Optimizer ? &m_Gradients[begin * m_Stride] : &m_Weights[begin * m_Stride];
+	const T beta = m_Optimizer ? 0.0 : 1.0;
+	if (inputSize < m_InputSize) {
+		gemmBiasGrad<T>(true, false, end - begin, inputSize, m_BatchSize, alpha, &m_BatchDeltas[begin], m_BatchStride, m_BatchInputs, m_BatchInputStride, beta, target, m_Stride);
+	} else {
+		gemm<T>(true, false, end - begin, inputSize, m_BatchSize, alpha, &m_BatchDeltas[begin], m_BatchStride, m_BatchInputs, m_BatchInputStride, beta, target, m_Stride);
+	}
+	if (m_Optimizer) {
+		// Hand the chunk's rows (padding included) to the optimizer
+		m_Optimizer->update(m_TrainRate, begin * m_Stride, &m_Gradients[begin * m_Stride], &m_Weights[begin * m_Stride], (end - begin) * m_Stride);
+	}
+	_applyPruneMask(begin, end);
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_initChunk(const size_t &chunk)
+{
+	const size_t chunkSize = _getChunkSize();
+	const size_t begin = chunk * chunkSize;
+	const size_t end = (begin + chunkSize < m_Size) ? (begin + chunkSize) : m_Size;
+	for (size_t i = begin; i < end; ++i) {
+		m_Initializer->fillRow(m_InitStream, i, m_InputSize, m_Size, &m_Weights[i * m_Stride], m_InputSize);
+	}
+	_applyPruneMask(begin, end);
+}
+
+template <typename T>
+void c_BasicPerceptronLayer<T>::_applyPruneMask(const size_t &begin, const size_t &end)
+{
+	// Return the pruned weights of rows [begin, end) to zero after an update
+	if (m_PruneMask.size() == 0) {
+		return;
+	}
+	T *weights = &m_Weights[begin * m_Stride];
+	const T *mask = &m_PruneMask[begin * m_Stride];
+	const size_t n = (end - begin) * m_Stride;
+	for (size_t i = 0; i < n; ++i) {
+		weights[i] *= mask[i];
+	}
+}
+
+// Explicit instantiations
+template class c_BasicPerceptronLayer<float>;
+template class c_BasicPerceptronLayer<double>;
@@ -27,56 +27,161 @@
 #ifndef PERCEPTRONLAYER_H_
 #define PERCEPTRONLAYER_H_
 
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <valarray>
 #include <vector>
 
+#include "AlignedBuffer.h"
+#include "Initializer.h"
+#include "Optimizer.h"
 #include "Perceptron.h"
+#include "ThreadPool.h"
 
-class c_PerceptronLayer {
+template <typename T>
+class c_BasicNeuralNetwork;
+
+template <typename T>
+class c_BasicPerceptronLayer {
 public:
 	// Constructors
-									c_PerceptronLayer(const size_t &numPerceptrons);
-									c_PerceptronLayer(const c_PerceptronLayer &src);
+									c_BasicPerceptronLayer(const size_t &numPerceptrons);
+									c_BasicPerceptronLayer(const c_BasicPerceptronLayer &src);
+									c_BasicPerceptronLayer(c_BasicPerceptronLayer &&src) noexcept;
 	// Destructor
-	virtual							~c_PerceptronLayer();
+	virtual							~c_BasicPerceptronLayer();
+	// Operators
+	c_BasicPerceptronLayer&			operator=(const c_BasicPerceptronLayer &src);
+	c_BasicPerceptronLayer&			operator=(c_BasicPerceptronLayer &&src) noexcept;
 	// Set
-	void							setInput(c_PerceptronLayer &input);
-	void							setInputs(const std::valarray<double> &inputs);
-	void							setTargets(const std::valarray<double> &targets);
-	void							setTrainRate(const double &trainRate);
+	void							setInput(c_BasicPerceptronLayer<T> &input);
+	void							setInputs(const std::valarray<T> &inputs);
+	void							setSparseInputs(const uint32_t *indices, const T *values, const size_t &count);
+	void							setTargets(const std::valarray<T> &targets);
+	void							setTrainRate(const T &trainRate);
 	void							setActivation(const e_Activation &actType);
+	void							setActPrecision(const e_ActPrecision &actPrecision);
 	void							setBias(const bool &bias);
+	void							setThreadPool(c_ThreadPool *threadPool);
+	void							setOptimizer(const c_BasicOptimizer<T> &optimizer);
+	void							attachWeights(T *weights);
 	// Get
-	c_Perceptron&					operator[](const size_t &idx);
-	const size_t					getSize();
-	const std::valarray<double>&	getOutputs();
-	const std::valarray<double>&	getWeightedDeltaSumsOut();
+	c_BasicPerceptron<T>&			operator[](const size_t &idx);
+	const size_t					getSize() const;
+	const size_t					getInputSize() const;
+	const size_t					getStride() const;
+	T*								getWeights();
+	const std::valarray<T>&			getOutputs() const;
+	const std::valarray<T>&			getWeightedDeltaSumsOut();
+	const T*						getBatchOutputs();
+	const size_t					getBatchStride();
+	const size_t					getNumPruned();
 	// Functions
 	void							evaluate();
 	void							train();
+	T								step();
+	void							evaluateBatch(const T *inputs, const size_t &inputStride, const size_t &rows);
+	void							trainBatch(const T *inputs, const size_t &inputStride, const T *targets, const size_t &rows);
+	void							evaluateSample(const T *inputs, T *sums, T *outputs) const;
+	void							backpropSample(const T *inputs, const T *sums, const T *outputs, const T *errors, T *deltas, T *weightedDeltaSumsOut, T *gradients);
+	void							trainSample(const T *inputs, const T *sums, const T *outputs, const T *errors, T *deltas, T *weightedDeltaSumsOut, T *gradients);
+	void							applyGradients(T *gradients, const size_t &samples);
+	size_t							prune(const T &threshold);
+	size_t							pruneFraction(const T &fraction);
+	void							clearPruneMask();
+	void							initWeights(const c_BasicInitializer<T> &initializer, const uint64_t &stream = 0);
 private:
+	friend class c_BasicNeuralNetwork<T>;
+	// Constructors
+									c_BasicPerceptronLayer(const c_BasicPerceptronLayer &src, T *arena);
 	// Functions
-	void							_setOutput(c_PerceptronLayer &output);
-	void							_setWeightedDeltaSumsIn(const std::valarray<double> &weightedDeltaSums);
-	void							_copy(const c_PerceptronLayer &src);
+	void							_setBatchInputs(const T *inputs, const size_t &inputStride, const size_t &rows);
+	void							_setOutput(c_BasicPerceptronLayer<T> &output);
+	void							_setWeightedDeltaSumsIn(const std::valarray<T> &weightedDeltaSums);
+	void							_copy(const c_BasicPerceptronLayer &src, T *arena = NULL);
+	void							_copyBuffer(c_AlignedBuffer<T> &buffer, const c_AlignedBuffer<T> &srcBuffer, const c_BasicPerceptronLayer &src, T *arena);
+	void							_move(c_BasicPerceptronLayer &src);
+	void							_link(c_BasicPerceptronLayer<T> *input, c_BasicPerceptronLayer<T> *output);
 	void							_build();
 	void							_connect();
+	void							_bindPerceptrons();
+	void							_resizeOptimizer();
 	void							_connectInputs();
-	void							_connectTargets();
-	void							_connectWeightedDeltaSums();
+	void							_setInputSize(const size_t &inputSize);
+	void							_setInputBias(const bool &inputBias);
+	const size_t					_getArenaSize(const size_t &numSums);
+	void							_attachArena(T *arena, const size_t &numSums);
+	void							_attachArenaBuffer(c_AlignedBuffer<T> &buffer, T *&arena, const size_t &size);
+	const bool						_isArenaBuffer(const c_AlignedBuffer<T> &buffer) const;
+	const bool						_hasExternalWeights();
+	const bool						_isInArena();
+	void							_resizeBatch(const size_t &rows);
+	void							_resizeChunkSums(const size_t &numChunks);
+	void							_mergeChunkSums(const size_t &numChunks);
+	const size_t					_getBatchSumsStride();
+	const size_t					_getBatchInputSize();
+	const size_t					_getNumBatchChunks();
+	const size_t					_getChunkSize();
+	const size_t					_getNumChunks();
+	void							_parallelFor(const size_t &numTasks, const std::function<void(const size_t&)> &task);
+	void							_evaluateChunk(const size_t &chunk);
+	void							_trainChunk(const size_t &chunk);
+	void							_trainSparseChunk(const size_t &begin, const size_t &end, T *chunkSums);
+	void							_stepChunk(const size_t &chunk);
+	void							_evaluateBatchChunk(const size_t &chunk);
+	void							_backpropBatchBlock(const size_t &block);
+	void							_updateBatchChunk(const size_t &chunk);
+	void							_initChunk(const size_t &chunk);
+	void							_applyPruneMask(const size_t &begin, const size_t &end);
 	// Variables
-	const std::valarray<double>		*m_Inputs;
-	const std::valarray<double>		*m_Targets;
-	const std::valarray<double>		*m_WeightedDeltaSumsIn;
-	c_PerceptronLayer				*m_Input;
-	c_PerceptronLayer				*m_Output;
-	std::valarray<double>			m_Outputs;
-	std::valarray<double>			m_WeightedDeltaSumsOut;
-	std::vector<c_Perceptron>		m_Perceptrons;
+	const std::valarray<T>			*m_Inputs;
+	const std::valarray<T>			*m_Targets;
+	const std::valarray<T>			*m_WeightedDeltaSumsIn;
+	const uint32_t					*m_SparseIndices;
+	const T							*m_SparseValues;
+	size_t							m_SparseCount;
+	c_BasicPerceptronLayer<T>		*m_Input;
+	c_BasicPerceptronLayer<T>		*m_Output;
+	std::valarray<T>				m_Outputs;
+	std::valarray<T>				m_WeightedDeltaSumsOut;
+	c_AlignedBuffer<T>				m_Sums;
+	c_AlignedBuffer<T>				m_Deltas;
+	c_AlignedBuffer<T>				m_Weights;
+	c_AlignedBuffer<T>				m_WeightedDeltas;
+	c_AlignedBuffer<T>				m_Gradients;
+	c_AlignedBuffer<T>				m_BatchSums;
+	c_AlignedBuffer<T>				m_BatchOutputs;
+	c_AlignedBuffer<T>				m_BatchDeltas;
+	c_AlignedBuffer<T>				m_BatchWeightedDeltaSumsOut;
+	c_AlignedBuffer<T>				m_ChunkSums;
+	c_AlignedBuffer<T>				m_ChunkErrors;
+	c_AlignedBuffer<T>				m_PruneMask;
+	std::vector<c_BasicPerceptron<T>>	m_Perceptrons;
+	T								*m_Arena;
+	size_t							m_ArenaSize;
+	bool							m_PerceptronsBound;
 	bool							m_Bias;
+	bool							m_InputBias;
 	size_t							m_Size;
-	double							m_TrainRate;
+	size_t							m_InputSize;
+	size_t							m_Stride;
+	size_t							m_NumPruned;
+	size_t							m_BatchRows;
+	size_t							m_BatchStride;
+	const T							*m_BatchInputs;
+	size_t							m_BatchInputStride;
+	size_t							m_BatchSize;
+	const c_BasicInitializer<T>		*m_Initializer;
+	uint64_t						m_InitStream;
+	c_ThreadPool					*m_ThreadPool;
+	std::unique_ptr<c_BasicOptimizer<T>>	m_Optimizer;
+	T								m_TrainRate;
 	e_Activation					m_ActType;
+	e_ActPrecision					m_ActPrecision;
 };
 
+typedef c_BasicPerceptronLayer<double>	c_PerceptronLayer;
+typedef c_BasicPerceptronLayer<float>	c_PerceptronLayerF;
+
 #endif PERCEPTRONLAYER_H_
@@ -0,0 +1,236 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// PipelineTrainer.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <thread>
+
+#include "PipelineTrainer.h"
+
+template <typename T>
+c_BasicPipelineTrainer<T>::c_BasicPipelineTrainer(c_BasicNeuralNetwork<T> &network, const size_t &numStages) :
+	m_Network(&network),
+	m_NumStages((numStages > 0) ? numStages : 1),
+	m_Inputs(NULL),
+	m_Targets(NULL),
+	m_Rows(0),
+	m_ErrorSum(0.0)
+{
+	_build();
+}
+
+template <typename T>
+c_BasicPipelineTrainer<T>::~c_BasicPipelineTrainer()
+{
+}
+
+template <typename T>
+const size_t c_BasicPipelineTrainer<T>::getNumStages()
+{
+	// Number of stages in use (no more than the network has layers)
+	return m_StageBegin.size() - 1;
+}
+
+template <typename T>
+const size_t c_BasicPipelineTrainer<T>::getStageBegin(const size_t &stage)
+{
+	// First layer of a stage
+	return m_StageBegin[stage];
+}
+
+template <typename T>
+const size_t c_BasicPipelineTrainer<T>::getStageEnd(const size_t &stage)
+{
+	// One past the last layer of a stage
+	return m_StageBegin[stage + 1];
+}
+
+template <typename T>
+T c_BasicPipelineTrainer<T>::train(const T *inputs, const T *targets, const size_t &rows)
+{
+	// Train on row-major input and target rows in order, one thread per stage (this thread running the first), and
+	// return the mean squared error of the outputs, each as evaluated just before its sample was backpropagated. The
+	// stage threads are started for each call, so each call should cover many rows
+	if (rows == 0) {
+		return 0.0;
+	}
+	if (m_Slots.empty() || !m_Slots[0]._matches(*m_Network)) {
+		// The network has been reconfigured since the stages were built
+		_build();
+	}
+	m_Inputs = inputs;
+	m_Targets = targets;
+	m_Rows = rows;
+	m_ErrorSum = 0.0;
+	const size_t numStages = getNumStages();
+	for (size_t s = 0; s < numStages; ++s) {
+		m_ForwardQueues[s]->clear();
+		m_BackwardQueues[s]->clear();
+	}
+	std::vector<std::thread> threads;
+	for (size_t s = 1; s < numStages; ++s) {
+		threads.push_back(std::thread(&c_BasicPipelineTrainer<T>::_runStage, this, s));
+	}
+	_runStage(0);
+	for (size_t i = 0; i < threads.size(); ++i) {
+		threads[i].join();
+	}
+	const size_t numOutputs = (*m_Network)[m_Network->getSize() - 1].getSize();
+	return m_ErrorSum / static_cast<T>(rows * numOutputs);
+}
+
+template <typename T>
+void c_BasicPipelineTrainer<T>::_build()
+{
+	// Split the layers into stages of contiguous layers with about equal numbers of weights (at least one layer
+	// each), and size the sample slots, the per-layer gradients (optimizer scratch) and the queues between the stages
+	const size_t numLayers = m_Network->getSize();
+	const size_t numStages = (m_NumStages < numLayers) ? m_NumStages : numLayers;
+	size_t numWeights = 0;
+	for (size_t l = 0; l < numLayers; ++l) {
+		numWeights += (*m_Network)[l].getSize() * (*m_Network)[l].getInputSize();
+	}
+	m_StageBegin.assign(numStages + 1, numLayers);
+	size_t layer = 0;
+	size_t stageWeights = 0;
+	for (size_t s = 0; s < numStages; ++s) {
+		m_StageBegin[s] = layer;
+		// Leave at least one layer for each of the stages after this one
+		const size_t lastLayer = numLayers - (numStages - s - 1);
+		const size_t target = (numWeights * (s + 1)) / numStages;
+		while (layer < lastLayer) {
+			const size_t layerWeights = (*m_Network)[layer].getSize() * (*m_Network)[layer].getInputSize();
+			if ((layer > m_StageBegin[s]) && ((stageWeights + (layerWeights / 2)) > target)) {
+				break;
+			}
+			stageWeights += layerWeights;
+			++layer;
+		}
+	}
+	// The first stage has the most samples in flight: one for each stage
+	m_Slots.clear();
+	m_Slots.reserve(numStages);
+	for (size_t i = 0; i < numStages; ++i) {
+		m_Slots.push_back(c_BasicExecContext<T>(*m_Network));
+	}
+	m_Gradients.resize(numLayers);
+	for (size_t l = 0; l < numLayers; ++l) {
+		m_Gradients[l].resize((*m_Network)[l].getSize() * (*m_Network)[l].getStride());
+	}
+	m_ForwardQueues.clear();
+	m_BackwardQueues.clear();
+	for (size_t s = 0; s < numStages; ++s) {
+		m_ForwardQueues.push_back(std::unique_ptr<c_SpscQueue>(new c_SpscQueue(numStages)));
+		m_BackwardQueues.push_back(std::unique_ptr<c_SpscQueue>(new c_SpscQueue(numStages)));
+	}
+}
+
+template <typename T>
+void c_BasicPipelineTrainer<T>::_runStage(const size_t &stage)
+{
+	// Run one stage's fixed schedule: after filling the pipeline with S - s samples, backpropagate the oldest sample
+	// in flight before evaluating each new one, then drain. The last stage backpropagates each sample straight after
+	// evaluating it. A stage's queue from the stage before carries the samples to evaluate, and its queue from the
+	// stage after the samples to backpropagate, each in sample order
+	const size_t numStages = getNumStages();
+	const size_t lastStage = numStages - 1;
+	const size_t lag = (stage < lastStage) ? (numStages - stage) : 0;
+	for (size_t k = 0; k < m_Rows; ++k) {
+		if ((lag > 0) && (k >= lag)) {
+			m_BackwardQueues[stage]->pop();
+			_backward(stage, k - lag);
+		}
+		if (stage > 0) {
+			m_ForwardQueues[stage]->pop();
+		}
+		_forward(stage, k);
+		if (lag == 0) {
+			_backward(stage, k);
+		}
+	}
+	if (lag > 0) {
+		for (size_t k = ((m_Rows > lag) ? (m_Rows - lag) : 0); k < m_Rows; ++k) {
+			m_BackwardQueues[stage]->pop();
+			_backward(stage, k);
+		}
+	}
+}
+
+template <typename T>
+void c_BasicPipelineTrainer<T>::_forward(const size_t &stage, const size_t &sample)
+{
+	// Evaluate a sample through the stage's layers, into the sample's slot, and pass it on to the next stage (or,
+	// in the last stage, work out its errors against the targets)
+	c_BasicExecContext<T> &context = m_Slots[sample % m_Slots.size()];
+	const size_t numLayers = m_Network->getSize();
+	if (stage == 0) {
+		const size_t numInputs = m_Network->getNumInputs();
+		const T *rowInputs = m_Inputs + (sample * numInputs);
+		for (size_t i = 0; i < numInputs; ++i) {
+			context.m_Inputs[i] = rowInputs[i];
+		}
+	}
+	for (size_t l = m_StageBegin[stage]; l < m_StageBegin[stage + 1]; ++l) {
+		const T *layerInputs = (l > 0) ? context.m_Outputs[l - 1].data() : context.m_Inputs.data();
+		(*m_Network)[l].evaluateSample(layerInputs, context.m_Sums[l].data(), context.m_Outputs[l].data());
+	}
+	if (m_StageBegin[stage + 1] < numLayers) {
+		m_ForwardQueues[stage + 1]->push(sample % m_Slots.size());
+	} else {
+		const size_t numOutputs = (*m_Network)[numLayers - 1].getSize();
+		const T *outputs = context.m_Outputs[numLayers - 1].data();
+		const T *rowTargets = m_Targets + (sample * numOutputs);
+		for (size_t i = 0; i < numOutputs; ++i) {
+			const T diff = rowTargets[i] - outputs[i];
+			context.m_Errors[i] = diff;
+			m_ErrorSum += diff * diff;
+		}
+	}
+}
+
+template <typename T>
+void c_BasicPipelineTrainer<T>::_backward(const size_t &stage, const size_t &sample)
+{
+	// Backpropagate a sample through the stage's layers, updating each layer's weights as soon as its deltas are
+	// known (after its weighted delta sums are taken for the layer before), and pass it back to the stage before.
+	// Only this stage's thread touches these layers' weights (and their optimizer state), so the updates need no
+	// locking
+	c_BasicExecContext<T> &context = m_Slots[sample % m_Slots.size()];
+	const size_t numLayers = m_Network->getSize();
+	for (size_t l = m_StageBegin[stage + 1]; l > m_StageBegin[stage]; --l) {
+		const size_t idx = l - 1;
+		c_BasicPerceptronLayer<T> &layer = (*m_Network)[idx];
+		const T *layerInputs = (idx > 0) ? context.m_Outputs[idx - 1].data() : context.m_Inputs.data();
+		const T *errors = (idx == (numLayers - 1)) ? context.m_Errors.data() : context.m_WeightedDeltaSums[idx + 1].data();
+		layer.trainSample(layerInputs, context.m_Sums[idx].data(), context.m_Outputs[idx].data(), errors, context.m_Deltas[idx].data(),
+			(idx > 0) ? context.m_WeightedDeltaSums[idx].data() : NULL, m_Gradients[idx].data());
+	}
+	if (stage > 0) {
+		m_BackwardQueues[stage - 1]->push(sample % m_Slots.size());
+	}
+}
+
+// Explicit instantiations
+template class c_BasicPipelineTrainer<float>;
+template class c_BasicPipelineTrainer<double>;
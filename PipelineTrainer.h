@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// PipelineTrainer.h
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef PIPELINETRAINER_H_
+#define PIPELINETRAINER_H_
+
+#include <memory>
+#include <vector>
+
+#include "ExecContext.h"
+#include "NeuralNetwork.h"
+#include "SpscQueue.h"
+
+// Trains a network one sample at a time (online, like step()) as a pipeline across its layers: the layers are split
+// into stages of contiguous layers with about equal numbers of weights, each stage running on its own thread, and
+// samples flow forwards through the stages and their deltas backwards over lock-free queues. So while one stage
+// evaluates a sample, the next can evaluate the sample before it and the last can backpropagate the one before
+// that, which keeps a thread per stage busy even on deep, narrow networks where splitting each layer across a thread
+// pool does not pay.
+//
+// Each stage updates its own layers' weights as each sample's deltas pass back through it, with a fixed one forward,
+// one backward schedule: stage s (of S) evaluates sample k straight after backpropagating sample k - (S - s). So a
+// sample is backpropagated through weights at most S - s - 1 updates newer than those it was evaluated with (none
+// in the last stage), and the results are the same on every run, whatever the thread timing. With one stage this
+// is plain online training (as step()) through the per-sample paths
+template <typename T>
+class c_BasicPipelineTrainer {
+public:
+	// Constructors
+									c_BasicPipelineTrainer(c_BasicNeuralNetwork<T> &network, const size_t &numStages);
+	// Destructor
+	virtual							~c_BasicPipelineTrainer();
+	// Get
+	const size_t					getNumStages();
+	const size_t					getStageBegin(const size_t &stage);
+	const size_t					getStageEnd(const size_t &stage);
+	// Functions
+	T								train(const T *inputs, const T *targets, const size_t &rows);
+private:
+	// Not copyable
+									c_BasicPipelineTrainer(const c_BasicPipelineTrainer &src);
+	c_BasicPipelineTrainer&			operator=(const c_BasicPipelineTrainer &src);
+	// Functions
+	void							_build();
+	void							_runStage(const size_t &stage);
+	void							_forward(const size_t &stage, const size_t &sample);
+	void							_backward(const size_t &stage, const size_t &sample);
+	// Variables
+	c_BasicNeuralNetwork<T>			*m_Network;
+	std::vector<c_BasicExecContext<T>>	m_Slots;
+	std::vector<c_AlignedBuffer<T>>	m_Gradients;
+	std::vector<std::unique_ptr<c_SpscQueue>>	m_ForwardQueues;
+	std::vector<std::unique_ptr<c_SpscQueue>>	m_BackwardQueues;
+	std::vector<size_t>				m_StageBegin;
+	size_t							m_NumStages;
+	const T							*m_Inputs;
+	const T							*m_Targets;
+	size_t							m_Rows;
+	T								m_ErrorSum;
+};
+
+typedef c_BasicPipelineTrainer<double>	c_PipelineTrainer;
+typedef c_BasicPipelineTrainer<float>	c_PipelineTrainerF;
+
+#endif PIPELINETRAINER_H_
@@ -0,0 +1,261 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Profiler
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+#include "Profiler.h"
+
+// Default number of calls kept for the trace (the counters keep accumulating once it is full)
+const size_t PROFILE_DEFAULT_CAPACITY = 65536;
+
+// Number of c_AlignedBuffer allocations made by any thread
+static std::atomic<uint64_t> g_Allocations(0);
+
+c_Profiler::c_Profiler() :
+	m_Capacity(PROFILE_DEFAULT_CAPACITY),
+	m_Origin(now()),
+	m_Enabled(false)
+{
+}
+
+c_Profiler::~c_Profiler()
+{
+}
+
+void c_Profiler::setEnabled(const bool &enabled)
+{
+	// Reserve the trace up front, so recording a call never allocates
+	m_Enabled = enabled && isCompiledIn();
+	if (m_Enabled) {
+		m_Events.reserve(m_Capacity);
+	}
+}
+
+void c_Profiler::setCapacity(const size_t &capacity)
+{
+	m_Capacity = capacity;
+	if (m_Enabled) {
+		m_Events.reserve(m_Capacity);
+	}
+}
+
+const bool c_Profiler::isEnabled() const
+{
+	return m_Enabled;
+}
+
+s_ProfileCounters c_Profiler::getCounters(const size_t &layer, const e_ProfilePhase &phase) const
+{
+	const size_t idx = (layer * PROFILE_PHASES) + phase;
+	if (idx < m_Counters.size()) {
+		return m_Counters[idx];
+	}
+	const s_ProfileCounters counters = { 0, 0, 0, 0, 0, 0 };
+	return counters;
+}
+
+const size_t c_Profiler::getNumEvents() const
+{
+	return m_Events.size();
+}
+
+void c_Profiler::clear()
+{
+	// Restart the counters and the trace (whose timestamps are relative to now)
+	for (size_t i = 0; i < m_Counters.size(); ++i) {
+		const s_ProfileCounters counters = { 0, 0, 0, 0, 0, 0 };
+		m_Counters[i] = counters;
+	}
+	m_Events.clear();
+	m_Origin = now();
+}
+
+void c_Profiler::record(const size_t &layer, const e_ProfilePhase &phase, const uint64_t &start, const uint64_t &ns, const uint64_t &neurons, const uint64_t &flops, const uint64_t &bytes, const uint64_t &allocations)
+{
+	if (!m_Enabled) {
+		return;
+	}
+	const size_t idx = (layer * PROFILE_PHASES) + phase;
+	if (idx >= m_Counters.size()) {
+		// First call for this layer (the counters are zero-initialised)
+		m_Counters.resize((layer + 1) * PROFILE_PHASES);
+	}
+	s_ProfileCounters &counters = m_Counters[idx];
+	counters.calls += 1;
+	counters.ns += ns;
+	counters.neurons += neurons;
+	counters.flops += flops;
+	counters.bytes += bytes;
+	counters.allocations += allocations;
+	if (m_Events.size() < m_Capacity) {
+		s_ProfileEvent event;
+		event.start = start;
+		event.ns = ns;
+		event.neurons = neurons;
+		event.flops = flops;
+		event.bytes = bytes;
+		event.allocations = allocations;
+		event.layer = static_cast<uint32_t>(layer);
+		event.phase = static_cast<uint32_t>(phase);
+		event.thread = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+		m_Events.push_back(event);
+	}
+}
+
+bool c_Profiler::saveTrace(const std::string &filename) const
+{
+	// Write the recorded calls in the Chrome trace event format (complete events, timestamps in microseconds),
+	// which chrome://tracing and Perfetto can open
+	if (!isCompiledIn()) {
+		return false;
+	}
+	std::ofstream file(filename.c_str(), std::ios::out | std::ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+	file.precision(3);
+	file << std::fixed << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+	for (size_t i = 0; i < m_Events.size(); ++i) {
+		const s_ProfileEvent &event = m_Events[i];
+		const char *phaseName = getPhaseName(static_cast<e_ProfilePhase>(event.phase));
+		const double start = (event.start > m_Origin) ? (static_cast<double>(event.start - m_Origin) / 1000.0) : 0.0;
+		file << ((i > 0) ? ",\n" : "\n");
+		file << "{\"name\": \"layer " << event.layer << " " << phaseName << "\", \"cat\": \"" << phaseName
+			<< "\", \"ph\": \"X\", \"ts\": " << start << ", \"dur\": " << (static_cast<double>(event.ns) / 1000.0)
+			<< ", \"pid\": 1, \"tid\": " << event.thread << ", \"args\": {\"layer\": " << event.layer
+			<< ", \"neurons\": " << event.neurons << ", \"flops\": " << event.flops << ", \"bytes\": " << event.bytes
+			<< ", \"allocations\": " << event.allocations << "}}";
+	}
+	file << "\n]}\n";
+	return file.good();
+}
+
+const bool c_Profiler::isCompiledIn()
+{
+#ifdef BASICNN_PROFILE
+	return true;
+#else
+	return false;
+#endif
+}
+
+const uint64_t c_Profiler::now()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+const uint64_t c_Profiler::getAllocations()
+{
+	return g_Allocations.load(std::memory_order_relaxed);
+}
+
+void c_Profiler::countAllocation()
+{
+	g_Allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+const char* c_Profiler::getPhaseName(const e_ProfilePhase &phase)
+{
+	switch (phase) {
+	case PROFILE_EVALUATE:
+		return "evaluate";
+	case PROFILE_TRAIN:
+		return "train";
+	case PROFILE_STEP:
+		return "step";
+	case PROFILE_EVALUATE_BATCH:
+		return "evaluateBatch";
+	case PROFILE_TRAIN_BATCH:
+		return "trainBatch";
+	case PROFILE_APPLY_GRADIENTS:
+		return "applyGradients";
+	default:
+		return "unknown";
+	}
+}
+
+void c_Profiler::estimateWork(const e_ProfilePhase &phase, const uint64_t &size, const uint64_t &inputSize, const uint64_t &rows, const uint64_t &scalarBytes, uint64_t &flops, uint64_t &bytes)
+{
+	// Nominal work of a layer call, counting a multiply-add as two FLOPs and ignoring the activations. Evaluating
+	// takes a sum of products per weight and sample, reading the weights once and each input and output row;
+	// training takes a weight update and a weighted delta per weight and sample, reading and writing the weights;
+	// applying gradients takes one update per weight, reading the gradients and reading and writing the weights
+	const uint64_t weights = size * inputSize;
+	const uint64_t rowElements = rows * (inputSize + size);
+	switch (phase) {
+	case PROFILE_EVALUATE:
+	case PROFILE_EVALUATE_BATCH:
+		flops = 2 * weights * rows;
+		bytes = (weights + rowElements) * scalarBytes;
+		break;
+	case PROFILE_TRAIN:
+	case PROFILE_TRAIN_BATCH:
+		flops = 4 * weights * rows;
+		bytes = ((2 * weights) + rowElements) * scalarBytes;
+		break;
+	case PROFILE_STEP:
+		flops = 6 * weights * rows;
+		bytes = ((2 * weights) + rowElements) * scalarBytes;
+		break;
+	case PROFILE_APPLY_GRADIENTS:
+		flops = 2 * weights;
+		bytes = 3 * weights * scalarBytes;
+		break;
+	default:
+		flops = 0;
+		bytes = 0;
+		break;
+	}
+}
+
+c_ProfileScope::c_ProfileScope(c_Profiler &profiler, const size_t &layer, const e_ProfilePhase &phase, const size_t &size, const size_t &inputSize, const size_t &rows, const size_t &scalarBytes) :
+	m_Profiler(profiler.isEnabled() ? &profiler : NULL),
+	m_Layer(layer),
+	m_Phase(phase),
+	m_Neurons(static_cast<uint64_t>(size) * rows),
+	m_Flops(0),
+	m_Bytes(0),
+	m_Start(0),
+	m_Allocations(0)
+{
+	if (m_Profiler != NULL) {
+		c_Profiler::estimateWork(phase, size, inputSize, rows, scalarBytes, m_Flops, m_Bytes);
+		m_Allocations = c_Profiler::getAllocations();
+		m_Start = c_Profiler::now();
+	}
+}
+
+c_ProfileScope::~c_ProfileScope()
+{
+	if (m_Profiler != NULL) {
+		const uint64_t end = c_Profiler::now();
+		m_Profiler->record(m_Layer, m_Phase, m_Start, end - m_Start, m_Neurons, m_Flops, m_Bytes, c_Profiler::getAllocations() - m_Allocations);
+	}
+}
@@ -0,0 +1,136 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Profiler
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-layer profiling of the network's evaluate and train calls. Recording is only compiled in when
+// BASICNN_PROFILE is defined (the BASICNN_ENABLE_PROFILING CMake option); otherwise the BASICNN_PROFILE_*
+// macros expand to nothing and the profiling API reports no data, so the hot paths carry no overhead
+enum e_ProfilePhase {
+	PROFILE_EVALUATE,
+	PROFILE_TRAIN,
+	PROFILE_STEP,
+	PROFILE_EVALUATE_BATCH,
+	PROFILE_TRAIN_BATCH,
+	PROFILE_APPLY_GRADIENTS
+};
+
+const size_t PROFILE_PHASES = 6;
+
+// Totals for one layer and phase. FLOPs and bytes are nominal counts worked out from the layer shape (see
+// c_Profiler::estimateWork), and allocations are the c_AlignedBuffer allocations made (by any thread) during the calls
+struct s_ProfileCounters {
+	uint64_t						calls;
+	uint64_t						ns;
+	uint64_t						neurons;
+	uint64_t						flops;
+	uint64_t						bytes;
+	uint64_t						allocations;
+};
+
+// One recorded call, kept for the trace
+struct s_ProfileEvent {
+	uint64_t						start;
+	uint64_t						ns;
+	uint64_t						neurons;
+	uint64_t						flops;
+	uint64_t						bytes;
+	uint64_t						allocations;
+	uint32_t						layer;
+	uint32_t						phase;
+	uint32_t						thread;
+};
+
+class c_Profiler {
+public:
+	// Constructors
+									c_Profiler();
+	// Destructor
+	virtual							~c_Profiler();
+	// Set
+	void							setEnabled(const bool &enabled);
+	void							setCapacity(const size_t &capacity);
+	// Get
+	const bool						isEnabled() const;
+	s_ProfileCounters				getCounters(const size_t &layer, const e_ProfilePhase &phase) const;
+	const size_t					getNumEvents() const;
+	// Functions
+	void							clear();
+	void							record(const size_t &layer, const e_ProfilePhase &phase, const uint64_t &start, const uint64_t &ns, const uint64_t &neurons, const uint64_t &flops, const uint64_t &bytes, const uint64_t &allocations);
+	bool							saveTrace(const std::string &filename) const;
+	static const bool				isCompiledIn();
+	static const uint64_t			now();
+	static const uint64_t			getAllocations();
+	static void						countAllocation();
+	static const char*				getPhaseName(const e_ProfilePhase &phase);
+	static void						estimateWork(const e_ProfilePhase &phase, const uint64_t &size, const uint64_t &inputSize, const uint64_t &rows, const uint64_t &scalarBytes, uint64_t &flops, uint64_t &bytes);
+private:
+	// Variables
+	std::vector<s_ProfileCounters>	m_Counters;
+	std::vector<s_ProfileEvent>		m_Events;
+	size_t							m_Capacity;
+	uint64_t						m_Origin;
+	bool							m_Enabled;
+};
+
+// Times one layer call (of size neurons, each with inputSize weights, over rows samples) for the lifetime of the
+// scope, then records it if the profiler is enabled
+class c_ProfileScope {
+public:
+	// Constructors
+									c_ProfileScope(c_Profiler &profiler, const size_t &layer, const e_ProfilePhase &phase, const size_t &size, const size_t &inputSize, const size_t &rows, const size_t &scalarBytes);
+	// Destructor
+	virtual							~c_ProfileScope();
+private:
+	// Not copyable
+									c_ProfileScope(const c_ProfileScope &src);
+	c_ProfileScope&					operator=(const c_ProfileScope &src);
+	// Variables
+	c_Profiler						*m_Profiler;
+	size_t							m_Layer;
+	e_ProfilePhase					m_Phase;
+	uint64_t						m_Neurons;
+	uint64_t						m_Flops;
+	uint64_t						m_Bytes;
+	uint64_t						m_Start;
+	uint64_t						m_Allocations;
+};
+
+#ifdef BASICNN_PROFILE
+#define BASICNN_PROFILE_LAYER(profiler, layer, phase, size, inputSize, rows, scalarBytes) c_ProfileScope profileScope_((profiler), (layer), (phase), (size), (inputSize), (rows), (scalarBytes))
+#define BASICNN_PROFILE_ALLOCATION() c_Profiler::countAllocation()
+#else
+#define BASICNN_PROFILE_LAYER(profiler, layer, phase, size, inputSize, rows, scalarBytes)
+#define BASICNN_PROFILE_ALLOCATION()
+#endif
+
+#endif PROFILER_H_
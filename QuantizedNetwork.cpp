@@ -0,0 +1,360 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// QuantizedNetwork
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+
+#include "Gemm.h"
+#include "Kernels.h"
+#include "QuantizedNetwork.h"
+
+// Largest magnitude of a quantized value (symmetric, so -128 is never used)
+const int QUANT_MAX = 127;
+// Number of rows evaluated at a time, bounding the scratch arrays however many rows are passed in
+const size_t QUANT_BATCH_ROWS = 64;
+
+template <typename T>
+static int8_t _quantize(const T &value)
+{
+	// Saturate to the symmetric int8 range, then round half away from zero (cheaper than std::nearbyint, and
+	// vectorisable)
+	const T clamped = (value > QUANT_MAX) ? static_cast<T>(QUANT_MAX) : ((value < -QUANT_MAX) ? static_cast<T>(-QUANT_MAX) : value);
+	return static_cast<int8_t>(clamped + ((clamped < 0.0) ? static_cast<T>(-0.5) : static_cast<T>(0.5)));
+}
+
+template <typename T>
+c_BasicQuantizedNetwork<T>::c_BasicQuantizedNetwork() :
+	m_Scale(QUANT_PER_NEURON),
+	m_ActType(ACT_TANH),
+	m_ActPrecision(ACTP_EXACT),
+	m_NumInputs(0),
+	m_MaxWidth(0),
+	m_BatchRows(0)
+{
+}
+
+template <typename T>
+c_BasicQuantizedNetwork<T>::~c_BasicQuantizedNetwork()
+{
+}
+
+template <typename T>
+void c_BasicQuantizedNetwork<T>::setScale(const e_QuantScale &scale)
+{
+	// Takes effect from the next quantize()
+	m_Scale = scale;
+}
+
+template <typename T>
+void c_BasicQuantizedNetwork<T>::setFloatLayer(const size_t &layer, const bool &floatLayer)
+{
+	// Keep a layer's weights (and inputs) in floating point rather than int8, from the next quantize()
+	if (layer >= m_FloatLayers.size()) {
+		m_FloatLayers.resize(layer + 1, false);
+	}
+	m_FloatLayers[layer] = floatLayer;
+}
+
+template <typename T>
+const size_t c_BasicQuantizedNetwork<T>::getSize()
+{
+	return m_Layers.size();
+}
+
+template <typename T>
+const size_t c_BasicQuantizedNetwork<T>::getNumInputs()
+{
+	return m_NumInputs;
+}
+
+template <typename T>
+const size_t c_BasicQuantizedNetwork<T>::getNumOutputs()
+{
+	return (m_Layers.size() > 0) ? m_Layers.back().size : 0;
+}
+
+template <typename T>
+const size_t c_BasicQuantizedNetwork<T>::getWeightBytes()
+{
+	// Storage held for the weights of every layer, including the scales, bias weights and row padding
+	size_t bytes = 0;
+	for (size_t l = 0; l < m_Layers.size(); ++l) {
+		const s_QuantLayer<T> &layer = m_Layers[l];
+		bytes += layer.weights.size() * sizeof(int8_t);
+		bytes += (layer.floatWeights.size() + layer.weightScales.size() + layer.biasWeights.size()) * sizeof(T);
+	}
+	return bytes;
+}
+
+template <typename T>
+bool c_BasicQuantizedNetwork<T>::quantize(c_BasicNeuralNetwork<T> &network)
+{
+	// Quantize the weights of every layer. Each layer's input scale starts from the nominal range [-1, 1] (which
+	// covers the activations of both types), and should be narrowed to the actual range by calibrate()
+	const size_t numLayers = network.getSize();
+	if ((numLayers == 0) || (network.getNumInputs() == 0)) {
+		return false;
+	}
+	m_Layers.clear();
+	m_Layers.resize(numLayers);
+	m_ActType = network.getActivation();
+	m_ActPrecision = network.getActPrecision();
+	m_NumInputs = network.getNumInputs();
+	m_MaxWidth = m_NumInputs;
+	m_BatchRows = 0;
+	for (size_t l = 0; l < numLayers; ++l) {
+		c_BasicPerceptronLayer<T> &source = network[l];
+		s_QuantLayer<T> &layer = m_Layers[l];
+		layer.size = source.getSize();
+		layer.inputSize = (l == 0) ? m_NumInputs : network[l - 1].getSize();
+		layer.bias = (source.getInputSize() > layer.inputSize);
+		layer.floatLayer = (l < m_FloatLayers.size()) && m_FloatLayers[l];
+		layer.inputScale = static_cast<T>(1.0) / QUANT_MAX;
+		m_MaxWidth = (layer.size > m_MaxWidth) ? layer.size : m_MaxWidth;
+		const T *weights = source.getWeights();
+		const size_t sourceStride = source.getStride();
+		layer.weightScales.resize(layer.size);
+		layer.biasWeights.resize(layer.size);
+		for (size_t i = 0; i < layer.size; ++i) {
+			// The bias weight (the last of each row) is kept in floating point and added after the dot product
+			layer.biasWeights[i] = layer.bias ? weights[(i * sourceStride) + layer.inputSize] : 0.0;
+		}
+		if (layer.floatLayer) {
+			layer.stride = c_AlignedBuffer<T>::padSize(layer.inputSize);
+			layer.weights.resize(0);
+			layer.floatWeights.resize(layer.size * layer.stride);
+			for (size_t i = 0; i < layer.size; ++i) {
+				layer.weightScales[i] = 1.0;
+				for (size_t j = 0; j < layer.inputSize; ++j) {
+					layer.floatWeights[(i * layer.stride) + j] = weights[(i * sourceStride) + j];
+				}
+			}
+			continue;
+		}
+		layer.stride = c_AlignedBuffer<int8_t>::padSize(layer.inputSize);
+		layer.weights.resize(layer.size * layer.stride);
+		layer.floatWeights.resize(0);
+		// Find the range of the weights of each neuron (and of the whole layer)
+		T layerRange = 0.0;
+		for (size_t i = 0; i < layer.size; ++i) {
+			T range = 0.0;
+			for (size_t j = 0; j < layer.inputSize; ++j) {
+				const T weight = std::fabs(weights[(i * sourceStride) + j]);
+				range = (weight > range) ? weight : range;
+			}
+			layer.weightScales[i] = range;
+			layerRange = (range > layerRange) ? range : layerRange;
+		}
+		// Then map each range symmetrically onto [-127, 127]
+		for (size_t i = 0; i < layer.size; ++i) {
+			const T range = (m_Scale == QUANT_PER_LAYER) ? layerRange : layer.weightScales[i];
+			const T scale = (range > 0.0) ? (range / QUANT_MAX) : static_cast<T>(1.0);
+			layer.weightScales[i] = scale;
+			for (size_t j = 0; j < layer.inputSize; ++j) {
+				layer.weights[(i * layer.stride) + j] = _quantize(weights[(i * sourceStride) + j] / scale);
+			}
+		}
+	}
+	return true;
+}
+
+template <typename T>
+bool c_BasicQuantizedNetwork<T>::calibrate(c_BasicNeuralNetwork<T> &network, const T *inputs, const size_t &rows)
+{
+	// Run representative (row-major) input rows through the network, recording the largest magnitude reached
+	// by each layer's inputs, and set each layer's input scale to map that range onto [-127, 127]
+	if (!_matches(network) || (rows == 0)) {
+		return false;
+	}
+	std::vector<T> ranges(m_Layers.size(), 0.0);
+	std::vector<T> outputs(QUANT_BATCH_ROWS * getNumOutputs());
+	for (size_t begin = 0; begin < rows; begin += QUANT_BATCH_ROWS) {
+		const size_t blockRows = ((begin + QUANT_BATCH_ROWS) < rows) ? QUANT_BATCH_ROWS : (rows - begin);
+		const T *blockInputs = inputs + (begin * m_NumInputs);
+		network.evaluateBatch(blockInputs, blockRows, outputs.data());
+		for (size_t j = 0; j < (blockRows * m_NumInputs); ++j) {
+			const T value = std::fabs(blockInputs[j]);
+			ranges[0] = (value > ranges[0]) ? value : ranges[0];
+		}
+		for (size_t l = 1; l < m_Layers.size(); ++l) {
+			// The inputs of each later layer are the batch outputs of the layer before (excluding any bias node)
+			c_BasicPerceptronLayer<T> &source = network[l - 1];
+			for (size_t r = 0; r < blockRows; ++r) {
+				const T *row = source.getBatchOutputs() + (r * source.getBatchStride());
+				for (size_t j = 0; j < source.getSize(); ++j) {
+					const T value = std::fabs(row[j]);
+					ranges[l] = (value > ranges[l]) ? value : ranges[l];
+				}
+			}
+		}
+	}
+	for (size_t l = 0; l < m_Layers.size(); ++l) {
+		m_Layers[l].inputScale = (ranges[l] > 0.0) ? (ranges[l] / QUANT_MAX) : static_cast<T>(1.0);
+	}
+	return true;
+}
+
+template <typename T>
+void c_BasicQuantizedNetwork<T>::infer(const T *inputs, T *outputs)
+{
+	// Evaluate one sample (an int8 matrix-vector product per layer)
+	inferBatch(inputs, 1, outputs);
+}
+
+template <typename T>
+void c_BasicQuantizedNetwork<T>::inferBatch(const T *inputs, const size_t &rows, T *outputs)
+{
+	// Evaluate row-major input rows, writing row-major output rows, a block of rows at a time
+	if (m_Layers.empty()) {
+		return;
+	}
+	const size_t numOutputs = getNumOutputs();
+	const size_t stride = c_AlignedBuffer<T>::padSize(m_MaxWidth);
+	for (size_t begin = 0; begin < rows; begin += QUANT_BATCH_ROWS) {
+		const size_t blockRows = ((begin + QUANT_BATCH_ROWS) < rows) ? QUANT_BATCH_ROWS : (rows - begin);
+		_resizeBatch(blockRows);
+		// Each layer reads the previous layer's outputs, alternating between the two activation arrays
+		const T *layerInputs = inputs + (begin * m_NumInputs);
+		size_t inputStride = m_NumInputs;
+		for (size_t l = 0; l < m_Layers.size(); ++l) {
+			const bool last = ((l + 1) == m_Layers.size());
+			T *layerOutputs = last ? (outputs + (begin * numOutputs)) : m_Activations[l % 2].data();
+			const size_t outputStride = last ? numOutputs : stride;
+			_evaluateLayer(m_Layers[l], layerInputs, inputStride, blockRows, layerOutputs, outputStride);
+			layerInputs = layerOutputs;
+			inputStride = outputStride;
+		}
+	}
+}
+
+template <typename T>
+bool c_BasicQuantizedNetwork<T>::compare(c_BasicNeuralNetwork<T> &network, const T *inputs, const size_t &rows, s_QuantReport &report)
+{
+	// Evaluate the same input rows with the source network and this quantized network, reporting the absolute
+	// errors of the outputs, how often both pick the same largest output, and the weights storage of each
+	if (!_matches(network) || (rows == 0)) {
+		return false;
+	}
+	const size_t numOutputs = getNumOutputs();
+	std::vector<T> expected(QUANT_BATCH_ROWS * numOutputs);
+	std::vector<T> actual(QUANT_BATCH_ROWS * numOutputs);
+	double maxError = 0.0;
+	double sumError = 0.0;
+	double sumSquares = 0.0;
+	size_t agreed = 0;
+	for (size_t begin = 0; begin < rows; begin += QUANT_BATCH_ROWS) {
+		const size_t blockRows = ((begin + QUANT_BATCH_ROWS) < rows) ? QUANT_BATCH_ROWS : (rows - begin);
+		const T *blockInputs = inputs + (begin * m_NumInputs);
+		network.evaluateBatch(blockInputs, blockRows, expected.data());
+		inferBatch(blockInputs, blockRows, actual.data());
+		for (size_t r = 0; r < blockRows; ++r) {
+			size_t expectedMax = 0;
+			size_t actualMax = 0;
+			for (size_t i = 0; i < numOutputs; ++i) {
+				const size_t idx = (r * numOutputs) + i;
+				const double error = std::fabs(static_cast<double>(actual[idx]) - static_cast<double>(expected[idx]));
+				maxError = (error > maxError) ? error : maxError;
+				sumError += error;
+				sumSquares += error * error;
+				expectedMax = (expected[idx] > expected[(r * numOutputs) + expectedMax]) ? i : expectedMax;
+				actualMax = (actual[idx] > actual[(r * numOutputs) + actualMax]) ? i : actualMax;
+			}
+			agreed += (expectedMax == actualMax) ? 1 : 0;
+		}
+	}
+	const double count = static_cast<double>(rows * numOutputs);
+	report.rows = rows;
+	report.maxError = maxError;
+	report.meanError = sumError / count;
+	report.rmsError = std::sqrt(sumSquares / count);
+	report.agreement = static_cast<double>(agreed) / static_cast<double>(rows);
+	report.networkBytes = 0;
+	for (size_t l = 0; l < network.getSize(); ++l) {
+		report.networkBytes += network[l].getSize() * network[l].getStride() * sizeof(T);
+	}
+	report.quantizedBytes = getWeightBytes();
+	return true;
+}
+
+template <typename T>
+bool c_BasicQuantizedNetwork<T>::_matches(c_BasicNeuralNetwork<T> &network)
+{
+	// Check the network has the shape this was quantized from
+	if ((m_Layers.size() == 0) || (network.getSize() != m_Layers.size()) || (network.getNumInputs() != m_NumInputs)) {
+		return false;
+	}
+	for (size_t l = 0; l < m_Layers.size(); ++l) {
+		if (network[l].getSize() != m_Layers[l].size) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename T>
+void c_BasicQuantizedNetwork<T>::_resizeBatch(const size_t &rows)
+{
+	if (rows > m_BatchRows) {
+		// Grow the scratch arrays (these are only ever grown, so repeated batches do not reallocate)
+		m_BatchRows = rows;
+		m_Activations[0].resize(m_BatchRows * c_AlignedBuffer<T>::padSize(m_MaxWidth));
+		m_Activations[1].resize(m_BatchRows * c_AlignedBuffer<T>::padSize(m_MaxWidth));
+		m_QuantInputs.resize(m_BatchRows * c_AlignedBuffer<int8_t>::padSize(m_MaxWidth));
+		m_IntSums.resize(m_BatchRows * c_AlignedBuffer<int32_t>::padSize(m_MaxWidth));
+		m_Sums.resize(c_AlignedBuffer<T>::padSize(m_MaxWidth));
+	}
+}
+
+template <typename T>
+void c_BasicQuantizedNetwork<T>::_evaluateLayer(s_QuantLayer<T> &layer, const T *inputs, const size_t &inputStride, const size_t &rows, T *outputs, const size_t &outputStride)
+{
+	if (layer.floatLayer) {
+		// Floating point fallback: the sums of products of the original weights
+		for (size_t r = 0; r < rows; ++r) {
+			for (size_t i = 0; i < layer.size; ++i) {
+				m_Sums[i] = kernelDot(&layer.floatWeights[i * layer.stride], inputs + (r * inputStride), layer.inputSize) + layer.biasWeights[i];
+			}
+			activate(m_ActType, m_ActPrecision, m_Sums.data(), outputs + (r * outputStride), layer.size);
+		}
+		return;
+	}
+	// Quantize the input rows, then take every sum of products at once as an integer matrix product
+	const size_t quantStride = c_AlignedBuffer<int8_t>::padSize(m_MaxWidth);
+	const size_t sumsStride = c_AlignedBuffer<int32_t>::padSize(m_MaxWidth);
+	const T invScale = static_cast<T>(1.0) / layer.inputScale;
+	for (size_t r = 0; r < rows; ++r) {
+		kernelQuantizeInt8(inputs + (r * inputStride), invScale, &m_QuantInputs[r * quantStride], layer.inputSize);
+	}
+	gemmInt8(rows, layer.size, layer.inputSize, m_QuantInputs.data(), quantStride, layer.weights.data(), layer.stride, m_IntSums.data(), sumsStride);
+	// Scale the integer sums back (by the input and weight scales), add the bias weights and activate
+	for (size_t r = 0; r < rows; ++r) {
+		kernelDequantizeInt32(&m_IntSums[r * sumsStride], layer.inputScale, layer.weightScales.data(), layer.biasWeights.data(), m_Sums.data(), layer.size);
+		activate(m_ActType, m_ActPrecision, m_Sums.data(), outputs + (r * outputStride), layer.size);
+	}
+}
+
+// Explicit instantiations
+template class c_BasicQuantizedNetwork<float>;
+template class c_BasicQuantizedNetwork<double>;
@@ -0,0 +1,120 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// QuantizedNetwork
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef QUANTIZEDNETWORK_H_
+#define QUANTIZEDNETWORK_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "AlignedBuffer.h"
+#include "NeuralNetwork.h"
+
+enum e_QuantScale {
+	QUANT_PER_LAYER,
+	QUANT_PER_NEURON
+};
+
+// Accuracy of a quantized network against the network it was quantized from, over a set of input rows
+struct s_QuantReport {
+	size_t							rows;
+	double							maxError;
+	double							meanError;
+	double							rmsError;
+	double							agreement;
+	size_t							networkBytes;
+	size_t							quantizedBytes;
+};
+
+// One layer of a quantized network: int8 weights rows (excluding the bias weight, which stays in floating point)
+// with a scale per neuron, or the original weights for a layer kept in floating point
+template <typename T>
+struct s_QuantLayer {
+	size_t							size;
+	size_t							inputSize;
+	size_t							stride;
+	bool							bias;
+	bool							floatLayer;
+	T								inputScale;
+	c_AlignedBuffer<int8_t>			weights;
+	c_AlignedBuffer<T>				floatWeights;
+	c_AlignedBuffer<T>				weightScales;
+	c_AlignedBuffer<T>				biasWeights;
+};
+
+// Post-training int8 quantization of a trained network, for inference only. The weights are quantized
+// symmetrically with a scale per layer or per neuron, and each layer's inputs with a scale chosen by calibration
+// (running representative inputs through the network). Sums of products are then int8 dot products accumulated
+// in 32 bits; any layer can instead be kept in floating point. The scratch arrays are members, so a quantized
+// network must only be used by one thread at a time
+template <typename T>
+class c_BasicQuantizedNetwork {
+public:
+	// Constructors
+									c_BasicQuantizedNetwork();
+	// Destructor
+	virtual							~c_BasicQuantizedNetwork();
+	// Set
+	void							setScale(const e_QuantScale &scale);
+	void							setFloatLayer(const size_t &layer, const bool &floatLayer);
+	// Get
+	const size_t					getSize();
+	const size_t					getNumInputs();
+	const size_t					getNumOutputs();
+	const size_t					getWeightBytes();
+	// Functions
+	bool							quantize(c_BasicNeuralNetwork<T> &network);
+	bool							calibrate(c_BasicNeuralNetwork<T> &network, const T *inputs, const size_t &rows);
+	void							infer(const T *inputs, T *outputs);
+	void							inferBatch(const T *inputs, const size_t &rows, T *outputs);
+	bool							compare(c_BasicNeuralNetwork<T> &network, const T *inputs, const size_t &rows, s_QuantReport &report);
+private:
+	// Not copyable
+									c_BasicQuantizedNetwork(const c_BasicQuantizedNetwork &src);
+	c_BasicQuantizedNetwork&		operator=(const c_BasicQuantizedNetwork &src);
+	// Functions
+	bool							_matches(c_BasicNeuralNetwork<T> &network);
+	void							_resizeBatch(const size_t &rows);
+	void							_evaluateLayer(s_QuantLayer<T> &layer, const T *inputs, const size_t &inputStride, const size_t &rows, T *outputs, const size_t &outputStride);
+	// Variables
+	std::vector<s_QuantLayer<T>>	m_Layers;
+	std::vector<bool>				m_FloatLayers;
+	e_QuantScale					m_Scale;
+	e_Activation					m_ActType;
+	e_ActPrecision					m_ActPrecision;
+	size_t							m_NumInputs;
+	size_t							m_MaxWidth;
+	size_t							m_BatchRows;
+	c_AlignedBuffer<T>				m_Activations[2];
+	c_AlignedBuffer<int8_t>			m_QuantInputs;
+	c_AlignedBuffer<int32_t>		m_IntSums;
+	c_AlignedBuffer<T>				m_Sums;
+};
+
+typedef c_BasicQuantizedNetwork<double>	c_QuantizedNetwork;
+typedef c_BasicQuantizedNetwork<float>	c_QuantizedNetworkF;
+
+#endif QUANTIZEDNETWORK_H_
@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// SparseNetwork.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Kernels.h"
+#include "SparseNetwork.h"
+
+template <typename T>
+c_BasicSparseNetwork<T>::c_BasicSparseNetwork() :
+	m_ActType(ACT_TANH),
+	m_ActPrecision(ACTP_EXACT),
+	m_NumInputs(0)
+{
+}
+
+template <typename T>
+c_BasicSparseNetwork<T>::~c_BasicSparseNetwork()
+{
+}
+
+template <typename T>
+const size_t c_BasicSparseNetwork<T>::getSize()
+{
+	return m_Layers.size();
+}
+
+template <typename T>
+const size_t c_BasicSparseNetwork<T>::getNumInputs()
+{
+	return m_NumInputs;
+}
+
+template <typename T>
+const size_t c_BasicSparseNetwork<T>::getNumOutputs()
+{
+	return (m_Layers.size() > 0) ? m_Layers.back().size : 0;
+}
+
+template <typename T>
+const size_t c_BasicSparseNetwork<T>::getNumNonzeros()
+{
+	size_t numNonzeros = 0;
+	for (size_t l = 0; l < m_Layers.size(); ++l) {
+		numNonzeros += m_Layers[l].values.size();
+	}
+	return numNonzeros;
+}
+
+template <typename T>
+const size_t c_BasicSparseNetwork<T>::getWeightBytes()
+{
+	// Storage held for the weights of every layer, including the column indices, row offsets and bias weights
+	size_t bytes = 0;
+	for (size_t l = 0; l < m_Layers.size(); ++l) {
+		const s_SparseLayer<T> &layer = m_Layers[l];
+		bytes += (layer.rowOffsets.size() + layer.columns.size()) * sizeof(uint32_t);
+		bytes += (layer.values.size() + layer.biasWeights.size()) * sizeof(T);
+	}
+	return bytes;
+}
+
+template <typename T>
+bool c_BasicSparseNetwork<T>::compress(c_BasicNeuralNetwork<T> &network)
+{
+	// Store the nonzero weights of every layer (normally after network.prune() or pruneFraction())
+	const size_t numLayers = network.getSize();
+	if ((numLayers == 0) || (network.getNumInputs() == 0)) {
+		return false;
+	}
+	m_Layers.clear();
+	m_Layers.resize(numLayers);
+	m_ActType = network.getActivation();
+	m_ActPrecision = network.getActPrecision();
+	m_NumInputs = network.getNumInputs();
+	size_t maxWidth = 0;
+	for (size_t l = 0; l < numLayers; ++l) {
+		c_BasicPerceptronLayer<T> &source = network[l];
+		s_SparseLayer<T> &layer = m_Layers[l];
+		layer.size = source.getSize();
+		layer.inputSize = (l == 0) ? m_NumInputs : network[l - 1].getSize();
+		layer.bias = (source.getInputSize() > layer.inputSize);
+		maxWidth = (layer.size > maxWidth) ? layer.size : maxWidth;
+		const T *weights = source.getWeights();
+		const size_t sourceStride = source.getStride();
+		// Count the nonzeros first, so the arrays are allocated once
+		size_t numNonzeros = 0;
+		for (size_t i = 0; i < layer.size; ++i) {
+			for (size_t j = 0; j < layer.inputSize; ++j) {
+				numNonzeros += (weights[(i * sourceStride) + j] != 0.0) ? 1 : 0;
+			}
+		}
+		layer.rowOffsets.resize(layer.size + 1);
+		layer.columns.resize(numNonzeros);
+		layer.values.resize(numNonzeros);
+		layer.biasWeights.resize(layer.size);
+		size_t k = 0;
+		for (size_t i = 0; i < layer.size; ++i) {
+			layer.rowOffsets[i] = static_cast<uint32_t>(k);
+			for (size_t j = 0; j < layer.inputSize; ++j) {
+				const T weight = weights[(i * sourceStride) + j];
+				if (weight != 0.0) {
+					layer.columns[k] = static_cast<uint32_t>(j);
+					layer.values[k] = weight;
+					++k;
+				}
+			}
+			// The bias weight (the last of each row) is added after the sum of products
+			layer.biasWeights[i] = layer.bias ? weights[(i * sourceStride) + layer.inputSize] : 0.0;
+		}
+		layer.rowOffsets[layer.size] = static_cast<uint32_t>(k);
+	}
+	m_Activations[0].resize(maxWidth);
+	m_Activations[1].resize(maxWidth);
+	m_Sums.resize(maxWidth);
+	return true;
+}
+
+template <typename T>
+void c_BasicSparseNetwork<T>::infer(const T *inputs, T *outputs)
+{
+	// Evaluate one sample (a sparse matrix-vector product per layer)
+	if (m_Layers.empty()) {
+		return;
+	}
+	// Each layer reads the previous layer's outputs, alternating between the two activation arrays
+	const T *layerInputs = inputs;
+	for (size_t l = 0; l < m_Layers.size(); ++l) {
+		T *layerOutputs = ((l + 1) == m_Layers.size()) ? outputs : m_Activations[l % 2].data();
+		_evaluateLayer(m_Layers[l], layerInputs, layerOutputs);
+		layerInputs = layerOutputs;
+	}
+}
+
+template <typename T>
+void c_BasicSparseNetwork<T>::inferBatch(const T *inputs, const size_t &rows, T *outputs)
+{
+	// Evaluate row-major input rows, writing row-major output rows
+	const size_t numOutputs = getNumOutputs();
+	for (size_t r = 0; r < rows; ++r) {
+		infer(inputs + (r * m_NumInputs), outputs + (r * numOutputs));
+	}
+}
+
+template <typename T>
+void c_BasicSparseNetwork<T>::_evaluateLayer(const s_SparseLayer<T> &layer, const T *inputs, T *outputs)
+{
+	for (size_t i = 0; i < layer.size; ++i) {
+		const uint32_t begin = layer.rowOffsets[i];
+		const uint32_t end = layer.rowOffsets[i + 1];
+		m_Sums[i] = kernelDotSparse(inputs, &layer.columns[begin], &layer.values[begin], end - begin) + layer.biasWeights[i];
+	}
+	activate(m_ActType, m_ActPrecision, m_Sums.data(), outputs, layer.size);
+}
+
+// Explicit instantiations
+template class c_BasicSparseNetwork<float>;
+template class c_BasicSparseNetwork<double>;
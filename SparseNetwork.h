@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// SparseNetwork.h
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef SPARSENETWORK_H_
+#define SPARSENETWORK_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "AlignedBuffer.h"
+#include "NeuralNetwork.h"
+
+// One layer of a sparse network in compressed sparse row (CSR) form: the nonzero weights of each neuron's row
+// (excluding the bias weight, which is kept densely) with their input columns, row i spanning
+// [rowOffsets[i], rowOffsets[i + 1])
+template <typename T>
+struct s_SparseLayer {
+	size_t							size;
+	size_t							inputSize;
+	bool							bias;
+	c_AlignedBuffer<uint32_t>		rowOffsets;
+	c_AlignedBuffer<uint32_t>		columns;
+	c_AlignedBuffer<T>				values;
+	c_AlignedBuffer<T>				biasWeights;
+};
+
+// Compressed copy of a pruned network, for inference only. Only the nonzero weights are stored, and each sum of
+// products gathers just the inputs of those weights, so both the storage and the work scale with the nonzeros
+// (a pruned model can then fit in cache). The results match the pruned network's up to rounding. The scratch
+// arrays are members, so a sparse network must only be used by one thread at a time
+template <typename T>
+class c_BasicSparseNetwork {
+public:
+	// Constructors
+									c_BasicSparseNetwork();
+	// Destructor
+	virtual							~c_BasicSparseNetwork();
+	// Get
+	const size_t					getSize();
+	const size_t					getNumInputs();
+	const size_t					getNumOutputs();
+	const size_t					getNumNonzeros();
+	const size_t					getWeightBytes();
+	// Functions
+	bool							compress(c_BasicNeuralNetwork<T> &network);
+	void							infer(const T *inputs, T *outputs);
+	void							inferBatch(const T *inputs, const size_t &rows, T *outputs);
+private:
+	// Not copyable
+									c_BasicSparseNetwork(const c_BasicSparseNetwork &src);
+	c_BasicSparseNetwork&			operator=(const c_BasicSparseNetwork &src);
+	// Functions
+	void							_evaluateLayer(const s_SparseLayer<T> &layer, const T *inputs, T *outputs);
+	// Variables
+	std::vector<s_SparseLayer<T>>	m_Layers;
+	e_Activation					m_ActType;
+	e_ActPrecision					m_ActPrecision;
+	size_t							m_NumInputs;
+	c_AlignedBuffer<T>				m_Activations[2];
+	c_AlignedBuffer<T>				m_Sums;
+};
+
+typedef c_BasicSparseNetwork<double>	c_SparseNetwork;
+typedef c_BasicSparseNetwork<float>		c_SparseNetworkF;
+
+#endif SPARSENETWORK_H_
@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// SpscQueue.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <thread>
+
+#include "SpscQueue.h"
+
+c_SpscQueue::c_SpscQueue(const size_t &capacity) :
+	m_Head(0),
+	m_Tail(0)
+{
+	// Round the capacity up to a power of two, so positions wrap with a mask
+	size_t size = 1;
+	while (size < capacity) {
+		size <<= 1;
+	}
+	m_Values.resize(size);
+	m_Mask = size - 1;
+}
+
+c_SpscQueue::~c_SpscQueue()
+{
+}
+
+const size_t c_SpscQueue::getCapacity()
+{
+	return m_Values.size();
+}
+
+bool c_SpscQueue::tryPush(const size_t &value)
+{
+	// Producer only: returns false if the queue is full. The release store publishes the value with the tail
+	const size_t tail = m_Tail.load(std::memory_order_relaxed);
+	if ((tail - m_Head.load(std::memory_order_acquire)) == m_Values.size()) {
+		return false;
+	}
+	m_Values[tail & m_Mask] = value;
+	m_Tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+bool c_SpscQueue::tryPop(size_t &value)
+{
+	// Consumer only: returns false if the queue is empty. The release store hands the slot back to the producer
+	const size_t head = m_Head.load(std::memory_order_relaxed);
+	if (head == m_Tail.load(std::memory_order_acquire)) {
+		return false;
+	}
+	value = m_Values[head & m_Mask];
+	m_Head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+void c_SpscQueue::push(const size_t &value)
+{
+	// Spin until there is room, yielding so a waiting thread does not hold up the others on an oversubscribed core
+	while (!tryPush(value)) {
+		std::this_thread::yield();
+	}
+}
+
+size_t c_SpscQueue::pop()
+{
+	size_t value = 0;
+	while (!tryPop(value)) {
+		std::this_thread::yield();
+	}
+	return value;
+}
+
+void c_SpscQueue::clear()
+{
+	// Empty the queue; neither the producer nor the consumer may be using it
+	m_Head.store(0, std::memory_order_relaxed);
+	m_Tail.store(0, std::memory_order_relaxed);
+}
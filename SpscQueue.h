@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// SpscQueue.h
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef SPSCQUEUE_H_
+#define SPSCQUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "AlignedBuffer.h"
+
+// Bounded lock-free queue of indices between exactly one producer thread and one consumer thread: a ring buffer
+// whose head (written by the consumer only) and tail (written by the producer only) sit on separate cache lines
+class c_SpscQueue {
+public:
+	// Constructors
+									c_SpscQueue(const size_t &capacity);
+	// Destructor
+	virtual							~c_SpscQueue();
+	// Get
+	const size_t					getCapacity();
+	// Functions
+	bool							tryPush(const size_t &value);
+	bool							tryPop(size_t &value);
+	void							push(const size_t &value);
+	size_t							pop();
+	void							clear();
+private:
+	// Not copyable
+									c_SpscQueue(const c_SpscQueue &src);
+	c_SpscQueue&					operator=(const c_SpscQueue &src);
+	// Variables
+	std::vector<size_t>				m_Values;
+	size_t							m_Mask;
+	alignas(ALIGN_BYTES) std::atomic<size_t>	m_Head;
+	alignas(ALIGN_BYTES) std::atomic<size_t>	m_Tail;
+};
+
+#endif SPSCQUEUE_H_
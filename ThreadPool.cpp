@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// ThreadPool.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ThreadPool.h"
+
+c_ThreadPool::c_ThreadPool(const size_t &numThreads) :
+	m_Task(NULL),
+	m_NumTasks(0),
+	m_NextTask(0),
+	m_Pending(0),
+	m_Generation(0),
+	m_Stop(false)
+{
+	// The calling thread also works on each run, so only spawn the additional worker threads
+	for (size_t i = 1; i < numThreads; ++i) {
+		m_Threads.push_back(std::thread(&c_ThreadPool::_worker, this));
+	}
+}
+
+c_ThreadPool::~c_ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+	}
+	m_StartCondition.notify_all();
+	for (size_t i = 0; i < m_Threads.size(); ++i) {
+		m_Threads[i].join();
+	}
+}
+
+const size_t c_ThreadPool::getSize()
+{
+	return m_Threads.size() + 1;
+}
+
+void c_ThreadPool::run(const size_t &numTasks, const std::function<void(const size_t&)> &task)
+{
+	// Run task(0) to task(numTasks - 1) across the pool, returning once all tasks are complete
+	// Only one run may be in progress at a time, so a pool can be shared between networks
+	std::lock_guard<std::mutex> runLock(m_RunMutex);
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Task = &task;
+		m_NumTasks = numTasks;
+		m_NextTask = 0;
+		m_Pending = m_Threads.size();
+		++m_Generation;
+	}
+	m_StartCondition.notify_all();
+	_runTasks();
+	// Wait for the worker threads to finish their last tasks
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_DoneCondition.wait(lock, [this]() { return m_Pending == 0; });
+	m_Task = NULL;
+}
+
+void c_ThreadPool::_worker()
+{
+	size_t generation = 0;
+	for (;;) {
+		{
+			// Sleep until a new run is started (or the pool is destroyed)
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_StartCondition.wait(lock, [this, &generation]() { return m_Stop || (m_Generation != generation); });
+			if (m_Stop) {
+				return;
+			}
+			generation = m_Generation;
+		}
+		_runTasks();
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (--m_Pending == 0) {
+				m_DoneCondition.notify_one();
+			}
+		}
+	}
+}
+
+void c_ThreadPool::_runTasks()
+{
+	// Claim tasks until none remain; which thread runs which task has no effect on the results
+	for (size_t idx = m_NextTask++; idx < m_NumTasks; idx = m_NextTask++) {
+		(*m_Task)(idx);
+	}
+}
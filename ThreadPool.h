@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// ThreadPool.h
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class c_ThreadPool {
+public:
+	// Constructors
+									c_ThreadPool(const size_t &numThreads);
+	// Destructor
+	virtual							~c_ThreadPool();
+	// Get
+	const size_t					getSize();
+	// Functions
+	void							run(const size_t &numTasks, const std::function<void(const size_t&)> &task);
+private:
+	// Not copyable
+									c_ThreadPool(const c_ThreadPool &src);
+	c_ThreadPool&					operator=(const c_ThreadPool &src);
+	// Functions
+	void							_worker();
+	void							_runTasks();
+	// Variables
+	std::vector<std::thread>		m_Threads;
+	std::mutex						m_RunMutex;
+	std::mutex						m_Mutex;
+	std::condition_variable			m_StartCondition;
+	std::condition_variable			m_DoneCondition;
+	const std::function<void(const size_t&)>	*m_Task;
+	size_t							m_NumTasks;
+	std::atomic<size_t>				m_NextTask;
+	size_t							m_Pending;
+	size_t							m_Generation;
+	bool							m_Stop;
+};
+
+#endif THREADPOOL_H_
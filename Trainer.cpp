@@ -0,0 +1,188 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Trainer
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <thread>
+
+#include "Trainer.h"
+
+template <typename T>
+c_BasicTrainer<T>::c_BasicTrainer(c_BasicNeuralNetwork<T> &network, c_BasicDataReader<T> &reader, const size_t &chunkRows, const size_t &batchRows) :
+	m_Network(&network),
+	m_Reader(&reader),
+	m_ChunkRows((chunkRows > 0) ? chunkRows : 1),
+	m_BatchRows((batchRows > 0) ? batchRows : 1),
+	m_Samples(0),
+	m_LossSum(0.0),
+	m_Shuffle(true),
+	m_Error(false)
+{
+	// Allocate both chunk buffers up front
+	for (size_t slot = 0; slot < 2; ++slot) {
+		m_Inputs[slot].resize(m_ChunkRows * m_Reader->getNumInputs());
+		m_Targets[slot].resize(m_ChunkRows * m_Reader->getNumTargets());
+		m_Rows[slot] = 0;
+		m_Ready[slot] = false;
+	}
+}
+
+template <typename T>
+c_BasicTrainer<T>::~c_BasicTrainer()
+{
+}
+
+template <typename T>
+void c_BasicTrainer<T>::setShuffle(const bool &shuffle)
+{
+	m_Shuffle = shuffle;
+}
+
+template <typename T>
+void c_BasicTrainer<T>::setSeed(const unsigned int &seed)
+{
+	m_Random.seed(seed);
+}
+
+template <typename T>
+const size_t c_BasicTrainer<T>::getSamples()
+{
+	// Number of samples trained in the last epoch
+	return m_Samples;
+}
+
+template <typename T>
+const T c_BasicTrainer<T>::getLoss()
+{
+	// Mean squared error over the last epoch (of the outputs as evaluated just before each weight update)
+	const size_t numTargets = m_Reader->getNumTargets();
+	return (m_Samples > 0) ? (m_LossSum / static_cast<T>(m_Samples * numTargets)) : 0.0;
+}
+
+template <typename T>
+bool c_BasicTrainer<T>::trainEpoch()
+{
+	// Train over the whole dataset once; returns false if the dataset could not be read or does not match the network
+	m_Samples = 0;
+	m_LossSum = 0.0;
+	m_Error = false;
+	if ((m_Network->getNumInputs() != m_Reader->getNumInputs()) || ((*m_Network)[m_Network->getSize() - 1].getSize() != m_Reader->getNumTargets()) || !m_Reader->rewind()) {
+		return false;
+	}
+	for (size_t slot = 0; slot < 2; ++slot) {
+		m_Ready[slot] = false;
+	}
+	// Read ahead on a background thread, while this thread trains the chunks as they become ready
+	std::thread prefetch(&c_BasicTrainer<T>::_prefetch, this);
+	for (size_t slot = 0; ; slot ^= 1) {
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this, slot] { return m_Ready[slot]; });
+		}
+		if (m_Rows[slot] == 0) {
+			// End of the dataset (or a read error)
+			break;
+		}
+		_trainChunk(slot);
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Ready[slot] = false;
+		}
+		m_Condition.notify_all();
+	}
+	prefetch.join();
+	return !m_Error;
+}
+
+template <typename T>
+void c_BasicTrainer<T>::_prefetch()
+{
+	for (size_t slot = 0; ; slot ^= 1) {
+		{
+			// Wait for the trainer to finish with this buffer
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this, slot] { return !m_Ready[slot]; });
+		}
+		size_t rows = 0;
+		const bool success = m_Reader->read(m_Inputs[slot].data(), m_Targets[slot].data(), m_ChunkRows, rows);
+		m_Rows[slot] = success ? rows : 0;
+		if (m_Shuffle) {
+			_shuffleChunk(slot);
+		}
+		{
+			// Hand the buffer to the trainer (an empty buffer marks the end of the dataset)
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Error = !success;
+			m_Ready[slot] = true;
+		}
+		m_Condition.notify_all();
+		if (!success || (rows == 0)) {
+			break;
+		}
+	}
+}
+
+template <typename T>
+void c_BasicTrainer<T>::_shuffleChunk(const size_t &slot)
+{
+	// Fisher-Yates shuffle of the samples in this chunk, swapping whole input and target rows
+	const size_t numInputs = m_Reader->getNumInputs();
+	const size_t numTargets = m_Reader->getNumTargets();
+	T *inputs = m_Inputs[slot].data();
+	T *targets = m_Targets[slot].data();
+	for (size_t r = m_Rows[slot]; r > 1; --r) {
+		const size_t j = std::uniform_int_distribution<size_t>(0, r - 1)(m_Random);
+		if (j != (r - 1)) {
+			std::swap_ranges(inputs + ((r - 1) * numInputs), inputs + (r * numInputs), inputs + (j * numInputs));
+			std::swap_ranges(targets + ((r - 1) * numTargets), targets + (r * numTargets), targets + (j * numTargets));
+		}
+	}
+}
+
+template <typename T>
+void c_BasicTrainer<T>::_trainChunk(const size_t &slot)
+{
+	// Train the chunk in mini-batches, accumulating the squared error of each batch's outputs
+	const size_t numInputs = m_Reader->getNumInputs();
+	const size_t numTargets = m_Reader->getNumTargets();
+	c_BasicPerceptronLayer<T> &outputLayer = (*m_Network)[m_Network->getSize() - 1];
+	for (size_t begin = 0; begin < m_Rows[slot]; begin += m_BatchRows) {
+		const size_t rows = ((begin + m_BatchRows) < m_Rows[slot]) ? m_BatchRows : (m_Rows[slot] - begin);
+		const T *targets = &m_Targets[slot][begin * numTargets];
+		m_Network->trainBatch(&m_Inputs[slot][begin * numInputs], targets, rows);
+		for (size_t r = 0; r < rows; ++r) {
+			const T *outputs = outputLayer.getBatchOutputs() + (r * outputLayer.getBatchStride());
+			for (size_t i = 0; i < numTargets; ++i) {
+				const T error = targets[(r * numTargets) + i] - outputs[i];
+				m_LossSum += error * error;
+			}
+		}
+		m_Samples += rows;
+	}
+}
+
+// Explicit instantiations
+template class c_BasicTrainer<float>;
+template class c_BasicTrainer<double>;
@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Trainer
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRAINER_H_
+#define TRAINER_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <random>
+
+#include "AlignedBuffer.h"
+#include "DataReader.h"
+#include "NeuralNetwork.h"
+
+// Trains a network over a dataset streamed from disk. Samples are read in chunks, shuffled within each chunk
+// (the shuffle window) and trained in mini-batches, while a background thread reads and shuffles the next chunk
+// into the other of two buffers
+template <typename T>
+class c_BasicTrainer {
+public:
+	// Constructors
+									c_BasicTrainer(c_BasicNeuralNetwork<T> &network, c_BasicDataReader<T> &reader, const size_t &chunkRows, const size_t &batchRows);
+	// Destructor
+	virtual							~c_BasicTrainer();
+	// Set
+	void							setShuffle(const bool &shuffle);
+	void							setSeed(const unsigned int &seed);
+	// Get
+	const size_t					getSamples();
+	const T							getLoss();
+	// Functions
+	bool							trainEpoch();
+private:
+	// Not copyable
+									c_BasicTrainer(const c_BasicTrainer &src);
+	c_BasicTrainer&					operator=(const c_BasicTrainer &src);
+	// Functions
+	void							_prefetch();
+	void							_shuffleChunk(const size_t &slot);
+	void							_trainChunk(const size_t &slot);
+	// Variables
+	c_BasicNeuralNetwork<T>			*m_Network;
+	c_BasicDataReader<T>			*m_Reader;
+	c_AlignedBuffer<T>				m_Inputs[2];
+	c_AlignedBuffer<T>				m_Targets[2];
+	size_t							m_Rows[2];
+	bool							m_Ready[2];
+	std::mutex						m_Mutex;
+	std::condition_variable			m_Condition;
+	std::mt19937					m_Random;
+	size_t							m_ChunkRows;
+	size_t							m_BatchRows;
+	size_t							m_Samples;
+	T								m_LossSum;
+	bool							m_Shuffle;
+	bool							m_Error;
+};
+
+typedef c_BasicTrainer<double>		c_Trainer;
+typedef c_BasicTrainer<float>		c_TrainerF;
+
+#endif TRAINER_H_
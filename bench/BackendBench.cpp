@@ -0,0 +1,232 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// BackendBench.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Parity and speed of the GEMM backends, written to stdout as JSON. For each backend the library was built with,
+// times the layer-shaped products (the batch forward, backward and weight update products, the matrix-vector
+// product and the rank-1 update) in GFLOP/s, with the largest relative difference from the reference backend, then
+// trains the same network with each backend and reports the largest difference in its outputs. Exits with 1 if any
+// backend differs from the reference by more than the tolerance for the type
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Gemm.h"
+#include "NeuralNetwork.h"
+
+// Minimum time spent measuring each product (seconds)
+static double g_MinTime = 0.05;
+// Set when a backend fails the parity check
+static bool g_Failed = false;
+
+template <typename F>
+static double timePass(F pass)
+{
+	// Repeat the pass until enough time has elapsed for a stable measurement, returning seconds per pass
+	typedef std::chrono::steady_clock t_Clock;
+	size_t iterations = 1;
+	for (;;) {
+		const t_Clock::time_point start = t_Clock::now();
+		for (size_t i = 0; i < iterations; ++i) {
+			pass();
+		}
+		const double seconds = std::chrono::duration<double>(t_Clock::now() - start).count();
+		if (seconds > g_MinTime) {
+			return seconds / static_cast<double>(iterations);
+		}
+		iterations *= 2;
+	}
+}
+
+template <typename T>
+static double tolerance()
+{
+	// Differences in the order of the sums only, scaled up for the depth of the products and the training steps
+	return (sizeof(T) == sizeof(float)) ? 1.0e-3 : 1.0e-9;
+}
+
+template <typename T>
+static double maxRelDifference(const std::vector<T> &x, const std::vector<T> &y)
+{
+	double maxDiff = 0.0;
+	for (size_t i = 0; i < x.size(); ++i) {
+		const double scale = std::fabs(static_cast<double>(y[i])) + 1.0;
+		const double diff = std::fabs(static_cast<double>(x[i]) - static_cast<double>(y[i])) / scale;
+		maxDiff = (diff > maxDiff) ? diff : maxDiff;
+	}
+	return maxDiff;
+}
+
+template <typename T>
+static void fillRandom(std::vector<T> &values)
+{
+	for (size_t i = 0; i < values.size(); ++i) {
+		values[i] = (static_cast<T>(2.0) * static_cast<T>(rand()) / RAND_MAX) - static_cast<T>(1.0);
+	}
+}
+
+template <typename T>
+static void printResult(const char *typeName, const char *op, const size_t &m, const size_t &n, const size_t &k,
+						const e_GemmBackend &backend, const double &gflops, const double &error, bool &first)
+{
+	const bool pass = (error <= tolerance<T>());
+	g_Failed = g_Failed || !pass;
+	printf("%s\n    {\"type\": \"%s\", \"op\": \"%s\", \"m\": %zu, \"n\": %zu, \"k\": %zu, \"backend\": \"%s\", \"gflops\": %.2f, \"error\": %.3g, \"pass\": %s}",
+		first ? "" : ",", typeName, op, m, n, k, getGemmBackendName(backend), gflops, error, pass ? "true" : "false");
+	fflush(stdout);
+	first = false;
+}
+
+template <typename T>
+static void benchProducts(const char *typeName, const size_t &rows, const size_t &width, const size_t &numInputs, bool &first)
+{
+	// The products of one layer of width perceptrons over numInputs inputs, for a batch of rows
+	std::vector<T> inputs(rows * numInputs);
+	std::vector<T> weights(width * numInputs);
+	std::vector<T> deltas(rows * width);
+	fillRandom(inputs);
+	fillRandom(weights);
+	fillRandom(deltas);
+	const double flops = 2.0 * rows * width * numInputs;
+	std::vector<T> sums(rows * width);
+	std::vector<T> deltaSums(rows * numInputs);
+	std::vector<T> gradients(width * numInputs);
+	std::vector<T> vector(width);
+	std::vector<T> updated(weights);
+	std::vector<T> refSums;
+	std::vector<T> refDeltaSums;
+	std::vector<T> refGradients;
+	std::vector<T> refVector;
+	std::vector<T> refUpdated;
+	for (int b = GEMM_REFERENCE; b <= GEMM_BLAS; ++b) {
+		const e_GemmBackend backend = static_cast<e_GemmBackend>(b);
+		if (!setGemmBackend(backend)) {
+			continue;
+		}
+		const T one = 1.0;
+		const T zero = 0.0;
+		const T rate = static_cast<T>(1.0e-3);
+		const double forward = timePass([&]() { gemm<T>(false, true, rows, width, numInputs, one, inputs.data(), numInputs, weights.data(), numInputs, zero, sums.data(), width); });
+		const double backward = timePass([&]() { gemm<T>(false, false, rows, numInputs, width, one, deltas.data(), width, weights.data(), numInputs, zero, deltaSums.data(), numInputs); });
+		const double update = timePass([&]() { gemm<T>(true, false, width, numInputs, rows, one, deltas.data(), width, inputs.data(), numInputs, zero, gradients.data(), numInputs); });
+		const double matVec = timePass([&]() { gemv<T>(false, width, numInputs, one, weights.data(), numInputs, inputs.data(), zero, vector.data()); });
+		// The rank-1 update is timed on a scratch copy, and checked from a fresh one
+		const double rankOne = timePass([&]() { ger<T>(width, numInputs, rate, deltas.data(), inputs.data(), updated.data(), numInputs); });
+		updated = weights;
+		ger<T>(width, numInputs, rate, deltas.data(), inputs.data(), updated.data(), numInputs);
+		if (backend == GEMM_REFERENCE) {
+			refSums = sums;
+			refDeltaSums = deltaSums;
+			refGradients = gradients;
+			refVector = vector;
+			refUpdated = updated;
+		}
+		printResult<T>(typeName, "forward", rows, width, numInputs, backend, flops / (forward * 1.0e9), maxRelDifference(sums, refSums), first);
+		printResult<T>(typeName, "backward", rows, numInputs, width, backend, flops / (backward * 1.0e9), maxRelDifference(deltaSums, refDeltaSums), first);
+		printResult<T>(typeName, "update", width, numInputs, rows, backend, flops / (update * 1.0e9), maxRelDifference(gradients, refGradients), first);
+		printResult<T>(typeName, "gemv", width, 1, numInputs, backend, (2.0 * width * numInputs) / (matVec * 1.0e9), maxRelDifference(vector, refVector), first);
+		printResult<T>(typeName, "ger", width, numInputs, 1, backend, (2.0 * width * numInputs) / (rankOne * 1.0e9), maxRelDifference(updated, refUpdated), first);
+		updated = weights;
+	}
+}
+
+template <typename T>
+static void trainNetwork(const size_t &numInputs, const size_t &width, const size_t &rows, std::vector<T> &outputs)
+{
+	// Train from the same weights with samples (step) then batches (trainBatch), returning the outputs for every sample
+	const size_t numOutputs = 10;
+	std::valarray<T> inputs(numInputs);
+	std::valarray<T> targets(numOutputs);
+	std::vector<size_t> layers(2, width);
+	layers.push_back(numOutputs);
+	c_BasicNeuralNetwork<T> network(inputs, targets, layers, ACT_TANH, static_cast<T>(0.01), true);
+	network.initWeights(c_BasicInitializer<T>(INIT_XAVIER_UNIFORM, 1));
+	srand(2);
+	std::vector<T> samples(rows * numInputs);
+	std::vector<T> labels(rows * numOutputs);
+	fillRandom(samples);
+	fillRandom(labels);
+	for (size_t r = 0; r < rows; ++r) {
+		for (size_t i = 0; i < numInputs; ++i) {
+			inputs[i] = samples[(r * numInputs) + i];
+		}
+		for (size_t i = 0; i < numOutputs; ++i) {
+			targets[i] = labels[(r * numOutputs) + i];
+		}
+		network.step();
+	}
+	for (size_t epoch = 0; epoch < 4; ++epoch) {
+		network.trainBatch(samples.data(), labels.data(), rows);
+	}
+	outputs.resize(rows * numOutputs);
+	network.evaluateBatch(samples.data(), rows, outputs.data());
+}
+
+template <typename T>
+static void checkNetwork(const char *typeName, const size_t &numInputs, const size_t &width, const size_t &rows, bool &first)
+{
+	std::vector<T> outputs;
+	std::vector<T> refOutputs;
+	for (int b = GEMM_REFERENCE; b <= GEMM_BLAS; ++b) {
+		const e_GemmBackend backend = static_cast<e_GemmBackend>(b);
+		if (!setGemmBackend(backend)) {
+			continue;
+		}
+		trainNetwork<T>(numInputs, width, rows, outputs);
+		if (backend == GEMM_REFERENCE) {
+			refOutputs = outputs;
+		}
+		printResult<T>(typeName, "network", rows, width, numInputs, backend, 0.0, maxRelDifference(outputs, refOutputs), first);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	// --quick shortens every measurement (for smoke testing the benchmark itself)
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--quick") == 0) {
+			g_MinTime = 0.002;
+		}
+	}
+	const e_GemmBackend defaultBackend = getGemmBackend();
+	// Batch rows, layer width and inputs of each set of products
+	const size_t shapes[][3] = { { 32, 128, 64 }, { 256, 256, 784 }, { 256, 1024, 1024 } };
+	printf("{\n  \"benchmark\": \"backends\",\n  \"default\": \"%s\",\n  \"results\": [", getGemmBackendName(defaultBackend));
+	bool first = true;
+	srand(1);
+	for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); ++s) {
+		benchProducts<double>("double", shapes[s][0], shapes[s][1], shapes[s][2], first);
+		benchProducts<float>("float", shapes[s][0], shapes[s][1], shapes[s][2], first);
+	}
+	checkNetwork<double>("double", 64, 128, 256, first);
+	checkNetwork<float>("float", 64, 128, 256, first);
+	printf("\n  ],\n  \"parity\": %s\n}\n", g_Failed ? "false" : "true");
+	setGemmBackend(defaultBackend);
+	return g_Failed ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// KernelBench.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Microbenchmark for the vector kernels, reporting GFLOP/s for each SIMD level and layer width
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "AlignedBuffer.h"
+#include "Kernels.h"
+
+// Prevents the compiler from optimising away the benchmarked work
+static volatile double g_Sink = 0.0;
+
+template <typename F>
+static double timeKernel(const size_t &flopsPerCall, F kernel)
+{
+	// Repeat the kernel until enough time has elapsed for a stable measurement, returning GFLOP/s
+	typedef std::chrono::steady_clock t_Clock;
+	size_t iterations = 1;
+	for (;;) {
+		const t_Clock::time_point start = t_Clock::now();
+		for (size_t i = 0; i < iterations; ++i) {
+			kernel();
+		}
+		const double seconds = std::chrono::duration<double>(t_Clock::now() - start).count();
+		if (seconds > 0.1) {
+			return (static_cast<double>(flopsPerCall) * iterations) / (seconds * 1.0e9);
+		}
+		iterations *= 2;
+	}
+}
+
+template <typename T>
+static void benchKernels(const char *typeName, const e_SimdLevel &level, const size_t &n)
+{
+	c_AlignedBuffer<T> x;
+	c_AlignedBuffer<T> y;
+	x.resize(n);
+	y.resize(n);
+	for (size_t i = 0; i < n; ++i) {
+		x[i] = static_cast<T>(1.0) / static_cast<T>(i + 1);
+		y[i] = static_cast<T>(1.0) - x[i];
+	}
+	const T alpha = static_cast<T>(1.0e-6);
+	const T one = static_cast<T>(1.0);
+	const double dot = timeKernel(2 * n, [&]() { g_Sink = kernelDot(x.data(), y.data(), n); });
+	const double axpy = timeKernel(2 * n, [&]() { kernelAxpy(alpha, x.data(), y.data(), n); });
+	const double scale = timeKernel(n, [&]() { kernelScale(one, x.data(), y.data(), n); });
+	printf("%-8s %-8s %8zu %12.2f %12.2f %12.2f\n", getSimdLevelName(level), typeName, n, dot, axpy, scale);
+}
+
+int main()
+{
+	const size_t widths[] = { 8, 16, 33, 64, 128, 256, 512, 1024, 4096, 16384 };
+	const size_t numWidths = sizeof(widths) / sizeof(widths[0]);
+	const e_SimdLevel maxLevel = getMaxSimdLevel();
+	printf("%-8s %-8s %8s %12s %12s %12s\n", "simd", "type", "width", "dot GF/s", "axpy GF/s", "scale GF/s");
+	for (int level = SIMD_SCALAR; level <= maxLevel; ++level) {
+		const e_SimdLevel simdLevel = static_cast<e_SimdLevel>(level);
+		setSimdLevel(simdLevel);
+		for (size_t w = 0; w < numWidths; ++w) {
+			benchKernels<double>("double", simdLevel, widths[w]);
+			benchKernels<float>("float", simdLevel, widths[w]);
+		}
+	}
+	return 0;
+}
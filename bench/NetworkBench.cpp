@@ -0,0 +1,180 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// NetworkBench.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Benchmark of c_NeuralNetwork evaluate(), train() and step() across topologies, written to stdout as JSON.
+// Reports samples/sec, ns per forward and backward pass and per fused step, heap allocations per step and peak RSS,
+// then the samples/sec of online training on deep, narrow networks with step() against c_PipelineTrainer by stages.
+// Exits with 1 if evaluate() and train() allocate once warmed up (tests/AllocTest checks every training path)
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "Kernels.h"
+#include "NeuralNetwork.h"
+#include "PipelineTrainer.h"
+#include "tests/AllocCounter.h"
+
+// Set when any pass allocates once warmed up
+static bool g_Allocated = false;
+
+// Minimum time spent measuring each pass (seconds)
+static double g_MinTime = 0.05;
+
+template <typename F>
+static double timePass(F pass)
+{
+	// Repeat the pass until enough time has elapsed for a stable measurement, returning ns per pass
+	typedef std::chrono::steady_clock t_Clock;
+	size_t iterations = 1;
+	for (;;) {
+		const t_Clock::time_point start = t_Clock::now();
+		for (size_t i = 0; i < iterations; ++i) {
+			pass();
+		}
+		const double seconds = std::chrono::duration<double>(t_Clock::now() - start).count();
+		if (seconds > g_MinTime) {
+			return (seconds * 1.0e9) / static_cast<double>(iterations);
+		}
+		iterations *= 2;
+	}
+}
+
+static long peakRssKb()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+template <typename T>
+static void benchNetwork(const char *typeName, const size_t &width, const size_t &depth, const bool &bias, const e_Activation &actType, const bool &first)
+{
+	std::valarray<T> inputs(width);
+	std::valarray<T> targets(width);
+	for (size_t i = 0; i < width; ++i) {
+		inputs[i] = static_cast<T>(i % 7) / static_cast<T>(7.0);
+		targets[i] = static_cast<T>(i % 3) / static_cast<T>(3.0);
+	}
+	std::vector<size_t> layers(depth, width);
+	c_BasicNeuralNetwork<T> network(inputs, targets, layers, actType, static_cast<T>(0.01), bias);
+	// Xavier weights keep the activations out of saturation at every width, so the timings are not skewed by denormals
+	network.initWeights(c_BasicInitializer<T>(INIT_XAVIER_UNIFORM, 1));
+	// Warm up (first passes may size scratch buffers), then count the allocations of a fixed number of steps
+	const size_t steps = 100;
+	for (size_t i = 0; i < 10; ++i) {
+		network.evaluate();
+		network.train();
+	}
+	const size_t allocations = g_Allocations;
+	for (size_t i = 0; i < steps; ++i) {
+		network.evaluate();
+		network.train();
+	}
+	const double allocationsPerStep = static_cast<double>(g_Allocations - allocations) / static_cast<double>(steps);
+	g_Allocated = g_Allocated || (allocationsPerStep > 0.0);
+	const double forwardNs = timePass([&]() { network.evaluate(); });
+	const double backwardNs = timePass([&]() { network.train(); });
+	const double stepNs = timePass([&]() { network.step(); });
+	printf("%s\n    {\"type\": \"%s\", \"width\": %zu, \"depth\": %zu, \"bias\": %s, \"activation\": \"%s\", "
+		"\"samples_per_sec\": %.1f, \"forward_ns\": %.1f, \"backward_ns\": %.1f, \"step_ns\": %.1f, \"allocations_per_step\": %.2f, \"peak_rss_kb\": %ld}",
+		first ? "" : ",", typeName, width, depth, bias ? "true" : "false", (actType == ACT_TANH) ? "tanh" : "sigmoid",
+		1.0e9 / (forwardNs + backwardNs), forwardNs, backwardNs, stepNs, allocationsPerStep, peakRssKb());
+	fflush(stdout);
+}
+
+template <typename T>
+static void benchPipeline(const char *typeName, const size_t &width, const size_t &depth, const bool &first)
+{
+	// Online training over a block of rows, one step() per row, then through the pipeline at each stage count
+	const size_t rows = 256;
+	std::valarray<T> inputs(width);
+	std::valarray<T> targets(width);
+	std::vector<T> inputRows(rows * width);
+	std::vector<T> targetRows(rows * width);
+	for (size_t i = 0; i < (rows * width); ++i) {
+		inputRows[i] = static_cast<T>(i % 7) / static_cast<T>(7.0);
+		targetRows[i] = static_cast<T>(i % 3) / static_cast<T>(3.0);
+	}
+	std::vector<size_t> layers(depth, width);
+	c_BasicNeuralNetwork<T> network(inputs, targets, layers, ACT_TANH, static_cast<T>(0.01), true);
+	network.initWeights(c_BasicInitializer<T>());
+	const double stepNs = timePass([&]() {
+		for (size_t r = 0; r < rows; ++r) {
+			for (size_t i = 0; i < width; ++i) {
+				inputs[i] = inputRows[(r * width) + i];
+				targets[i] = targetRows[(r * width) + i];
+			}
+			network.step();
+		}
+	});
+	printf("%s\n    {\"type\": \"%s\", \"width\": %zu, \"depth\": %zu, \"stages\": 0, \"samples_per_sec\": %.1f}",
+		first ? "" : ",", typeName, width, depth, (1.0e9 * rows) / stepNs);
+	for (size_t stages = 1; stages <= depth; stages *= 2) {
+		c_BasicPipelineTrainer<T> pipeline(network, stages);
+		const double pipelineNs = timePass([&]() { pipeline.train(inputRows.data(), targetRows.data(), rows); });
+		printf(",\n    {\"type\": \"%s\", \"width\": %zu, \"depth\": %zu, \"stages\": %zu, \"samples_per_sec\": %.1f}",
+			typeName, width, depth, pipeline.getNumStages(), (1.0e9 * rows) / pipelineNs);
+	}
+	fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+	// --quick shortens every measurement (for smoke testing the benchmark itself)
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--quick") == 0) {
+			g_MinTime = 0.002;
+		}
+	}
+	const size_t widths[] = { 16, 64, 256 };
+	const size_t depths[] = { 1, 2, 4 };
+	const e_Activation actTypes[] = { ACT_TANH, ACT_SIGMOID };
+	printf("{\n  \"benchmark\": \"network\",\n  \"simd\": \"%s\",\n  \"results\": [", getSimdLevelName(getSimdLevel()));
+	bool first = true;
+	for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); ++w) {
+		for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); ++d) {
+			for (int bias = 0; bias < 2; ++bias) {
+				for (size_t a = 0; a < sizeof(actTypes) / sizeof(actTypes[0]); ++a) {
+					benchNetwork<double>("double", widths[w], depths[d], bias != 0, actTypes[a], first);
+					benchNetwork<float>("float", widths[w], depths[d], bias != 0, actTypes[a], false);
+					first = false;
+				}
+			}
+		}
+	}
+	// Stages 0 is step() on the calling thread alone
+	printf("\n  ],\n  \"cores\": %u,\n  \"pipeline\": [", std::thread::hardware_concurrency());
+	benchPipeline<double>("double", 64, 8, true);
+	benchPipeline<float>("float", 64, 8, false);
+	benchPipeline<float>("float", 256, 8, false);
+	printf("\n  ]\n}\n");
+	return g_Allocated ? 1 : 0;
+}
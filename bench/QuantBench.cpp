@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// QuantBench
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Accuracy and speed of int8 quantized inference against the floating point network, written to stdout as JSON.
+// Reports the output errors, how often the largest output agrees, the weights storage and ns per sample
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Kernels.h"
+#include "QuantizedNetwork.h"
+
+// Minimum time spent measuring each pass (seconds)
+static double g_MinTime = 0.05;
+
+template <typename F>
+static double timePass(F pass)
+{
+	// Repeat the pass until enough time has elapsed for a stable measurement, returning ns per pass
+	typedef std::chrono::steady_clock t_Clock;
+	size_t iterations = 1;
+	for (;;) {
+		const t_Clock::time_point start = t_Clock::now();
+		for (size_t i = 0; i < iterations; ++i) {
+			pass();
+		}
+		const double seconds = std::chrono::duration<double>(t_Clock::now() - start).count();
+		if (seconds > g_MinTime) {
+			return (seconds * 1.0e9) / static_cast<double>(iterations);
+		}
+		iterations *= 2;
+	}
+}
+
+template <typename T>
+static void benchQuantized(const char *typeName, const size_t &width, const e_QuantScale &scale, const bool &first)
+{
+	const size_t numInputs = 32;
+	const size_t numOutputs = 10;
+	const size_t rows = 1024;
+	std::valarray<T> inputs(numInputs);
+	std::valarray<T> targets(numOutputs);
+	std::vector<size_t> layers(2, width);
+	layers.push_back(numOutputs);
+	c_BasicNeuralNetwork<T> network(inputs, targets, layers, ACT_TANH, static_cast<T>(0.01), true);
+	network.setActPrecision(ACTP_APPROX);
+	// Weights uniform in +-1/sqrt(fan in), so the hidden activations stay away from saturation
+	srand(1);
+	for (size_t l = 0; l < network.getSize(); ++l) {
+		std::valarray<T> weights(network[l].getInputSize());
+		const T range = static_cast<T>(1.0) / std::sqrt(static_cast<T>(weights.size()));
+		for (size_t p = 0; p < network[l].getSize(); ++p) {
+			for (size_t i = 0; i < weights.size(); ++i) {
+				weights[i] = range * ((static_cast<T>(2.0) * static_cast<T>(rand()) / RAND_MAX) - static_cast<T>(1.0));
+			}
+			network[l][p].setWeights(weights);
+		}
+	}
+	std::vector<T> samples(rows * numInputs);
+	for (size_t i = 0; i < samples.size(); ++i) {
+		samples[i] = (static_cast<T>(2.0) * static_cast<T>(rand()) / RAND_MAX) - static_cast<T>(1.0);
+	}
+	c_BasicQuantizedNetwork<T> quantized;
+	quantized.setScale(scale);
+	quantized.quantize(network);
+	// Calibrate on the first quarter of the samples, and compare on all of them
+	quantized.calibrate(network, samples.data(), rows / 4);
+	s_QuantReport report;
+	quantized.compare(network, samples.data(), rows, report);
+	std::vector<T> outputs(rows * numOutputs);
+	const double networkNs = timePass([&]() { network.evaluateBatch(samples.data(), rows, outputs.data()); }) / rows;
+	const double quantizedNs = timePass([&]() { quantized.inferBatch(samples.data(), rows, outputs.data()); }) / rows;
+	const double singleNs = timePass([&]() { quantized.infer(samples.data(), outputs.data()); });
+	printf("%s\n    {\"type\": \"%s\", \"width\": %zu, \"scale\": \"%s\", \"max_error\": %.6f, \"mean_error\": %.6f, \"rms_error\": %.6f, "
+		"\"agreement\": %.4f, \"network_bytes\": %zu, \"quantized_bytes\": %zu, \"network_ns\": %.1f, \"quantized_ns\": %.1f, \"quantized_single_ns\": %.1f}",
+		first ? "" : ",", typeName, width, (scale == QUANT_PER_LAYER) ? "layer" : "neuron", report.maxError, report.meanError, report.rmsError,
+		report.agreement, report.networkBytes, report.quantizedBytes, networkNs, quantizedNs, singleNs);
+	fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+	// --quick shortens every measurement (for smoke testing the benchmark itself)
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--quick") == 0) {
+			g_MinTime = 0.002;
+		}
+	}
+	const size_t widths[] = { 64, 256, 1024 };
+	const e_QuantScale scales[] = { QUANT_PER_LAYER, QUANT_PER_NEURON };
+	printf("{\n  \"benchmark\": \"quantized\",\n  \"simd\": \"%s\",\n  \"results\": [", getSimdLevelName(getSimdLevel()));
+	bool first = true;
+	for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); ++w) {
+		for (size_t s = 0; s < sizeof(scales) / sizeof(scales[0]); ++s) {
+			benchQuantized<double>("double", widths[w], scales[s], first);
+			benchQuantized<float>("float", widths[w], scales[s], false);
+			first = false;
+		}
+	}
+	printf("\n  ]\n}\n");
+	return 0;
+}
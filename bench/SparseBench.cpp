@@ -0,0 +1,154 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// SparseBench
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Dense against sparse inference after magnitude pruning, written to stdout as JSON. For each sparsity, reports
+// the weights storage and ns per sample of the pruned network (dense) and its compressed copy (sparse), the
+// largest difference between their outputs, and the largest output change from pruning (before fine-tuning)
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Kernels.h"
+#include "SparseNetwork.h"
+
+// Minimum time spent measuring each pass (seconds)
+static double g_MinTime = 0.05;
+
+template <typename F>
+static double timePass(F pass)
+{
+	// Repeat the pass until enough time has elapsed for a stable measurement, returning ns per pass
+	typedef std::chrono::steady_clock t_Clock;
+	size_t iterations = 1;
+	for (;;) {
+		const t_Clock::time_point start = t_Clock::now();
+		for (size_t i = 0; i < iterations; ++i) {
+			pass();
+		}
+		const double seconds = std::chrono::duration<double>(t_Clock::now() - start).count();
+		if (seconds > g_MinTime) {
+			return (seconds * 1.0e9) / static_cast<double>(iterations);
+		}
+		iterations *= 2;
+	}
+}
+
+template <typename T>
+static double maxDifference(const std::vector<T> &x, const std::vector<T> &y)
+{
+	double maxDiff = 0.0;
+	for (size_t i = 0; i < x.size(); ++i) {
+		const double diff = std::fabs(static_cast<double>(x[i]) - static_cast<double>(y[i]));
+		maxDiff = (diff > maxDiff) ? diff : maxDiff;
+	}
+	return maxDiff;
+}
+
+template <typename T>
+static void benchSparse(const char *typeName, const size_t &width, const double &sparsity, const bool &first)
+{
+	const size_t numInputs = 256;
+	const size_t numOutputs = 10;
+	const size_t rows = 256;
+	std::valarray<T> inputs(numInputs);
+	std::valarray<T> targets(numOutputs);
+	std::vector<size_t> layers(2, width);
+	layers.push_back(numOutputs);
+	c_BasicNeuralNetwork<T> network(inputs, targets, layers, ACT_TANH, static_cast<T>(0.01), true);
+	network.setActPrecision(ACTP_APPROX);
+	// Weights uniform in +-1/sqrt(fan in), so the hidden activations stay away from saturation
+	srand(1);
+	for (size_t l = 0; l < network.getSize(); ++l) {
+		std::valarray<T> weights(network[l].getInputSize());
+		const T range = static_cast<T>(1.0) / std::sqrt(static_cast<T>(weights.size()));
+		for (size_t p = 0; p < network[l].getSize(); ++p) {
+			for (size_t i = 0; i < weights.size(); ++i) {
+				weights[i] = range * ((static_cast<T>(2.0) * static_cast<T>(rand()) / RAND_MAX) - static_cast<T>(1.0));
+			}
+			network[l][p].setWeights(weights);
+		}
+	}
+	std::vector<T> samples(rows * numInputs);
+	for (size_t i = 0; i < samples.size(); ++i) {
+		samples[i] = (static_cast<T>(2.0) * static_cast<T>(rand()) / RAND_MAX) - static_cast<T>(1.0);
+	}
+	std::vector<T> original(rows * numOutputs);
+	std::vector<T> dense(rows * numOutputs);
+	std::vector<T> sparse(rows * numOutputs);
+	network.evaluateBatch(samples.data(), rows, original.data());
+	// Prune each layer to the same sparsity (the output layer's weights are smaller, so pruning the whole network
+	// by one threshold would remove it first)
+	for (size_t l = 0; l < network.getSize(); ++l) {
+		network[l].pruneFraction(static_cast<T>(sparsity));
+	}
+	c_BasicSparseNetwork<T> sparseNetwork;
+	sparseNetwork.compress(network);
+	network.evaluateBatch(samples.data(), rows, dense.data());
+	sparseNetwork.inferBatch(samples.data(), rows, sparse.data());
+	const double sparseError = maxDifference(dense, sparse);
+	const double pruningError = maxDifference(original, dense);
+	// Time single samples through the thread-safe dense path, the closest counterpart of the sparse network
+	c_BasicExecContext<T> context(network);
+	size_t row = 0;
+	const double denseNs = timePass([&]() { network.infer(&samples[row * numInputs], &dense[0], context); row = (row + 1) % rows; });
+	const double sparseNs = timePass([&]() { sparseNetwork.infer(&samples[row * numInputs], &sparse[0]); row = (row + 1) % rows; });
+	size_t denseBytes = 0;
+	for (size_t l = 0; l < network.getSize(); ++l) {
+		denseBytes += network[l].getSize() * network[l].getStride() * sizeof(T);
+	}
+	printf("%s\n    {\"type\": \"%s\", \"width\": %zu, \"sparsity\": %.2f, \"pruned\": %zu, \"weights\": %zu, \"dense_bytes\": %zu, \"sparse_bytes\": %zu, "
+		"\"dense_ns\": %.1f, \"sparse_ns\": %.1f, \"sparse_error\": %.3g, \"pruning_error\": %.6f}",
+		first ? "" : ",", typeName, width, sparsity, network.getNumPruned(), network.getNumWeights(), denseBytes, sparseNetwork.getWeightBytes(),
+		denseNs, sparseNs, sparseError, pruningError);
+	fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+	// --quick shortens every measurement (for smoke testing the benchmark itself)
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--quick") == 0) {
+			g_MinTime = 0.002;
+		}
+	}
+	const size_t widths[] = { 256, 1024 };
+	const double sparsities[] = { 0.0, 0.5, 0.8, 0.9, 0.95 };
+	printf("{\n  \"benchmark\": \"sparse\",\n  \"simd\": \"%s\",\n  \"results\": [", getSimdLevelName(getSimdLevel()));
+	bool first = true;
+	for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); ++w) {
+		for (size_t s = 0; s < sizeof(sparsities) / sizeof(sparsities[0]); ++s) {
+			benchSparse<double>("double", widths[w], sparsities[s], first);
+			benchSparse<float>("float", widths[w], sparsities[s], false);
+			first = false;
+		}
+	}
+	printf("\n  ]\n}\n");
+	return 0;
+}
@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// AllocTest.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Allocation regression test: counts every heap allocation (see AllocCounter.h), and fails (exit 1) if
+// evaluate(), train(), step(), evaluateBatch() or trainBatch() allocate anything once the network is warmed up
+
+#include <cstdio>
+#include <vector>
+
+#include "AllocCounter.h"
+#include "NeuralNetwork.h"
+
+template <typename F>
+static bool checkNoAllocations(const char *typeName, const char *pass, const size_t &depth, const bool &bias, const size_t &threads, const bool &optimizer, F run)
+{
+	// Warm up (first passes may size scratch buffers), then count the allocations of a fixed number of passes
+	for (size_t i = 0; i < 4; ++i) {
+		run();
+	}
+	const size_t allocations = g_Allocations;
+	for (size_t i = 0; i < 16; ++i) {
+		run();
+	}
+	const size_t count = g_Allocations - allocations;
+	if (count > 0) {
+		printf("FAIL %s %s depth %zu bias %d threads %zu optimizer %d: %zu allocations in 16 passes\n",
+			typeName, pass, depth, bias ? 1 : 0, threads, optimizer ? 1 : 0, count);
+		return false;
+	}
+	return true;
+}
+
+template <typename T>
+static bool testNetwork(const char *typeName, const size_t &depth, const bool &bias, const size_t &threads, const bool &optimizer)
+{
+	const size_t width = 96;
+	const size_t numOutputs = 10;
+	const size_t rows = 64;
+	std::valarray<T> inputs(width);
+	std::valarray<T> targets(numOutputs);
+	for (size_t i = 0; i < width; ++i) {
+		inputs[i] = static_cast<T>(i % 7) / static_cast<T>(7.0);
+	}
+	for (size_t i = 0; i < numOutputs; ++i) {
+		targets[i] = static_cast<T>(i % 3) / static_cast<T>(3.0);
+	}
+	std::vector<size_t> layers(depth - 1, width);
+	layers.push_back(numOutputs);
+	c_BasicNeuralNetwork<T> network(inputs, targets, layers, ACT_TANH, static_cast<T>(0.01), bias);
+	network.setThreads(threads);
+	if (optimizer) {
+		network.setOptimizer(c_BasicAdamOptimizer<T>());
+	}
+	std::vector<T> batchInputs(rows * width);
+	std::vector<T> batchTargets(rows * numOutputs);
+	std::vector<T> batchOutputs(rows * numOutputs);
+	for (size_t i = 0; i < batchInputs.size(); ++i) {
+		batchInputs[i] = static_cast<T>(i % 11) / static_cast<T>(11.0);
+	}
+	for (size_t i = 0; i < batchTargets.size(); ++i) {
+		batchTargets[i] = static_cast<T>(i % 5) / static_cast<T>(5.0);
+	}
+	bool pass = true;
+	pass = checkNoAllocations(typeName, "evaluate", depth, bias, threads, optimizer, [&]() { network.evaluate(); }) && pass;
+	pass = checkNoAllocations(typeName, "train", depth, bias, threads, optimizer, [&]() { network.train(); }) && pass;
+	pass = checkNoAllocations(typeName, "step", depth, bias, threads, optimizer, [&]() { network.step(); }) && pass;
+	pass = checkNoAllocations(typeName, "evaluateBatch", depth, bias, threads, optimizer, [&]() { network.evaluateBatch(batchInputs.data(), rows, batchOutputs.data()); }) && pass;
+	pass = checkNoAllocations(typeName, "trainBatch", depth, bias, threads, optimizer, [&]() { network.trainBatch(batchInputs.data(), batchTargets.data(), rows); }) && pass;
+	return pass;
+}
+
+int main()
+{
+	bool pass = true;
+	for (size_t depth = 1; depth <= 3; ++depth) {
+		for (int bias = 0; bias < 2; ++bias) {
+			for (size_t threads = 1; threads <= 2; ++threads) {
+				for (int optimizer = 0; optimizer < 2; ++optimizer) {
+					pass = testNetwork<double>("double", depth, bias != 0, threads, optimizer != 0) && pass;
+					pass = testNetwork<float>("float", depth, bias != 0, threads, optimizer != 0) && pass;
+				}
+			}
+		}
+	}
+	printf("%s\n", pass ? "PASS" : "FAIL");
+	return pass ? 0 : 1;
+}
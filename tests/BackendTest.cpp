@@ -0,0 +1,212 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// BackendTest.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Backend test: every GEMM backend the library was built with must agree with the reference backend, up to the order
+// of the sums, on the layer-shaped products (the batch forward, backward and weight update products, the
+// matrix-vector product and the rank-1 update), on the weights and per-weight weighted deltas left by train(), and on
+// the outputs of a network trained with step() and trainBatch(). Fails (exit 1) on any difference beyond the
+// tolerance for the type
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "Gemm.h"
+#include "NeuralNetwork.h"
+
+template <typename T>
+static double tolerance()
+{
+	// Differences in the order of the sums only, scaled up for the depth of the products and the training steps
+	return (sizeof(T) == sizeof(float)) ? 1.0e-3 : 1.0e-9;
+}
+
+template <typename T>
+static double maxRelDifference(const std::vector<T> &x, const std::vector<T> &y)
+{
+	if (x.size() != y.size()) {
+		return HUGE_VAL;
+	}
+	double maxDiff = 0.0;
+	for (size_t i = 0; i < x.size(); ++i) {
+		const double scale = std::fabs(static_cast<double>(y[i])) + 1.0;
+		const double diff = std::fabs(static_cast<double>(x[i]) - static_cast<double>(y[i])) / scale;
+		maxDiff = (diff > maxDiff) ? diff : maxDiff;
+	}
+	return maxDiff;
+}
+
+template <typename T>
+static void fillValues(std::vector<T> &values, const size_t &seed)
+{
+	for (size_t i = 0; i < values.size(); ++i) {
+		values[i] = static_cast<T>((i * 7919 + seed * 104729) % 2001) / static_cast<T>(1000.0) - static_cast<T>(1.0);
+	}
+}
+
+template <typename T>
+static bool check(const char *typeName, const char *what, const e_GemmBackend &backend, const std::vector<T> &values, const std::vector<T> &reference)
+{
+	const double diff = maxRelDifference(values, reference);
+	if (diff > tolerance<T>()) {
+		printf("FAIL %s %s: %s differs from %s by %g\n", typeName, what, getGemmBackendName(backend),
+			getGemmBackendName(GEMM_REFERENCE), diff);
+		return false;
+	}
+	return true;
+}
+
+template <typename T>
+static bool testProducts(const char *typeName, const size_t &rows, const size_t &width, const size_t &numInputs)
+{
+	// The products of one layer of width perceptrons over numInputs inputs, for a batch of rows
+	std::vector<T> inputs(rows * numInputs);
+	std::vector<T> weights(width * numInputs);
+	std::vector<T> deltas(rows * width);
+	fillValues(inputs, 1);
+	fillValues(weights, 2);
+	fillValues(deltas, 3);
+	const T one = 1.0;
+	const T zero = 0.0;
+	const T rate = static_cast<T>(1.0e-3);
+	std::vector<T> results[5];
+	std::vector<T> references[5];
+	const char *names[5] = { "forward", "backward", "update", "gemv", "ger" };
+	bool pass = true;
+	for (int b = GEMM_REFERENCE; b <= GEMM_BLAS; ++b) {
+		const e_GemmBackend backend = static_cast<e_GemmBackend>(b);
+		if (!setGemmBackend(backend)) {
+			continue;
+		}
+		results[0].assign(rows * width, 0.0);
+		results[1].assign(rows * numInputs, 0.0);
+		results[2].assign(width * numInputs, 0.0);
+		results[3].assign(width, 0.0);
+		results[4] = weights;
+		gemm<T>(false, true, rows, width, numInputs, one, inputs.data(), numInputs, weights.data(), numInputs, zero, results[0].data(), width);
+		gemm<T>(false, false, rows, numInputs, width, one, deltas.data(), width, weights.data(), numInputs, zero, results[1].data(), numInputs);
+		gemm<T>(true, false, width, numInputs, rows, one, deltas.data(), width, inputs.data(), numInputs, zero, results[2].data(), numInputs);
+		gemv<T>(false, width, numInputs, one, weights.data(), numInputs, inputs.data(), zero, results[3].data());
+		ger<T>(width, numInputs, rate, deltas.data(), inputs.data(), results[4].data(), numInputs);
+		for (size_t p = 0; p < 5; ++p) {
+			if (backend == GEMM_REFERENCE) {
+				references[p] = results[p];
+			}
+			pass = check<T>(typeName, names[p], backend, results[p], references[p]) && pass;
+		}
+	}
+	return pass;
+}
+
+template <typename T>
+static void trainNetwork(const size_t &numInputs, const size_t &width, const size_t &rows, std::vector<T> &trained, std::vector<T> &outputs)
+{
+	// One train() from the same weights (keeping every weight and weighted delta), then samples (step) and batches
+	// (trainBatch), returning the outputs for every sample
+	const size_t numOutputs = 10;
+	std::valarray<T> inputs(numInputs);
+	std::valarray<T> targets(numOutputs);
+	std::vector<size_t> layers(2, width);
+	layers.push_back(numOutputs);
+	c_BasicNeuralNetwork<T> network(inputs, targets, layers, ACT_TANH, static_cast<T>(0.01), true);
+	network.initWeights(c_BasicInitializer<T>(INIT_XAVIER_UNIFORM, 1));
+	std::vector<T> samples(rows * numInputs);
+	std::vector<T> labels(rows * numOutputs);
+	fillValues(samples, 4);
+	fillValues(labels, 5);
+	for (size_t i = 0; i < numInputs; ++i) {
+		inputs[i] = samples[i];
+	}
+	for (size_t i = 0; i < numOutputs; ++i) {
+		targets[i] = labels[i];
+	}
+	network.evaluate();
+	network.train();
+	trained.clear();
+	for (size_t l = 0; l < network.getSize(); ++l) {
+		for (size_t i = 0; i < network[l].getSize(); ++i) {
+			const std::valarray<T> weights = network[l][i].getWeights();
+			const std::valarray<T> weightedDeltas = network[l][i].getWeightedDeltas();
+			trained.insert(trained.end(), std::begin(weights), std::end(weights));
+			trained.insert(trained.end(), std::begin(weightedDeltas), std::end(weightedDeltas));
+		}
+	}
+	for (size_t r = 0; r < rows; ++r) {
+		for (size_t i = 0; i < numInputs; ++i) {
+			inputs[i] = samples[(r * numInputs) + i];
+		}
+		for (size_t i = 0; i < numOutputs; ++i) {
+			targets[i] = labels[(r * numOutputs) + i];
+		}
+		network.step();
+	}
+	for (size_t epoch = 0; epoch < 4; ++epoch) {
+		network.trainBatch(samples.data(), labels.data(), rows);
+	}
+	outputs.resize(rows * numOutputs);
+	network.evaluateBatch(samples.data(), rows, outputs.data());
+}
+
+template <typename T>
+static bool testNetwork(const char *typeName, const size_t &numInputs, const size_t &width, const size_t &rows)
+{
+	std::vector<T> trained;
+	std::vector<T> outputs;
+	std::vector<T> refTrained;
+	std::vector<T> refOutputs;
+	bool pass = true;
+	for (int b = GEMM_REFERENCE; b <= GEMM_BLAS; ++b) {
+		const e_GemmBackend backend = static_cast<e_GemmBackend>(b);
+		if (!setGemmBackend(backend)) {
+			continue;
+		}
+		trainNetwork<T>(numInputs, width, rows, trained, outputs);
+		if (backend == GEMM_REFERENCE) {
+			refTrained = trained;
+			refOutputs = outputs;
+		}
+		pass = check<T>(typeName, "train() weights and weighted deltas", backend, trained, refTrained) && pass;
+		pass = check<T>(typeName, "network outputs", backend, outputs, refOutputs) && pass;
+	}
+	return pass;
+}
+
+int main()
+{
+	const e_GemmBackend defaultBackend = getGemmBackend();
+	// Batch rows, layer width and inputs of each set of products (including edges that fill no whole tile)
+	const size_t shapes[][3] = { { 1, 1, 1 }, { 7, 13, 5 }, { 32, 128, 64 }, { 67, 129, 257 } };
+	bool pass = true;
+	for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); ++s) {
+		pass = testProducts<double>("double", shapes[s][0], shapes[s][1], shapes[s][2]) && pass;
+		pass = testProducts<float>("float", shapes[s][0], shapes[s][1], shapes[s][2]) && pass;
+	}
+	pass = testNetwork<double>("double", 64, 128, 64) && pass;
+	pass = testNetwork<float>("float", 64, 128, 64) && pass;
+	setGemmBackend(defaultBackend);
+	printf("%s\n", pass ? "PASS" : "FAIL");
+	return pass ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// BatchTest.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Batch training test: trainBatch() on a one-row batch, and the fused step(), must make the same weight changes as
+// evaluate() then train() on that row, for every depth (a single-layer network included, whose only layer is also
+// its output layer). Fails (exit 1) on any mismatch, or if the weights do not change
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "NeuralNetwork.h"
+
+template <typename T>
+static void setWeights(c_BasicNeuralNetwork<T> &network)
+{
+	// The same small weights in every network built the same way (a fixed linear congruential sequence)
+	unsigned int state = 7;
+	for (size_t l = 0; l < network.getSize(); ++l) {
+		std::valarray<T> weights(network[l].getStride());
+		for (size_t p = 0; p < network[l].getSize(); ++p) {
+			for (size_t i = 0; i < weights.size(); ++i) {
+				state = (state * 1103515245u) + 12345u;
+				weights[i] = static_cast<T>((static_cast<double>((state >> 16) & 0x7fff) / 32767.0) - 0.5);
+			}
+			network[l][p].setWeights(weights);
+		}
+	}
+}
+
+template <typename T>
+static void copyWeights(c_BasicNeuralNetwork<T> &network, std::vector<T> &weights)
+{
+	weights.clear();
+	for (size_t l = 0; l < network.getSize(); ++l) {
+		const T *layerWeights = network[l].getWeights();
+		weights.insert(weights.end(), layerWeights, layerWeights + (network[l].getSize() * network[l].getStride()));
+	}
+}
+
+template <typename T>
+static bool testNetwork(const char *typeName, const size_t &depth, const bool &bias, const e_Activation &actType)
+{
+	const size_t numInputs = 12;
+	const size_t numOutputs = 5;
+	std::valarray<T> inputs(numInputs);
+	std::valarray<T> targets(numOutputs);
+	for (size_t i = 0; i < numInputs; ++i) {
+		inputs[i] = static_cast<T>(i % 7) / static_cast<T>(7.0) - static_cast<T>(0.5);
+	}
+	for (size_t i = 0; i < numOutputs; ++i) {
+		targets[i] = static_cast<T>(i % 3) / static_cast<T>(3.0);
+	}
+	std::vector<size_t> layers(depth - 1, 8);
+	layers.push_back(numOutputs);
+	c_BasicNeuralNetwork<T> sample(inputs, targets, layers, actType, static_cast<T>(0.1), bias);
+	c_BasicNeuralNetwork<T> batch(inputs, targets, layers, actType, static_cast<T>(0.1), bias);
+	c_BasicNeuralNetwork<T> fused(inputs, targets, layers, actType, static_cast<T>(0.1), bias);
+	setWeights(sample);
+	setWeights(batch);
+	setWeights(fused);
+	std::vector<T> initial;
+	copyWeights(sample, initial);
+	sample.evaluate();
+	sample.train();
+	const std::vector<T> batchInputs(&inputs[0], &inputs[0] + numInputs);
+	const std::vector<T> batchTargets(&targets[0], &targets[0] + numOutputs);
+	batch.trainBatch(batchInputs.data(), batchTargets.data(), 1);
+	fused.step();
+	std::vector<T> sampleWeights;
+	std::vector<T> batchWeights;
+	std::vector<T> fusedWeights;
+	copyWeights(sample, sampleWeights);
+	copyWeights(batch, batchWeights);
+	copyWeights(fused, fusedWeights);
+	double maxDiff = 0.0;
+	double maxFusedDiff = 0.0;
+	double maxChange = 0.0;
+	for (size_t i = 0; i < sampleWeights.size(); ++i) {
+		const double diff = std::fabs(static_cast<double>(sampleWeights[i]) - static_cast<double>(batchWeights[i]));
+		const double fusedDiff = std::fabs(static_cast<double>(sampleWeights[i]) - static_cast<double>(fusedWeights[i]));
+		const double change = std::fabs(static_cast<double>(batchWeights[i]) - static_cast<double>(initial[i]));
+		maxDiff = (diff > maxDiff) ? diff : maxDiff;
+		maxFusedDiff = (fusedDiff > maxFusedDiff) ? fusedDiff : maxFusedDiff;
+		maxChange = (change > maxChange) ? change : maxChange;
+	}
+	const double tolerance = (sizeof(T) == sizeof(float)) ? 1.0e-6 : 1.0e-14;
+	const bool pass = (maxDiff <= tolerance) && (maxFusedDiff <= tolerance) && (maxChange > 0.0);
+	if (!pass) {
+		printf("FAIL %s depth %zu bias %d act %d: max difference %g (trainBatch), %g (step), max change %g\n", typeName,
+			depth, bias ? 1 : 0, static_cast<int>(actType), maxDiff, maxFusedDiff, maxChange);
+	}
+	return pass;
+}
+
+int main()
+{
+	bool pass = true;
+	for (size_t depth = 1; depth <= 3; ++depth) {
+		for (int bias = 0; bias < 2; ++bias) {
+			for (int act = ACT_TANH; act <= ACT_SIGMOID; ++act) {
+				pass = testNetwork<double>("double", depth, bias != 0, static_cast<e_Activation>(act)) && pass;
+				pass = testNetwork<float>("float", depth, bias != 0, static_cast<e_Activation>(act)) && pass;
+			}
+		}
+	}
+	printf("%s\n", pass ? "PASS" : "FAIL");
+	return pass ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// CopyTest.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Copy and move test: a copy (constructed or assigned) must evaluate as its source, then train independently of it,
+// each keeping its own weights. A moved-to network must take over the source's weights, and the moved-from network
+// must be safe to query, use (every call a no-op) and destroy, and to assign to again. Fails (exit 1) otherwise
+
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "NeuralNetwork.h"
+
+template <typename T>
+static void copyWeights(c_BasicNeuralNetwork<T> &network, std::vector<T> &weights)
+{
+	weights.clear();
+	for (size_t l = 0; l < network.getSize(); ++l) {
+		const T *layerWeights = network[l].getWeights();
+		weights.insert(weights.end(), layerWeights, layerWeights + (network[l].getSize() * network[l].getStride()));
+	}
+}
+
+template <typename T>
+static bool sameWeights(c_BasicNeuralNetwork<T> &x, c_BasicNeuralNetwork<T> &y)
+{
+	std::vector<T> xWeights;
+	std::vector<T> yWeights;
+	copyWeights(x, xWeights);
+	copyWeights(y, yWeights);
+	return (xWeights.size() == yWeights.size()) && (memcmp(xWeights.data(), yWeights.data(), xWeights.size() * sizeof(T)) == 0);
+}
+
+template <typename T>
+static bool sameOutputs(c_BasicNeuralNetwork<T> &x, c_BasicNeuralNetwork<T> &y)
+{
+	x.evaluate();
+	y.evaluate();
+	const std::valarray<T> &xOutputs = x.getOutputs();
+	const std::valarray<T> &yOutputs = y.getOutputs();
+	return (xOutputs.size() == yOutputs.size()) && (memcmp(&xOutputs[0], &yOutputs[0], xOutputs.size() * sizeof(T)) == 0);
+}
+
+template <typename T>
+static bool testNetwork(const char *typeName, const size_t &depth, const bool &bias, const size_t &threads)
+{
+	const size_t numInputs = 12;
+	const size_t numOutputs = 4;
+	const size_t rows = 8;
+	std::valarray<T> inputs(numInputs);
+	std::valarray<T> targets(numOutputs);
+	for (size_t i = 0; i < numInputs; ++i) {
+		inputs[i] = static_cast<T>(i % 5) / static_cast<T>(5.0) - static_cast<T>(0.5);
+	}
+	for (size_t i = 0; i < numOutputs; ++i) {
+		targets[i] = static_cast<T>(i % 2);
+	}
+	std::vector<T> batchInputs(rows * numInputs, static_cast<T>(0.25));
+	std::vector<T> batchTargets(rows * numOutputs, static_cast<T>(0.5));
+	std::vector<T> batchOutputs(rows * numOutputs);
+	std::vector<size_t> layers(depth - 1, 10);
+	layers.push_back(numOutputs);
+	c_BasicNeuralNetwork<T> source(inputs, targets, layers, ACT_TANH, static_cast<T>(0.1), bias);
+	source.initWeights(c_BasicInitializer<T>(INIT_XAVIER_UNIFORM, 13));
+	source.setThreads(threads);
+	std::vector<const char*> failures;
+	// Copy construction: the same outputs, then training one leaves the other alone
+	c_BasicNeuralNetwork<T> copy(source);
+	if (!sameWeights(copy, source) || !sameOutputs(copy, source)) {
+		failures.push_back("copy differs from its source");
+	}
+	std::vector<T> before;
+	copyWeights(source, before);
+	copy.train();
+	copy.trainBatch(batchInputs.data(), batchTargets.data(), rows);
+	std::vector<T> after;
+	copyWeights(source, after);
+	if ((before != after) || sameWeights(copy, source)) {
+		failures.push_back("training a copy changed its source (or did not change the copy)");
+	}
+	// Copy assignment over a network of another shape, then training the source leaves the copy alone
+	c_BasicNeuralNetwork<T> assigned(inputs, targets, { 3, numOutputs }, ACT_SIGMOID, static_cast<T>(0.5), !bias);
+	assigned = source;
+	if (!sameWeights(assigned, source) || !sameOutputs(assigned, source)) {
+		failures.push_back("assigned copy differs from its source");
+	}
+	copyWeights(assigned, before);
+	source.step();
+	copyWeights(assigned, after);
+	if ((before != after) || sameWeights(assigned, source)) {
+		failures.push_back("training a source changed its assigned copy");
+	}
+	// Move construction takes over the weights, leaving the source empty
+	copyWeights(source, before);
+	c_BasicNeuralNetwork<T> moved(std::move(source));
+	copyWeights(moved, after);
+	if (before != after) {
+		failures.push_back("moved-to network has other weights");
+	}
+	// Every query and call on the moved-from network must be safe, and a no-op
+	source.evaluate();
+	source.train();
+	source.step();
+	source.evaluateBatch(batchInputs.data(), rows, batchOutputs.data());
+	source.trainBatch(batchInputs.data(), batchTargets.data(), rows);
+	source.trainParallel(batchInputs.data(), batchTargets.data(), rows);
+	source.setBias(bias);
+	source.setTrainRate(static_cast<T>(0.2));
+	source.initWeights(c_BasicInitializer<T>(INIT_XAVIER_UNIFORM, 1));
+	if ((source.getSize() != 0) || (source.getNumInputs() != 0) || (source.getNumWeights() != 0) ||
+		(source.getOutputs().size() != 0)) {
+		failures.push_back("moved-from network is not empty");
+	}
+	// Copying the empty network gives another empty network; move assigning brings it back to life
+	c_BasicNeuralNetwork<T> emptyCopy(source);
+	if (emptyCopy.getSize() != 0) {
+		failures.push_back("copy of a moved-from network is not empty");
+	}
+	source = std::move(moved);
+	copyWeights(source, after);
+	if (before != after) {
+		failures.push_back("move assigning to a moved-from network failed");
+	}
+	source.step();
+	for (const char *failure : failures) {
+		printf("FAIL %s depth %zu bias %d threads %zu: %s\n", typeName, depth, bias ? 1 : 0, threads, failure);
+	}
+	return failures.empty();
+}
+
+int main()
+{
+	bool pass = true;
+	for (size_t depth = 1; depth <= 3; ++depth) {
+		for (int bias = 0; bias < 2; ++bias) {
+			for (size_t threads = 1; threads <= 2; ++threads) {
+				pass = testNetwork<double>("double", depth, bias != 0, threads) && pass;
+				pass = testNetwork<float>("float", depth, bias != 0, threads) && pass;
+			}
+		}
+	}
+	printf("%s\n", pass ? "PASS" : "FAIL");
+	return pass ? 0 : 1;
+}
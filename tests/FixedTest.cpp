@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// FixedTest.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Fixed network test: a c_FixedNetwork filled with fromNetwork() must infer the outputs that evaluate() gives on the
+// source network, with and without bias, for several topologies and both activations. toNetwork() must copy the
+// weights back into a network that evaluates the same, and both must refuse a network of another topology. Fails
+// (exit 1) otherwise
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "FixedNetwork.h"
+
+template <typename T, size_t... Sizes>
+static bool testNetwork(const char *typeName, const bool &bias, const e_Activation &actType)
+{
+	typedef c_FixedNetwork<T, Sizes...> t_Fixed;
+	const size_t rows = 8;
+	std::valarray<T> inputs(t_Fixed::NUM_INPUTS);
+	std::valarray<T> targets(t_Fixed::NUM_OUTPUTS);
+	const std::vector<size_t> layers(&t_Fixed::SIZES[1], &t_Fixed::SIZES[1] + t_Fixed::NUM_LAYERS);
+	c_BasicNeuralNetwork<T> network(inputs, targets, layers, actType, static_cast<T>(0.1), bias);
+	network.initWeights(c_BasicInitializer<T>(INIT_XAVIER_UNIFORM, 9));
+	t_Fixed fixed;
+	bool pass = fixed.fromNetwork(network);
+	// Summed in another order than the network's dot products, so equal to within rounding
+	const double tolerance = (sizeof(T) == sizeof(float)) ? 1.0e-6 : 1.0e-14;
+	double maxDiff = 0.0;
+	std::vector<T> outputs(t_Fixed::NUM_OUTPUTS);
+	for (size_t r = 0; r < rows; ++r) {
+		for (size_t i = 0; i < t_Fixed::NUM_INPUTS; ++i) {
+			inputs[i] = static_cast<T>(((r * 7) + (i * 3)) % 11) / static_cast<T>(11.0) - static_cast<T>(0.5);
+		}
+		network.evaluate();
+		fixed.infer(&inputs[0], outputs.data());
+		const std::valarray<T> &expected = network.getOutputs();
+		for (size_t i = 0; i < t_Fixed::NUM_OUTPUTS; ++i) {
+			const double diff = std::fabs(static_cast<double>(outputs[i]) - static_cast<double>(expected[i]));
+			maxDiff = (diff > maxDiff) ? diff : maxDiff;
+		}
+	}
+	// Back into a network built with the opposite bias (toNetwork() sets it to match) and another activation
+	c_BasicNeuralNetwork<T> copy(inputs, targets, layers, (actType == ACT_TANH) ? ACT_SIGMOID : ACT_TANH, static_cast<T>(0.1), !bias);
+	pass = fixed.toNetwork(copy) && pass;
+	network.evaluate();
+	copy.evaluate();
+	const std::valarray<T> &expected = network.getOutputs();
+	const std::valarray<T> &copied = copy.getOutputs();
+	for (size_t i = 0; i < t_Fixed::NUM_OUTPUTS; ++i) {
+		const double diff = std::fabs(static_cast<double>(copied[i]) - static_cast<double>(expected[i]));
+		maxDiff = (diff > maxDiff) ? diff : maxDiff;
+	}
+	pass = pass && (maxDiff <= tolerance);
+	// A network with one more perceptron in its first layer does not fit
+	std::vector<size_t> otherLayers = layers;
+	++otherLayers[0];
+	c_BasicNeuralNetwork<T> other(inputs, targets, otherLayers, actType, static_cast<T>(0.1), bias);
+	pass = pass && !fixed.fromNetwork(other) && !fixed.toNetwork(other);
+	if (!pass) {
+		printf("FAIL %s %zu layers bias %d act %d: max difference %g\n", typeName, t_Fixed::NUM_LAYERS, bias ? 1 : 0,
+			static_cast<int>(actType), maxDiff);
+	}
+	return pass;
+}
+
+template <typename T>
+static bool testType(const char *typeName)
+{
+	bool pass = true;
+	for (int bias = 0; bias < 2; ++bias) {
+		for (int act = ACT_TANH; act <= ACT_SIGMOID; ++act) {
+			pass = testNetwork<T, 5, 3>(typeName, bias != 0, static_cast<e_Activation>(act)) && pass;
+			pass = testNetwork<T, 8, 16, 4>(typeName, bias != 0, static_cast<e_Activation>(act)) && pass;
+			pass = testNetwork<T, 12, 10, 7, 3>(typeName, bias != 0, static_cast<e_Activation>(act)) && pass;
+		}
+	}
+	return pass;
+}
+
+int main()
+{
+	bool pass = testType<double>("double");
+	pass = testType<float>("float") && pass;
+	printf("%s\n", pass ? "PASS" : "FAIL");
+	return pass ? 0 : 1;
+}
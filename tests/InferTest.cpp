@@ -0,0 +1,139 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// InferTest.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Inference test: infer() through a context built from a const network must give the outputs of evaluate(), for
+// every depth, with and without bias, and from several threads at once (each with its own context). A network that
+// has been moved from must leave infer() and evaluate() with a context as no-ops. Fails (exit 1) otherwise
+
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ExecContext.h"
+#include "NeuralNetwork.h"
+
+template <typename T>
+static bool testNetwork(const char *typeName, const size_t &depth, const bool &bias, const e_Activation &actType)
+{
+	const size_t numInputs = 24;
+	const size_t numOutputs = 6;
+	const size_t rows = 16;
+	const size_t numThreads = 4;
+	std::valarray<T> inputs(numInputs);
+	std::valarray<T> targets(numOutputs);
+	std::vector<size_t> layers(depth - 1, 40);
+	layers.push_back(numOutputs);
+	c_BasicNeuralNetwork<T> network(inputs, targets, layers, actType, static_cast<T>(0.1), bias);
+	network.initWeights(c_BasicInitializer<T>(INIT_XAVIER_UNIFORM, 5));
+	std::vector<T> samples(rows * numInputs);
+	for (size_t i = 0; i < samples.size(); ++i) {
+		samples[i] = static_cast<T>(i % 13) / static_cast<T>(13.0) - static_cast<T>(0.5);
+	}
+	std::vector<T> expected(rows * numOutputs);
+	for (size_t r = 0; r < rows; ++r) {
+		for (size_t i = 0; i < numInputs; ++i) {
+			inputs[i] = samples[(r * numInputs) + i];
+		}
+		network.evaluate();
+		const std::valarray<T> &outputs = network.getOutputs();
+		for (size_t i = 0; i < numOutputs; ++i) {
+			expected[(r * numOutputs) + i] = outputs[i];
+		}
+	}
+	// Every thread infers every row with its own context, from the network only through a const reference
+	const c_BasicNeuralNetwork<T> &shared = network;
+	std::vector<std::vector<T>> actual(numThreads, std::vector<T>(rows * numOutputs));
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < numThreads; ++t) {
+		threads.push_back(std::thread([&shared, &samples, &actual, t]() {
+			c_BasicExecContext<T> context(shared);
+			for (size_t r = 0; r < rows; ++r) {
+				shared.infer(&samples[r * numInputs], &actual[t][r * numOutputs], context);
+			}
+		}));
+	}
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+	// The same products as evaluate() summed one neuron at a time, so equal to within rounding
+	const double tolerance = (sizeof(T) == sizeof(float)) ? 1.0e-6 : 1.0e-14;
+	double maxDiff = 0.0;
+	for (size_t t = 0; t < numThreads; ++t) {
+		for (size_t i = 0; i < expected.size(); ++i) {
+			const double diff = std::fabs(static_cast<double>(actual[t][i]) - static_cast<double>(expected[i]));
+			maxDiff = (diff > maxDiff) ? diff : maxDiff;
+		}
+	}
+	bool pass = (maxDiff <= tolerance);
+	if (!pass) {
+		printf("FAIL %s depth %zu bias %d act %d: infer() differs from evaluate() by %g\n", typeName, depth, bias ? 1 : 0,
+			static_cast<int>(actType), maxDiff);
+	}
+	// A moved-from network has no inputs or layers: a context built from it is empty, and using one is a no-op
+	c_BasicExecContext<T> context(network);
+	c_BasicNeuralNetwork<T> moved(std::move(network));
+	c_BasicExecContext<T> emptyContext(network);
+	std::vector<T> outputs(numOutputs, static_cast<T>(2.0));
+	network.evaluate(samples.data(), context);
+	network.infer(samples.data(), outputs.data(), context);
+	network.infer(samples.data(), outputs.data(), emptyContext);
+	for (size_t i = 0; i < numOutputs; ++i) {
+		if (outputs[i] != static_cast<T>(2.0)) {
+			printf("FAIL %s depth %zu bias %d act %d: infer() on a moved-from network wrote outputs\n", typeName, depth,
+				bias ? 1 : 0, static_cast<int>(actType));
+			pass = false;
+			break;
+		}
+	}
+	// The network moved to infers as the original did
+	moved.infer(samples.data(), outputs.data(), context);
+	for (size_t i = 0; i < numOutputs; ++i) {
+		if (std::fabs(static_cast<double>(outputs[i]) - static_cast<double>(expected[i])) > tolerance) {
+			printf("FAIL %s depth %zu bias %d act %d: infer() on the moved-to network differs\n", typeName, depth,
+				bias ? 1 : 0, static_cast<int>(actType));
+			pass = false;
+			break;
+		}
+	}
+	return pass;
+}
+
+int main()
+{
+	bool pass = true;
+	for (size_t depth = 1; depth <= 3; ++depth) {
+		for (int bias = 0; bias < 2; ++bias) {
+			for (int act = ACT_TANH; act <= ACT_SIGMOID; ++act) {
+				pass = testNetwork<double>("double", depth, bias != 0, static_cast<e_Activation>(act)) && pass;
+				pass = testNetwork<float>("float", depth, bias != 0, static_cast<e_Activation>(act)) && pass;
+			}
+		}
+	}
+	printf("%s\n", pass ? "PASS" : "FAIL");
+	return pass ? 0 : 1;
+}
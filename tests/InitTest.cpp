@@ -0,0 +1,120 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// InitTest.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Initializer test: every row of weights comes from its own Philox stream, so initWeights() must give bit-identical
+// weights when run twice on one network (even after training has changed them), on a second network of the same
+// shape, and with 1, 2 and N threads, for every scheme; a different seed must give different weights. Fails (exit 1)
+// on any difference
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "NeuralNetwork.h"
+
+template <typename T>
+static void copyWeights(c_BasicNeuralNetwork<T> &network, std::vector<T> &weights)
+{
+	weights.clear();
+	for (size_t l = 0; l < network.getSize(); ++l) {
+		const T *layerWeights = network[l].getWeights();
+		weights.insert(weights.end(), layerWeights, layerWeights + (network[l].getSize() * network[l].getStride()));
+	}
+}
+
+template <typename T>
+static bool sameWeights(const std::vector<T> &a, const std::vector<T> &b)
+{
+	return (a.size() == b.size()) && (memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+template <typename T>
+static bool testScheme(const char *typeName, const e_InitScheme &scheme, const bool &bias)
+{
+	// Layers wide enough for initWeights() to split them into several chunks
+	const size_t numInputs = 64;
+	const size_t width = 320;
+	const size_t numOutputs = 10;
+	const size_t cores = std::thread::hardware_concurrency();
+	const size_t threadCounts[] = { 1, 2, (cores > 3) ? cores : 4 };
+	std::valarray<T> inputs(static_cast<T>(0.25), numInputs);
+	std::valarray<T> targets(static_cast<T>(0.5), numOutputs);
+	std::vector<size_t> layers(2, width);
+	layers.push_back(numOutputs);
+	const c_BasicInitializer<T> initializer(scheme, 23);
+	bool pass = true;
+	std::vector<T> reference;
+	for (const size_t &threads : threadCounts) {
+		c_BasicNeuralNetwork<T> network(inputs, targets, layers, ACT_TANH, static_cast<T>(0.01), bias);
+		network.setThreads(threads);
+		network.initWeights(initializer);
+		std::vector<T> first;
+		copyWeights(network, first);
+		network.evaluate();
+		network.train();
+		network.initWeights(initializer);
+		std::vector<T> second;
+		copyWeights(network, second);
+		if (!sameWeights(first, second)) {
+			printf("FAIL %s scheme %d bias %d: initWeights() does not repeat on %zu threads\n", typeName,
+				static_cast<int>(scheme), bias ? 1 : 0, threads);
+			pass = false;
+		}
+		if (reference.empty()) {
+			reference = first;
+		} else if (!sameWeights(first, reference)) {
+			printf("FAIL %s scheme %d bias %d: %zu threads differ from 1\n", typeName, static_cast<int>(scheme),
+				bias ? 1 : 0, threads);
+			pass = false;
+		}
+		if (threads == 1) {
+			network.initWeights(c_BasicInitializer<T>(scheme, 24));
+			copyWeights(network, second);
+			if (sameWeights(first, second)) {
+				printf("FAIL %s scheme %d bias %d: seeds 23 and 24 give the same weights\n", typeName,
+					static_cast<int>(scheme), bias ? 1 : 0);
+				pass = false;
+			}
+		}
+	}
+	return pass;
+}
+
+int main()
+{
+	const e_InitScheme schemes[] = { INIT_UNIFORM, INIT_NORMAL, INIT_XAVIER_UNIFORM, INIT_XAVIER_NORMAL, INIT_HE_UNIFORM,
+		INIT_HE_NORMAL };
+	bool pass = true;
+	for (const e_InitScheme &scheme : schemes) {
+		for (int bias = 0; bias < 2; ++bias) {
+			pass = testScheme<double>("double", scheme, bias != 0) && pass;
+			pass = testScheme<float>("float", scheme, bias != 0) && pass;
+		}
+	}
+	printf("%s\n", pass ? "PASS" : "FAIL");
+	return pass ? 0 : 1;
+}
@@ -0,0 +1,215 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// QuantTest.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Quantization test: at every SIMD level the CPU supports, the int8 GEMM must match a plain integer reference
+// exactly, and the quantize and dequantize kernels must match their scalar definitions exactly. A quantized network
+// must then give the outputs of the network it was quantized from within a quantization tolerance, one row at a
+// time and as a batch. Fails (exit 1) on any mismatch
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Gemm.h"
+#include "Kernels.h"
+#include "QuantizedNetwork.h"
+
+// The fixed pseudo-random sequence the test draws from, so every run checks the same values
+static unsigned int s_State = 7;
+
+static int _next(const int &range)
+{
+	s_State = (s_State * 1103515245u) + 12345u;
+	return static_cast<int>((s_State >> 16) & 0x7fff) % range;
+}
+
+template <typename T>
+static int8_t _quantize(const T &value)
+{
+	const T clamped = (value > T(127)) ? T(127) : ((value < T(-127)) ? T(-127) : value);
+	return static_cast<int8_t>(clamped + ((clamped < T(0)) ? T(-0.5) : T(0.5)));
+}
+
+static bool testGemm(const e_SimdLevel &level)
+{
+	const size_t sizes[] = { 1, 3, 4, 5, 9, 17, 64 };
+	const size_t depths[] = { 1, 15, 16, 17, 31, 32, 33, 64, 65, 257 };
+	size_t errors = 0;
+	for (size_t m : sizes) {
+		for (size_t n : sizes) {
+			for (size_t k : depths) {
+				// Row strides longer than k, as for padded layer rows
+				const size_t lda = k + _next(3);
+				const size_t ldb = k + _next(5);
+				const size_t ldc = n + _next(2);
+				std::vector<int8_t> a(m * lda);
+				std::vector<int8_t> b(n * ldb);
+				std::vector<int32_t> c(m * ldc);
+				for (int8_t &value : a) {
+					value = static_cast<int8_t>(_next(255) - 127);
+				}
+				for (int8_t &value : b) {
+					value = static_cast<int8_t>(_next(255) - 127);
+				}
+				gemmInt8(m, n, k, a.data(), lda, b.data(), ldb, c.data(), ldc);
+				for (size_t i = 0; i < m; ++i) {
+					for (size_t j = 0; j < n; ++j) {
+						int32_t sum = 0;
+						for (size_t p = 0; p < k; ++p) {
+							sum += static_cast<int32_t>(a[i * lda + p]) * static_cast<int32_t>(b[j * ldb + p]);
+						}
+						errors += (sum != c[i * ldc + j]) ? 1 : 0;
+					}
+				}
+			}
+		}
+	}
+	// The extreme products, accumulated over the longest rows the 32 bit sums allow
+	const size_t k = 1 << 16;
+	std::vector<int8_t> a(4 * k, -127);
+	std::vector<int8_t> b(4 * k, 127);
+	std::vector<int32_t> c(16);
+	gemmInt8(4, 4, k, a.data(), k, b.data(), k, c.data(), 4);
+	for (const int32_t &value : c) {
+		errors += (value != -127 * 127 * static_cast<int32_t>(k)) ? 1 : 0;
+	}
+	if (errors != 0) {
+		printf("FAIL %s: %zu int8 GEMM results differ from the reference\n", getSimdLevelName(level), errors);
+	}
+	return errors == 0;
+}
+
+template <typename T>
+static bool testConversion(const char *typeName, const e_SimdLevel &level)
+{
+	size_t errors = 0;
+	// A power of two, so the half way values below stay exactly half way once scaled
+	const T scale = static_cast<T>(0.5);
+	for (size_t n : { 1, 7, 16, 31, 32, 33, 100 }) {
+		std::vector<T> values(n);
+		std::vector<int8_t> quantized(n);
+		for (size_t i = 0; i < n; ++i) {
+			// Values beyond the int8 range, and values exactly half way between two integers once scaled
+			values[i] = static_cast<T>(_next(20001) - 10000) / static_cast<T>(37.0);
+			if ((i % 5) == 0) {
+				values[i] = static_cast<T>((2 * _next(3)) + (((i % 2) != 0) ? 1 : -3));
+			}
+		}
+		kernelQuantizeInt8(values.data(), scale, quantized.data(), n);
+		for (size_t i = 0; i < n; ++i) {
+			errors += (quantized[i] != _quantize<T>(values[i] * scale)) ? 1 : 0;
+		}
+		std::vector<int32_t> sums(n);
+		std::vector<T> scales(n);
+		std::vector<T> bias(n);
+		std::vector<T> outputs(n);
+		for (size_t i = 0; i < n; ++i) {
+			sums[i] = (_next(32768) - 16384) * 131;
+			scales[i] = static_cast<T>(_next(32768)) / static_cast<T>(1.0e6);
+			bias[i] = static_cast<T>(_next(32768)) / static_cast<T>(1.0e4);
+		}
+		kernelDequantizeInt32(sums.data(), static_cast<T>(0.3), scales.data(), bias.data(), outputs.data(), n);
+		for (size_t i = 0; i < n; ++i) {
+			errors += (outputs[i] != static_cast<T>(sums[i]) * (static_cast<T>(0.3) * scales[i]) + bias[i]) ? 1 : 0;
+		}
+	}
+	if (errors != 0) {
+		printf("FAIL %s %s: %zu quantize or dequantize results differ from the reference\n", getSimdLevelName(level),
+			typeName, errors);
+	}
+	return errors == 0;
+}
+
+template <typename T>
+static bool testNetwork(const char *typeName, const e_QuantScale &scale, const bool &bias)
+{
+	const size_t numInputs = 48;
+	const size_t numOutputs = 10;
+	const size_t rows = 64;
+	std::valarray<T> inputs(numInputs);
+	std::valarray<T> targets(numOutputs);
+	std::vector<size_t> layers = { 64, 32, numOutputs };
+	c_BasicNeuralNetwork<T> network(inputs, targets, layers, ACT_TANH, static_cast<T>(0.01), bias);
+	// Small weights, so the sums stay in the steep part of tanh where quantization errors show most
+	for (size_t l = 0; l < network.getSize(); ++l) {
+		std::valarray<T> weights(network[l].getStride());
+		for (size_t p = 0; p < network[l].getSize(); ++p) {
+			for (size_t i = 0; i < weights.size(); ++i) {
+				weights[i] = static_cast<T>(_next(32768) - 16384) / static_cast<T>(16384.0 * 4.0);
+			}
+			network[l][p].setWeights(weights);
+		}
+	}
+	std::vector<T> samples(rows * numInputs);
+	for (T &value : samples) {
+		value = static_cast<T>(_next(32768) - 16384) / static_cast<T>(16384.0);
+	}
+	c_BasicQuantizedNetwork<T> quantized;
+	quantized.setScale(scale);
+	bool pass = quantized.quantize(network) && quantized.calibrate(network, samples.data(), rows);
+	s_QuantReport report = {};
+	pass = pass && quantized.compare(network, samples.data(), rows, report);
+	// Three layers of int8 rounding stay within a few thousandths of the float outputs here
+	pass = pass && (report.maxError < 0.01) && (report.agreement >= 0.9);
+	// The batch must give what one row at a time gives
+	std::vector<T> batchOutputs(rows * numOutputs);
+	std::vector<T> rowOutputs(numOutputs);
+	quantized.inferBatch(samples.data(), rows, batchOutputs.data());
+	double maxDiff = 0.0;
+	for (size_t r = 0; r < rows; ++r) {
+		quantized.infer(&samples[r * numInputs], rowOutputs.data());
+		for (size_t i = 0; i < numOutputs; ++i) {
+			const double diff = std::fabs(static_cast<double>(rowOutputs[i]) - static_cast<double>(batchOutputs[r * numOutputs + i]));
+			maxDiff = (diff > maxDiff) ? diff : maxDiff;
+		}
+	}
+	pass = pass && (maxDiff == 0.0);
+	if (!pass) {
+		printf("FAIL %s %s scale, bias %d: max error %g, agreement %g, batch difference %g\n", typeName,
+			(scale == QUANT_PER_LAYER) ? "layer" : "neuron", bias ? 1 : 0, report.maxError, report.agreement, maxDiff);
+	}
+	return pass;
+}
+
+int main()
+{
+	bool pass = true;
+	for (int level = SIMD_SCALAR; level <= getMaxSimdLevel(); ++level) {
+		setSimdLevel(static_cast<e_SimdLevel>(level));
+		pass = testGemm(static_cast<e_SimdLevel>(level)) && pass;
+		pass = testConversion<double>("double", static_cast<e_SimdLevel>(level)) && pass;
+		pass = testConversion<float>("float", static_cast<e_SimdLevel>(level)) && pass;
+		for (int scale = QUANT_PER_LAYER; scale <= QUANT_PER_NEURON; ++scale) {
+			for (int bias = 0; bias < 2; ++bias) {
+				pass = testNetwork<double>("double", static_cast<e_QuantScale>(scale), bias != 0) && pass;
+				pass = testNetwork<float>("float", static_cast<e_QuantScale>(scale), bias != 0) && pass;
+			}
+		}
+	}
+	printf("%s\n", pass ? "PASS" : "FAIL");
+	return pass ? 0 : 1;
+}
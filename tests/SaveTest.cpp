@@ -0,0 +1,154 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// SaveTest.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Model file test: a network saved then restored with load() or loadMapped() (into a network of another shape) must
+// have bit-identical weights and outputs. Loading a truncated file, or one with a corrupted header or layer table,
+// must fail and leave the network untouched. Fails (exit 1) otherwise
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "NeuralNetwork.h"
+
+template <typename T>
+static void copyWeights(c_BasicNeuralNetwork<T> &network, std::vector<T> &weights)
+{
+	weights.clear();
+	for (size_t l = 0; l < network.getSize(); ++l) {
+		const T *layerWeights = network[l].getWeights();
+		weights.insert(weights.end(), layerWeights, layerWeights + (network[l].getSize() * network[l].getStride()));
+	}
+}
+
+static bool same(const void *x, const size_t &xBytes, const void *y, const size_t &yBytes)
+{
+	return (xBytes == yBytes) && (memcmp(x, y, xBytes) == 0);
+}
+
+static std::vector<char> readFile(const std::string &filename)
+{
+	std::ifstream file(filename.c_str(), std::ios::binary);
+	return std::vector<char>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+static void writeFile(const std::string &filename, const std::vector<char> &data, const size_t &size)
+{
+	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+	file.write(data.data(), static_cast<std::streamsize>(size));
+}
+
+template <typename T>
+static bool testNetwork(const char *typeName, const bool &bias, const bool &mapped)
+{
+	const std::string filename = std::string("SaveTest_") + typeName + ".model";
+	const std::string damagedName = std::string("SaveTest_") + typeName + "_damaged.model";
+	const size_t numInputs = 20;
+	const size_t numOutputs = 5;
+	std::valarray<T> inputs(numInputs);
+	std::valarray<T> targets(numOutputs);
+	for (size_t i = 0; i < numInputs; ++i) {
+		inputs[i] = static_cast<T>(i % 7) / static_cast<T>(7.0) - static_cast<T>(0.5);
+	}
+	c_BasicNeuralNetwork<T> source(inputs, targets, { 16, 12, numOutputs }, ACT_SIGMOID, static_cast<T>(0.05), bias);
+	source.initWeights(c_BasicInitializer<T>(INIT_XAVIER_UNIFORM, 3));
+	source.evaluate();
+	const std::valarray<T> expectedOutputs = source.getOutputs();
+	std::vector<T> expected;
+	copyWeights(source, expected);
+	bool pass = source.save(filename);
+	// Restore into a network of another depth, width and activation, which the load must rebuild
+	c_BasicNeuralNetwork<T> restored(inputs, targets, { 8, numOutputs }, ACT_TANH, static_cast<T>(0.1), !bias);
+	pass = pass && (mapped ? restored.loadMapped(filename) : restored.load(filename));
+	std::vector<T> actual;
+	copyWeights(restored, actual);
+	restored.evaluate();
+	const std::valarray<T> &actualOutputs = restored.getOutputs();
+	pass = pass && (restored.getSize() == source.getSize()) && (restored.getActivation() == ACT_SIGMOID) &&
+		same(actual.data(), actual.size() * sizeof(T), expected.data(), expected.size() * sizeof(T)) &&
+		same(&actualOutputs[0], actualOutputs.size() * sizeof(T), &expectedOutputs[0], expectedOutputs.size() * sizeof(T));
+	if (!pass) {
+		printf("FAIL %s bias %d %s: restored network differs\n", typeName, bias ? 1 : 0, mapped ? "loadMapped" : "load");
+	}
+	// Damaged copies of the file must all be rejected, leaving the restored network as it was
+	const std::vector<char> data = readFile(filename);
+	std::vector<std::string> damages;
+	std::vector<std::vector<char>> damaged;
+	std::vector<size_t> sizes;
+	const size_t truncations[] = { 0, 7, 60, 100, data.size() / 2, data.size() - 1 };
+	for (const size_t &size : truncations) {
+		damages.push_back("truncated to " + std::to_string(size) + " bytes");
+		damaged.push_back(data);
+		sizes.push_back(size);
+	}
+	// Offsets in the header: magic 0, version 8, byte order 12, scalar size 16, layers 20, activation 24, bias 28,
+	// inputs 32; then, from 64, the layer table: size, input size, stride and offset (8 bytes each) per layer
+	const size_t corruptions[] = { 0, 8, 12, 16, 20, 24, 28, 32, 72, 80, 88, 96 };
+	for (const size_t &offset : corruptions) {
+		damages.push_back("corrupted at byte " + std::to_string(offset));
+		damaged.push_back(data);
+		damaged.back()[offset] = static_cast<char>(damaged.back()[offset] ^ 0x5a);
+		sizes.push_back(data.size());
+	}
+	for (size_t d = 0; d < damaged.size(); ++d) {
+		writeFile(damagedName, damaged[d], sizes[d]);
+		const bool loaded = mapped ? restored.loadMapped(damagedName) : restored.load(damagedName);
+		std::vector<T> after;
+		copyWeights(restored, after);
+		restored.evaluate();
+		const std::valarray<T> &afterOutputs = restored.getOutputs();
+		if (loaded || !same(after.data(), after.size() * sizeof(T), expected.data(), expected.size() * sizeof(T)) ||
+			!same(&afterOutputs[0], afterOutputs.size() * sizeof(T), &expectedOutputs[0], expectedOutputs.size() * sizeof(T))) {
+			printf("FAIL %s bias %d %s: file %s %s\n", typeName, bias ? 1 : 0, mapped ? "loadMapped" : "load",
+				damages[d].c_str(), loaded ? "was loaded" : "changed the network");
+			pass = false;
+		}
+	}
+	// A missing file fails the same way
+	if (mapped ? restored.loadMapped("SaveTest_missing.model") : restored.load("SaveTest_missing.model")) {
+		printf("FAIL %s bias %d %s: missing file was loaded\n", typeName, bias ? 1 : 0, mapped ? "loadMapped" : "load");
+		pass = false;
+	}
+	std::remove(filename.c_str());
+	std::remove(damagedName.c_str());
+	return pass;
+}
+
+int main()
+{
+	bool pass = true;
+	for (int bias = 0; bias < 2; ++bias) {
+		for (int mapped = 0; mapped < 2; ++mapped) {
+			pass = testNetwork<double>("double", bias != 0, mapped != 0) && pass;
+			pass = testNetwork<float>("float", bias != 0, mapped != 0) && pass;
+		}
+	}
+	printf("%s\n", pass ? "PASS" : "FAIL");
+	return pass ? 0 : 1;
+}
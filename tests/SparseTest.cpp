@@ -0,0 +1,191 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// SparseTest.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Sparse test: a network given its inputs as (index, value) pairs with setSparseInputs() must evaluate as a copy of
+// it given the same inputs densely, and train() and step() must make the same weight changes (the zero inputs
+// change no weights either way). A pruned network compressed to a c_SparseNetwork must infer, one row at a time and
+// as a batch, what evaluate() and evaluateBatch() give on the pruned dense weights. With and without bias; fails
+// (exit 1) on any mismatch beyond rounding
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "NeuralNetwork.h"
+#include "SparseNetwork.h"
+
+template <typename T>
+static void copyWeights(c_BasicNeuralNetwork<T> &network, std::vector<T> &weights)
+{
+	weights.clear();
+	for (size_t l = 0; l < network.getSize(); ++l) {
+		const T *layerWeights = network[l].getWeights();
+		weights.insert(weights.end(), layerWeights, layerWeights + (network[l].getSize() * network[l].getStride()));
+	}
+}
+
+template <typename T>
+static double maxDifference(const T *x, const T *y, const size_t &n)
+{
+	double maxDiff = 0.0;
+	for (size_t i = 0; i < n; ++i) {
+		const double diff = std::fabs(static_cast<double>(x[i]) - static_cast<double>(y[i]));
+		maxDiff = (diff > maxDiff) ? diff : maxDiff;
+	}
+	return maxDiff;
+}
+
+template <typename T>
+static bool testSparseInputs(const char *typeName, const size_t &depth, const bool &bias)
+{
+	// A wide first layer fed a few nonzeros at a time, in a different pattern on every pass
+	const size_t numInputs = 300;
+	const size_t numOutputs = 5;
+	std::valarray<T> inputs(numInputs);
+	std::valarray<T> targets(numOutputs);
+	for (size_t i = 0; i < numOutputs; ++i) {
+		targets[i] = static_cast<T>(i % 2);
+	}
+	std::vector<size_t> layers(depth - 1, 16);
+	layers.push_back(numOutputs);
+	c_BasicNeuralNetwork<T> dense(inputs, targets, layers, ACT_TANH, static_cast<T>(0.1), bias);
+	dense.initWeights(c_BasicInitializer<T>(INIT_XAVIER_UNIFORM, 17));
+	c_BasicNeuralNetwork<T> sparse(dense);
+	const double tolerance = (sizeof(T) == sizeof(float)) ? 1.0e-6 : 1.0e-14;
+	double maxDiff = 0.0;
+	bool pass = true;
+	for (size_t iteration = 0; iteration < 6; ++iteration) {
+		std::vector<uint32_t> indices;
+		std::vector<T> values;
+		inputs = 0.0;
+		for (size_t i = iteration; i < numInputs; i += 23 + iteration) {
+			indices.push_back(static_cast<uint32_t>(i));
+			values.push_back(static_cast<T>((i % 9) + 1) / static_cast<T>(9.0) - static_cast<T>(0.5));
+			inputs[i] = values.back();
+		}
+		pass = sparse.setSparseInputs(indices.data(), values.data(), indices.size()) && pass;
+		// Alternate evaluate() and train() with the fused step()
+		if ((iteration % 2) == 0) {
+			dense.evaluate();
+			sparse.evaluate();
+			maxDiff = std::fmax(maxDiff, maxDifference(&dense.getOutputs()[0], &sparse.getOutputs()[0], numOutputs));
+			dense.train();
+			sparse.train();
+		} else {
+			dense.step();
+			sparse.step();
+		}
+		std::vector<T> denseWeights;
+		std::vector<T> sparseWeights;
+		copyWeights(dense, denseWeights);
+		copyWeights(sparse, sparseWeights);
+		maxDiff = std::fmax(maxDiff, maxDifference(denseWeights.data(), sparseWeights.data(), denseWeights.size()));
+	}
+	// Back to dense inputs: both networks read the same array again
+	sparse.setInputs(inputs);
+	dense.evaluate();
+	sparse.evaluate();
+	maxDiff = std::fmax(maxDiff, maxDifference(&dense.getOutputs()[0], &sparse.getOutputs()[0], numOutputs));
+	pass = pass && (maxDiff <= tolerance);
+	if (!pass) {
+		printf("FAIL %s sparse inputs depth %zu bias %d: max difference %g\n", typeName, depth, bias ? 1 : 0, maxDiff);
+	}
+	return pass;
+}
+
+template <typename T>
+static bool testPruned(const char *typeName, const size_t &depth, const bool &bias, const T &fraction)
+{
+	const size_t numInputs = 40;
+	const size_t numOutputs = 6;
+	const size_t rows = 12;
+	std::valarray<T> inputs(numInputs);
+	std::valarray<T> targets(numOutputs);
+	std::vector<size_t> layers(depth - 1, 32);
+	layers.push_back(numOutputs);
+	c_BasicNeuralNetwork<T> network(inputs, targets, layers, ACT_SIGMOID, static_cast<T>(0.1), bias);
+	network.initWeights(c_BasicInitializer<T>(INIT_XAVIER_UNIFORM, 19));
+	network.pruneFraction(fraction);
+	c_BasicSparseNetwork<T> sparse;
+	bool pass = sparse.compress(network);
+	// Every nonzero input weight (the bias weights are kept apart) is stored, and nothing else
+	size_t numNonzeros = 0;
+	for (size_t l = 0; l < network.getSize(); ++l) {
+		const size_t inputSize = (l == 0) ? numInputs : network[l - 1].getSize();
+		for (size_t i = 0; i < network[l].getSize(); ++i) {
+			for (size_t j = 0; j < inputSize; ++j) {
+				numNonzeros += (network[l].getWeights()[(i * network[l].getStride()) + j] != 0) ? 1 : 0;
+			}
+		}
+	}
+	pass = pass && (sparse.getNumNonzeros() == numNonzeros) && ((fraction == 0) || (network.getNumPruned() > 0));
+	std::vector<T> samples(rows * numInputs);
+	for (size_t i = 0; i < samples.size(); ++i) {
+		samples[i] = static_cast<T>(i % 17) / static_cast<T>(17.0) - static_cast<T>(0.5);
+	}
+	std::vector<T> expected(rows * numOutputs);
+	std::vector<T> actual(rows * numOutputs);
+	std::vector<T> actualBatch(rows * numOutputs);
+	std::vector<T> expectedBatch(rows * numOutputs);
+	for (size_t r = 0; r < rows; ++r) {
+		for (size_t i = 0; i < numInputs; ++i) {
+			inputs[i] = samples[(r * numInputs) + i];
+		}
+		network.evaluate();
+		for (size_t i = 0; i < numOutputs; ++i) {
+			expected[(r * numOutputs) + i] = network.getOutputs()[i];
+		}
+		sparse.infer(&samples[r * numInputs], &actual[r * numOutputs]);
+	}
+	network.evaluateBatch(samples.data(), rows, expectedBatch.data());
+	sparse.inferBatch(samples.data(), rows, actualBatch.data());
+	const double tolerance = (sizeof(T) == sizeof(float)) ? 1.0e-6 : 1.0e-14;
+	const double maxDiff = maxDifference(expected.data(), actual.data(), expected.size());
+	const double maxBatchDiff = maxDifference(expectedBatch.data(), actualBatch.data(), expectedBatch.size());
+	pass = pass && (maxDiff <= tolerance) && (maxBatchDiff <= tolerance);
+	if (!pass) {
+		printf("FAIL %s pruned %g depth %zu bias %d: %zu nonzeros, max difference %g (infer), %g (inferBatch)\n", typeName,
+			static_cast<double>(fraction), depth, bias ? 1 : 0, sparse.getNumNonzeros(), maxDiff, maxBatchDiff);
+	}
+	return pass;
+}
+
+int main()
+{
+	bool pass = true;
+	for (size_t depth = 1; depth <= 3; ++depth) {
+		for (int bias = 0; bias < 2; ++bias) {
+			pass = testSparseInputs<double>("double", depth, bias != 0) && pass;
+			pass = testSparseInputs<float>("float", depth, bias != 0) && pass;
+			for (const double &fraction : { 0.0, 0.5, 0.9 }) {
+				pass = testPruned<double>("double", depth, bias != 0, fraction) && pass;
+				pass = testPruned<float>("float", depth, bias != 0, static_cast<float>(fraction)) && pass;
+			}
+		}
+	}
+	printf("%s\n", pass ? "PASS" : "FAIL");
+	return pass ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// ThreadTest.cpp
+//
+// Copyright (c) 2018 Adam Thwaites
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Thread determinism test: the layers split their neurons into chunks that do not depend on the number of threads,
+// so training the same network with 1, 2 and N threads must give bit-identical weights, through evaluate() and
+// train(), step(), and evaluateBatch() and trainBatch(). trainParallel() shards its rows by thread, so it is only
+// required to repeat itself for the same number of threads. Fails (exit 1) on any difference
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "NeuralNetwork.h"
+
+template <typename T>
+static void copyWeights(c_BasicNeuralNetwork<T> &network, std::vector<T> &weights)
+{
+	weights.clear();
+	for (size_t l = 0; l < network.getSize(); ++l) {
+		const T *layerWeights = network[l].getWeights();
+		weights.insert(weights.end(), layerWeights, layerWeights + (network[l].getSize() * network[l].getStride()));
+	}
+}
+
+template <typename T>
+static void trainNetwork(const size_t &depth, const bool &bias, const size_t &threads, const bool &parallel, std::vector<T> &weights)
+{
+	// Layers wide enough to split into several chunks (and batch chunks), trained the same way every time
+	const size_t numInputs = 64;
+	const size_t width = 320;
+	const size_t numOutputs = 10;
+	const size_t rows = 48;
+	std::valarray<T> inputs(numInputs);
+	std::valarray<T> targets(numOutputs);
+	for (size_t i = 0; i < numInputs; ++i) {
+		inputs[i] = static_cast<T>(i % 7) / static_cast<T>(7.0) - static_cast<T>(0.5);
+	}
+	for (size_t i = 0; i < numOutputs; ++i) {
+		targets[i] = static_cast<T>(i % 3) / static_cast<T>(3.0);
+	}
+	std::vector<size_t> layers(depth - 1, width);
+	layers.push_back(numOutputs);
+	c_BasicNeuralNetwork<T> network(inputs, targets, layers, ACT_TANH, static_cast<T>(0.01), bias);
+	network.initWeights(c_BasicInitializer<T>(INIT_XAVIER_UNIFORM, 11));
+	network.setThreads(threads);
+	std::vector<T> batchInputs(rows * numInputs);
+	std::vector<T> batchTargets(rows * numOutputs);
+	std::vector<T> batchOutputs(rows * numOutputs);
+	for (size_t i = 0; i < batchInputs.size(); ++i) {
+		batchInputs[i] = static_cast<T>(i % 11) / static_cast<T>(11.0) - static_cast<T>(0.5);
+	}
+	for (size_t i = 0; i < batchTargets.size(); ++i) {
+		batchTargets[i] = static_cast<T>(i % 5) / static_cast<T>(5.0);
+	}
+	for (size_t i = 0; i < 3; ++i) {
+		if (parallel) {
+			network.trainParallel(batchInputs.data(), batchTargets.data(), rows);
+		} else {
+			network.evaluate();
+			network.train();
+			network.step();
+			network.trainBatch(batchInputs.data(), batchTargets.data(), rows);
+		}
+	}
+	copyWeights(network, weights);
+	if (!parallel) {
+		// The batch outputs too, which the weights alone would not show
+		network.evaluateBatch(batchInputs.data(), rows, batchOutputs.data());
+		weights.insert(weights.end(), batchOutputs.begin(), batchOutputs.end());
+	}
+}
+
+template <typename T>
+static bool testNetwork(const char *typeName, const size_t &depth, const bool &bias)
+{
+	const size_t cores = std::thread::hardware_concurrency();
+	const size_t threadCounts[] = { 2, (cores > 3) ? cores : 4 };
+	bool pass = true;
+	std::vector<T> serial;
+	trainNetwork<T>(depth, bias, 1, false, serial);
+	for (const size_t &threads : threadCounts) {
+		std::vector<T> threaded;
+		trainNetwork<T>(depth, bias, threads, false, threaded);
+		if ((threaded.size() != serial.size()) || (memcmp(threaded.data(), serial.data(), serial.size() * sizeof(T)) != 0)) {
+			printf("FAIL %s depth %zu bias %d: %zu threads differ from 1\n", typeName, depth, bias ? 1 : 0, threads);
+			pass = false;
+		}
+		std::vector<T> first;
+		std::vector<T> second;
+		trainNetwork<T>(depth, bias, threads, true, first);
+		trainNetwork<T>(depth, bias, threads, true, second);
+		if (memcmp(first.data(), second.data(), first.size() * sizeof(T)) != 0) {
+			printf("FAIL %s depth %zu bias %d: trainParallel() on %zu threads does not repeat\n", typeName, depth,
+				bias ? 1 : 0, threads);
+			pass = false;
+		}
+	}
+	return pass;
+}
+
+int main()
+{
+	bool pass = true;
+	for (size_t depth = 1; depth <= 3; ++depth) {
+		for (int bias = 0; bias < 2; ++bias) {
+			pass = testNetwork<double>("double", depth, bias != 0) && pass;
+			pass = testNetwork<float>("float", depth, bias != 0) && pass;
+		}
+	}
+	printf("%s\n", pass ? "PASS" : "FAIL");
+	return pass ? 0 : 1;
+}